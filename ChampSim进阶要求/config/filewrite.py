@@ -32,6 +32,8 @@ core_module_declaration_file_name = 'ooo_cpu_module_decl.inc'
 core_module_definition_file_name = 'ooo_cpu_module_def.inc'
 cache_module_declaration_file_name = 'cache_module_decl.inc'
 cache_module_definition_file_name = 'cache_module_def.inc'
+cache_operate_file_name = 'cache_operate_inst.inc'
+core_operate_file_name = 'ooo_cpu_operate_inst.inc'
 makefile_file_name = os.path.join(os.path.dirname(os.path.dirname(os.path.abspath(__file__))), '_configuration.mk')
 
 cxx_generated_warning = ('/***', ' * THIS FILE IS AUTOMATICALLY GENERATED', ' * Do not edit this file. It will be overwritten when the configure script is run.', ' ***/', '')
@@ -78,6 +80,8 @@ class FileWriter:
 
         self.fileparts.append((os.path.join(inc_dir, instantiation_file_name), instantiation_file.get_instantiation_lines(**elements))) # Instantiation file
         self.fileparts.append((os.path.join(inc_dir, constants_file_name), constants_file.get_constants_file(config_file, elements['pmem']))) # Constants header
+        self.fileparts.append((os.path.join(inc_dir, cache_operate_file_name), instantiation_file.get_cache_operate_instantiation_lines(elements['caches']))) # Cache specializations
+        self.fileparts.append((os.path.join(inc_dir, core_operate_file_name), instantiation_file.get_core_operate_instantiation_lines(elements['cores']))) # Core specializations
 
         # Core modules file
         core_declarations, core_definitions = modules.get_ooo_cpu_module_lines(module_info['branch'], module_info['btb'])
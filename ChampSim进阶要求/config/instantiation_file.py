@@ -13,6 +13,7 @@
 # limitations under the License.
 
 import itertools
+import os
 import functools
 import operator
 
@@ -43,6 +44,8 @@ core_builder_parts = {
     'dispatch_latency': '.dispatch_latency({dispatch_latency})',
     'schedule_latency': '.schedule_latency({schedule_latency})',
     'execute_latency': '.execute_latency({execute_latency})',
+    'wc_buffer_size': '.wc_buffer_size({wc_buffer_size})',
+    'wc_buffer_timeout': '.wc_buffer_timeout({wc_buffer_timeout})',
     'dib_set': '  .dib_set({dib_set})',
     'dib_way': '  .dib_way({dib_way})',
     'dib_window': '  .dib_window({dib_window})'
@@ -65,7 +68,15 @@ cache_builder_parts = {
     'fill_latency': '.fill_latency({fill_latency})',
     'max_tag_check': '.tag_bandwidth({max_tag_check})',
     'max_fill': '.fill_bandwidth({max_fill})',
-    '_offset_bits': '.offset_bits({_offset_bits})'
+    '_offset_bits': '.offset_bits({_offset_bits})',
+    'sector_size': '.sector_size({sector_size})',
+    'banks': '.banks({banks})',
+    'bank_offset_bits': '.bank_offset_bits({bank_offset_bits})',
+    'partition_interval': '.partition_interval({partition_interval})',
+    'victim_buffer': '.victim_buffer({victim_buffer})',
+    'prefetch_throttle_interval': '.prefetch_throttle_interval({prefetch_throttle_interval})',
+    'prefetch_mshr_size': '.prefetch_mshr_size({prefetch_mshr_size})',
+    'access_trace': '.access_trace("{access_trace}")'
 }
 
 default_ptw_queue = {
@@ -75,6 +86,168 @@ default_ptw_queue = {
                 '_queue_check_full_addr':False
         }
 
+def static_geometry_args(elem):
+    if not elem.get('static_geometry'):
+        return None
+    if 'sets' not in elem or 'ways' not in elem:
+        raise ValueError('Cache {} must specify both "sets" and "ways" to use "static_geometry"'.format(elem['name']))
+    if elem.get('sector_size', 1) != 1:
+        raise ValueError('Cache {} cannot be sectored with "static_geometry"'.format(elem['name']))
+    return '{}, {}, {}'.format(elem['sets'], elem['ways'], elem.get('_offset_bits', 'champsim::lg2(BLOCK_SIZE)'))
+
+set_index_functions = {
+    'modulo': 'champsim::set_index_function::modulo',
+    'xor': 'champsim::set_index_function::xor_fold',
+    'prime': 'champsim::set_index_function::prime_modulo',
+    'skewed': 'champsim::set_index_function::skewed'
+}
+
+# Replacement policies that find the set of each candidate way themselves, and so can be used in a skewed cache
+skewed_replacement = ('lru',)
+
+def set_index_arg(elem):
+    function = elem.get('set_index', 'modulo')
+    if function not in set_index_functions:
+        raise ValueError('Cache {} has unknown "set_index" {}; expected one of {}'.format(elem['name'], function, ', '.join(set_index_functions)))
+    if function != 'modulo' and elem.get('static_geometry'):
+        raise ValueError('Cache {} cannot use "set_index" {} with "static_geometry"'.format(elem['name'], function))
+    if function == 'skewed':
+        unsupported = [m['name'] for m in elem.get('_replacement_data', []) if os.path.basename(os.path.normpath(m['fname'])) not in skewed_replacement]
+        if unsupported:
+            raise ValueError('Cache {} cannot use "set_index" skewed with replacement {}; expected one of {}'.format(elem['name'], ', '.join(unsupported), ', '.join(skewed_replacement)))
+    return set_index_functions[function]
+
+inclusion_policies = {
+    'non-inclusive': 'champsim::inclusion_policy::non_inclusive',
+    'inclusive': 'champsim::inclusion_policy::inclusive',
+    'exclusive': 'champsim::inclusion_policy::exclusive'
+}
+
+def inclusion_arg(elem):
+    policy = elem.get('inclusion', 'non-inclusive')
+    if policy not in inclusion_policies:
+        raise ValueError('Cache {} has unknown "inclusion" {}; expected one of {}'.format(elem['name'], policy, ', '.join(inclusion_policies)))
+    return inclusion_policies[policy]
+
+write_policies = {
+    'write-allocate': 'champsim::write_policy::write_allocate',
+    'no-write-allocate': 'champsim::write_policy::no_write_allocate'
+}
+
+def write_policy_arg(elem):
+    policy = elem.get('write_policy', 'write-allocate')
+    if policy not in write_policies:
+        raise ValueError('Cache {} has unknown "write_policy" {}; expected one of {}'.format(elem['name'], policy, ', '.join(write_policies)))
+    return write_policies[policy]
+
+full_mshr_policies = {
+    'stall': 'champsim::full_mshr_policy::stall',
+    'forward': 'champsim::full_mshr_policy::forward',
+    'drop': 'champsim::full_mshr_policy::drop'
+}
+
+def full_mshr_prefetch_arg(elem):
+    policy = elem.get('full_mshr_prefetch', 'stall')
+    if policy not in full_mshr_policies:
+        raise ValueError('Cache {} has unknown "full_mshr_prefetch" {}; expected one of {}'.format(elem['name'], policy, ', '.join(full_mshr_policies)))
+    return full_mshr_policies[policy]
+
+slice_topologies = {
+    'ring': 'champsim::slice_topology::ring',
+    'mesh': 'champsim::slice_topology::mesh'
+}
+
+slice_network_builder_parts = {
+    'frequency': '.frequency({frequency})',
+    '_offset_bits': '.offset_bits({_offset_bits})',
+    'hop_latency': '.hop_latency({hop_latency})',
+    'link_bandwidth': '.link_bandwidth({link_bandwidth})',
+    'link_buffer_size': '.link_buffer_size({link_buffer_size})'
+}
+
+def split_slices(caches):
+    '''
+    Replace each cache that has more than one slice with its slices, each a cache with an equal share of the sets and MSHRs.
+    Returns the resulting caches, and a network for each sliced cache, which takes its name and connects its upper levels to the slices.
+    '''
+    split_caches, networks = [], []
+    for elem in caches:
+        num_slices = elem.get('slices', 1)
+        if num_slices == 1:
+            split_caches.append(elem)
+            continue
+
+        if num_slices < 1 or (num_slices & (num_slices - 1)) != 0:
+            raise ValueError('Cache {} must have a power of two "slices"'.format(elem['name']))
+        if elem['sets'] % num_slices != 0:
+            raise ValueError('The {} sets of cache {} cannot be divided among {} slices'.format(elem['sets'], elem['name'], num_slices))
+        if elem.get('topology', 'ring') not in slice_topologies:
+            raise ValueError('Cache {} has unknown "topology" {}; expected one of {}'.format(elem['name'], elem['topology'], ', '.join(slice_topologies)))
+
+        slice_names = ['{}_slice{}'.format(elem['name'], i) for i in range(num_slices)]
+        for i, name in enumerate(slice_names):
+            slice_elem = {**elem, 'name': name, 'sets': elem['sets'] // num_slices}
+            if 'mshr_size' in elem:
+                slice_elem['mshr_size'] = max(1, elem['mshr_size'] // num_slices)
+            if 'access_trace' in elem:
+                slice_elem['access_trace'] = '{}.slice{}'.format(elem['access_trace'], i)
+            split_caches.append(slice_elem)
+
+        networks.append({**elem, '_slices': slice_names})
+
+    return split_caches, networks
+
+# Names the channels from a slice network to its slices that carry the requests of one of its upper levels
+def slice_link_name(network_name, upper_name):
+    return '{}_{}'.format(upper_name, network_name)
+
+dram_cache_builder_parts = {
+    'frequency': '.frequency({frequency})',
+    'io_freq': '.io_freq({io_freq})',
+    'sets': '.sets({sets})',
+    'ways': '.ways({ways})',
+    'banks': '.banks({banks})',
+    'columns': '.columns({columns})',
+    'channel_width': '.channel_width({channel_width})',
+    'tag_cache_sets': '.tag_cache({tag_cache_sets})',
+    'tag_latency': '.tag_latency({tag_latency})',
+    'queue_size': '.queue_size({queue_size})',
+    'mshr_size': '.mshr_size({mshr_size})'
+}
+
+def insert_dram_cache(caches, pmem):
+    '''
+    Place the DRAM cache of the physical memory, if it has one, below the caches that would otherwise reach the physical memory.
+    Returns the resulting caches, and a tuple of the DRAM caches.
+    '''
+    if 'dram_cache' not in pmem:
+        return caches, ()
+
+    drc = pmem['dram_cache']
+    if drc['name'] in (c['name'] for c in caches):
+        raise ValueError('The DRAM cache {} has the same name as a cache'.format(drc['name']))
+
+    return [({**c, 'lower_level': drc['name']} if c.get('lower_level') == pmem['name'] else c) for c in caches], ({**drc, 'lower_level': pmem['name']},)
+
+# The modules are listed in a fixed order, so that equal sets of modules name the same specialization
+def module_flags(prefix, module_data):
+    return ' | '.join(sorted(prefix + k['name'] for k in module_data)) or '0'
+
+def cache_operate_args(elem):
+    geometry = static_geometry_args(elem)
+    geometry_type = 'champsim::dynamic_geometry' if geometry is None else 'champsim::static_geometry<{}>'.format(geometry)
+    modules_type = 'CACHE::module_model<{}, {}>'.format(module_flags('CACHE::p', elem.get('_prefetcher_data', [])), module_flags('CACHE::r', elem.get('_replacement_data', [])))
+    return '{}, {}'.format(geometry_type, modules_type)
+
+def core_operate_args(cpu):
+    return 'O3_CPU::module_model<{}, {}>'.format(module_flags('O3_CPU::b', cpu.get('_branch_predictor_data', [])), module_flags('O3_CPU::t', cpu.get('_btb_data', [])))
+
+def get_cache_operate_instantiation_lines(caches):
+    yield from ('template long CACHE::operate_with<{}>();'.format(args) for args in sorted(set(cache_operate_args(elem) for elem in caches)))
+
+def get_core_operate_instantiation_lines(cores):
+    yield from ('template long O3_CPU::operate_with<{}>();'.format(args) for args in sorted(set(core_operate_args(cpu) for cpu in cores)))
+
 # Avoids a warning on clang under -Wbraced-scalar-init if there is only one member
 def vector_string(iterable):
     hoisted = list(iterable)
@@ -83,19 +256,33 @@ def vector_string(iterable):
     return '{'+', '.join(hoisted)+'}'
 
 def get_instantiation_lines(cores, caches, ptws, pmem, vmem):
+    caches, dram_caches = insert_dram_cache(caches, pmem)
+    caches, networks = split_slices(caches)
+
     upper_level_pairs = tuple(itertools.chain(
         ((elem['lower_level'], elem['name']) for elem in ptws),
         ((elem['lower_level'], elem['name']) for elem in caches),
+        ((elem['lower_level'], elem['name']) for elem in dram_caches),
         ((elem['lower_translate'], elem['name']) for elem in caches if 'lower_translate' in elem),
         *(((elem['L1I'], elem['name']), (elem['L1D'], elem['name'])) for elem in cores)
     ))
 
+    # Each slice has a channel from the network for each upper level of the sliced cache
+    upper_level_pairs += tuple((slice_name, slice_link_name(net['name'], ul)) for net in networks for slice_name in net['_slices'] for ll,ul in upper_level_pairs if ll == net['name'])
+
     upper_levels = {k: {'uppers': tuple(x[1] for x in v)} for k,v in itertools.groupby(sorted(upper_level_pairs, key=operator.itemgetter(0)), key=operator.itemgetter(0))}
 
     subdict_keys = ('rq_size', 'pq_size', 'wq_size', '_offset_bits', '_queue_check_full_addr')
     upper_levels = util.chain(upper_levels,
-            *({c['name']: util.subdict(c, subdict_keys)} for c in caches),
+            *({c['name']: util.subdict(c, subdict_keys)} for c in itertools.chain(caches, networks)),
             *({p['name']: util.chain(default_ptw_queue, util.subdict(p, subdict_keys))} for p in ptws),
+            *({d['name']: {
+                    'rq_size': d.get('rq_size', d['queue_size']),
+                    'wq_size': d.get('wq_size', d['queue_size']),
+                    'pq_size': d.get('pq_size', d['queue_size']),
+                    '_offset_bits':'champsim::lg2(BLOCK_SIZE)',
+                    '_queue_check_full_addr':False
+                }} for d in dram_caches),
             {pmem['name']: {
                     'rq_size':'std::numeric_limits<std::size_t>::max()',
                     'wq_size':'std::numeric_limits<std::size_t>::max()',
@@ -108,6 +295,8 @@ def get_instantiation_lines(cores, caches, ptws, pmem, vmem):
 
     yield '#include "environment.h"'
     yield '#include "defaults.hpp"'
+    yield '#include "dram_cache.h"'
+    yield '#include "slice_network.h"'
     yield '#include "vmem.h"'
     yield 'namespace champsim::configured {'
     yield 'struct generated_environment final : public champsim::environment {'
@@ -150,6 +339,7 @@ def get_instantiation_lines(cores, caches, ptws, pmem, vmem):
         yield '};'
         yield ''
 
+    cache_names = {elem['name'] for elem in caches}
     for elem in caches:
         yield 'CACHE {}{{CACHE::Builder{{ {} }}'.format(elem['name'], elem.get('_defaults', ''))
         yield '.name("{name}")'.format(**elem)
@@ -164,6 +354,26 @@ def get_instantiation_lines(cores, caches, ptws, pmem, vmem):
         }
 
         yield from (v.format(**elem) for k,v in cache_builder_parts.items() if k in elem)
+
+        geometry = static_geometry_args(elem)
+        if geometry is not None:
+            yield '.geometry<{}>()'.format(geometry)
+
+        if 'set_index' in elem:
+            yield '.set_index({})'.format(set_index_arg(elem))
+
+        if 'inclusion' in elem:
+            yield '.inclusion({})'.format(inclusion_arg(elem))
+
+        if 'write_policy' in elem:
+            yield '.write_policy({})'.format(write_policy_arg(elem))
+
+        if 'full_mshr_prefetch' in elem:
+            yield '.full_mshr_prefetch({})'.format(full_mshr_prefetch_arg(elem))
+
+        if 'prefetch_throttle_interval' in elem:
+            yield '.throttle_memory(&{})'.format(pmem['name'])
+
         yield from (v.format(**elem) for k,v in local_cache_builder_parts.items() if k[0] in elem and k[1] == elem[k[0]])
 
         # Create prefetch activation masks
@@ -171,13 +381,17 @@ def get_instantiation_lines(cores, caches, ptws, pmem, vmem):
             yield '.prefetch_activate({})'.format(', '.join('access_type::'+t for t in elem['prefetch_activate']))
 
         if elem.get('_replacement_data'):
-            yield '.replacement<{}>()'.format(' | '.join('CACHE::r{}'.format(k['name']) for k in elem['_replacement_data']))
+            yield '.replacement<{}>()'.format(module_flags('CACHE::r', elem['_replacement_data']))
 
         if elem.get('_prefetcher_data'):
-            yield '.prefetcher<{}>()'.format(' | '.join('CACHE::p{}'.format(k['name']) for k in elem['_prefetcher_data']))
+            yield '.prefetcher<{}>()'.format(module_flags('CACHE::p', elem['_prefetcher_data']))
+
+        yield '.bind_modules()'
 
         yield '.upper_levels({{{}}})'.format(vector_string('&{}_to_{}_queues'.format(ul, elem['name']) for ul in upper_levels[elem['name']]['uppers']))
         yield '.lower_level({})'.format('&{}_to_{}_queues'.format(elem['name'], elem['lower_level']))
+        if elem['lower_level'] in cache_names:
+            yield '.lower_cache(&{})'.format(elem['lower_level'])
 
         if 'lower_translate' in elem:
             yield '.lower_translate({})'.format('&{}_to_{}_queues'.format(elem['name'], elem['lower_translate']))
@@ -185,6 +399,27 @@ def get_instantiation_lines(cores, caches, ptws, pmem, vmem):
         yield '};'
         yield ''
 
+    for net in networks:
+        yield 'SliceNetwork {name}{{SliceNetwork::Builder{{}}'.format(**net)
+        yield '.name("{name}")'.format(**net)
+        yield from (v.format(**net) for k,v in slice_network_builder_parts.items() if k in net)
+        yield '.topology({})'.format(slice_topologies[net.get('topology', 'ring')])
+        yield '.upper_levels({{{}}})'.format(vector_string('&{}_to_{}_queues'.format(ul, net['name']) for ul in upper_levels[net['name']]['uppers']))
+        slice_channels = ('{{{}}}'.format(', '.join('&{}_to_{}_queues'.format(slice_link_name(net['name'], ul), slice_name) for ul in upper_levels[net['name']]['uppers'])) for slice_name in net['_slices'])
+        yield '.slices({{{}}})'.format(', '.join(slice_channels))
+        yield '};'
+        yield ''
+
+    for drc in dram_caches:
+        yield 'DRAM_CACHE {name}{{DRAM_CACHE::Builder{{}}'.format(**drc)
+        yield '.name("{name}")'.format(**drc)
+        yield from (v.format(**drc) for k,v in dram_cache_builder_parts.items() if k in drc)
+        yield '.timing({tRP}, {tRCD}, {tCAS})'.format(**drc)
+        yield '.upper_levels({{{}}})'.format(vector_string('&{}_to_{}_queues'.format(ul, drc['name']) for ul in upper_levels[drc['name']]['uppers']))
+        yield '.lower_level({})'.format('&{}_to_{}_queues'.format(drc['name'], drc['lower_level']))
+        yield '};'
+        yield ''
+
     for cpu in cores:
         yield 'O3_CPU {}{{O3_CPU::Builder{{ champsim::defaults::default_core }}'.format(cpu['name'])
 
@@ -198,9 +433,10 @@ def get_instantiation_lines(cores, caches, ptws, pmem, vmem):
         yield from (v.format(**cpu['DIB']) for k,v in dib_builder_parts.items() if k in cpu)
 
         if cpu.get('_branch_predictor_data'):
-            yield '.branch_predictor<{}>()'.format(' | '.join('O3_CPU::b{}'.format(k['name']) for k in cpu['_branch_predictor_data']))
+            yield '.branch_predictor<{}>()'.format(module_flags('O3_CPU::b', cpu['_branch_predictor_data']))
         if cpu.get('_btb_data'):
-            yield '.btb<{}>()'.format(' | '.join('O3_CPU::t{}'.format(k['name']) for k in cpu['_btb_data']))
+            yield '.btb<{}>()'.format(module_flags('O3_CPU::t', cpu['_btb_data']))
+        yield '.bind_modules()'
 
         yield '.fetch_queues({})'.format('&{}_to_{}_queues'.format(cpu['name'], cpu['L1I']))
         yield '.data_queues({})'.format('&{}_to_{}_queues'.format(cpu['name'], cpu['L1D']))
@@ -230,12 +466,19 @@ def get_instantiation_lines(cores, caches, ptws, pmem, vmem):
     yield '}'
     yield ''
 
+    yield 'std::vector<std::reference_wrapper<DRAM_CACHE>> dram_cache_view() override {'
+    yield '  return {'
+    yield '    ' + ', '.join('{name}'.format(**elem) for elem in dram_caches)
+    yield '  };'
+    yield '}'
+    yield ''
+
     yield 'MEMORY_CONTROLLER& dram_view() override {{ return {}; }}'.format(pmem['name'])
     yield ''
 
     yield 'std::vector<std::reference_wrapper<champsim::operable>> operable_view() override {'
     yield '  return {'
-    yield '    ' + ', '.join('{name}'.format(**elem) for elem in itertools.chain(cores, ptws, caches, (pmem,)))
+    yield '    ' + ', '.join('{name}'.format(**elem) for elem in itertools.chain(cores, ptws, caches, networks, dram_caches, (pmem,)))
     yield '  };'
     yield '}'
     yield ''
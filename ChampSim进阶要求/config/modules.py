@@ -113,31 +113,38 @@ def discriminator_function_declaration(fname, rtype, args, varname, secondary_va
     argstring = ', '.join((a[0]+' '+a[1]) for a in args)
     yield '{} {}::impl_{}({})'.format(rtype, classname, fname, argstring)
 
+# Generate C++ code calling one module variant, if it is selected. If a selector is given, it is a statement that tells the class which variant is about to be called.
+def discriminator_call(varname, classname, key, call, selector=None):
+    condition = '({} & {}::{}) != 0'.format(varname, classname, key)
+    if selector is None:
+        return '  if constexpr ({}) {};'.format(condition, call)
+    return '  if constexpr ({}) {{ {}; {}; }}'.format(condition, selector.format(varname=varname, classname=classname, key=key), call)
+
 # Generate C++ code for the body of a discriminator function that returns void
-def discriminator_function_definition_void(fname, args, varname, zipped_keys_and_funcs, classname):
+def discriminator_function_definition_void(fname, args, varname, zipped_keys_and_funcs, classname, selector=None):
     # Discriminate between the module variants
-    yield from ('  if constexpr (({} & {}::{}) != 0) intern_->{}({});'.format(varname, classname, k, n, ', '.join(a[1] for a in args)) for k,n in zipped_keys_and_funcs)
+    yield from (discriminator_call(varname, classname, k, 'intern_->{}({})'.format(n, ', '.join(a[1] for a in args)), selector) for k,n in zipped_keys_and_funcs)
 
 # Generate C++ code for the body of a discriminator function that returns nonvoid
-def discriminator_function_definition_nonvoid(fname, rtype, join_op, args, varname, zipped_keys_and_funcs, classname):
+def discriminator_function_definition_nonvoid(fname, rtype, join_op, args, varname, zipped_keys_and_funcs, classname, selector=None):
     # Declare result
     yield '  ' + rtype + ' result{};'
     yield '  ' + join_op + '<decltype(result)> joiner{};'
 
     # Discriminate between the module variants
-    yield from ('  if constexpr (({} & {}::{}) != 0) result = joiner(result, intern_->{}({}));'.format(varname, classname, k, n, ', '.join(a[1] for a in args)) for k,n in zipped_keys_and_funcs)
+    yield from (discriminator_call(varname, classname, k, 'result = joiner(result, intern_->{}({}))'.format(n, ', '.join(a[1] for a in args)), selector) for k,n in zipped_keys_and_funcs)
 
     # Return result
     yield '  return result;'
 
 # Generate C++ code for the body of a discriminator function
-def discriminator_function_definition(fname, rtype, join_op, args, varname, zipped_keys_and_funcs, classname):
+def discriminator_function_definition(fname, rtype, join_op, args, varname, zipped_keys_and_funcs, classname, selector=None):
     yield '{'
 
     if rtype == 'void':
-        yield from discriminator_function_definition_void(fname, args, varname, zipped_keys_and_funcs, classname)
+        yield from discriminator_function_definition_void(fname, args, varname, zipped_keys_and_funcs, classname, selector)
     else:
-        yield from discriminator_function_definition_nonvoid(fname, rtype, join_op, args, varname, zipped_keys_and_funcs, classname)
+        yield from discriminator_function_definition_nonvoid(fname, rtype, join_op, args, varname, zipped_keys_and_funcs, classname, selector)
 
     yield '}'
 
@@ -147,15 +154,20 @@ def get_module_variant_declarations(fname, fnamelist, args=tuple(), rtype='void'
     yield ''
 
 # For a given module function, generate C++ code defining the discriminator function
-def get_discriminator(fname, varname, secondary_varname, zipped_keys_and_funcs, args=tuple(), rtype='void', join_op=None, *tail, classname=None):
+def get_discriminator(fname, varname, secondary_varname, zipped_keys_and_funcs, args=tuple(), rtype='void', join_op=None, *tail, classname=None, selector=None):
     yield from discriminator_function_declaration(fname, rtype, args, varname, secondary_varname, classname)
-    yield from discriminator_function_definition(fname, rtype, join_op, args, varname, zipped_keys_and_funcs, classname.split(':')[0])
+    yield from discriminator_function_definition(fname, rtype, join_op, args, varname, zipped_keys_and_funcs, classname.split(':')[0], selector)
     yield ''
 
 # For a set of module data, generate C++ code defining the constants that distinguish the modules
 def constants_for_modules(prefix, mod_data):
     yield from ('constexpr static unsigned long long {0}{2:{prec}} = 1ull << {1};'.format(prefix, n, data['name'], prec=max(len(k['name']) for k in mod_data)) for n,data in enumerate(mod_data))
 
+# For a set of module data, generate C++ code giving the name of each module, in the order of their constants
+def names_for_modules(varname, mod_data):
+    names = (os.path.basename(os.path.normpath(data.get('fname', data['name']))) for data in mod_data)
+    yield 'constexpr static std::array<std::string_view, {}> {}{{{{{}}}}};'.format(len(mod_data), varname, ', '.join('"{}"'.format(n) for n in names))
+
 # Return a pair containing two generators: The first generates C++ code declaring all functions for the O3_CPU modules, and the second generates C++ code defining the functions
 def get_ooo_cpu_module_lines(branch_data, btb_data):
     branch_prefix = 'b'
@@ -220,10 +232,12 @@ def get_cache_module_lines(pref_data, repl_data):
     ]
 
     classname = 'CACHE::module_model<' + pref_varname + ', ' + repl_varname + '>'
+    pref_selector = 'intern_->active_prefetcher = champsim::detail::module_slot({varname}, {classname}::{key})'
 
     return (
         itertools.chain(
             constants_for_modules(pref_prefix, pref_data.values()), ('',),
+            names_for_modules('pref_names', pref_data.values()), ('',),
             constants_for_modules(repl_prefix, repl_data.values()), ('',),
 
             # Establish functions common to all prefetchers
@@ -239,7 +253,8 @@ def get_cache_module_lines(pref_data, repl_data):
         ),
 
         itertools.chain(
-            *(get_discriminator(fname, pref_varname, repl_varname, [(pref_prefix + v['name'], v['func_map'][fname]) for v in pref_data.values()], *finfo, classname=classname) for fname, *finfo in itertools.chain(pref_nonbranch_variant_data, pref_branch_variant_data)),
+            # Tell the cache which prefetcher each call is made for, so that it can attribute the prefetches that the call requests
+            *(get_discriminator(fname, pref_varname, repl_varname, [(pref_prefix + v['name'], v['func_map'][fname]) for v in pref_data.values()], *finfo, classname=classname, selector=pref_selector) for fname, *finfo in itertools.chain(pref_nonbranch_variant_data, pref_branch_variant_data)),
             *(get_discriminator(fname, repl_varname, pref_varname, [(repl_prefix + v['name'], v['func_map'][fname]) for v in repl_data.values()], *finfo, classname=classname) for fname, *finfo in repl_variant_data)
         )
        )
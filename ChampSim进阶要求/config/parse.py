@@ -24,6 +24,7 @@ from . import util
 default_root = { 'block_size': 64, 'page_size': 4096, 'heartbeat_frequency': 10000000, 'num_cores': 1 }
 default_core = { 'frequency' : 4000 }
 default_pmem = { 'name': 'DRAM', 'frequency': 3200, 'channels': 1, 'ranks': 1, 'banks': 8, 'rows': 65536, 'columns': 128, 'lines_per_column': 8, 'channel_width': 8, 'wq_size': 64, 'rq_size': 64, 'tRP': 12.5, 'tRCD': 12.5, 'tCAS': 12.5, 'turn_around_time': 7.5 }
+default_dram_cache = { 'name': 'DRC', 'frequency': 3200, 'sets': 262144, 'ways': 1, 'banks': 16, 'columns': 32, 'channel_width': 16, 'tRP': 12.5, 'tRCD': 12.5, 'tCAS': 12.5, 'tag_latency': 2, 'queue_size': 64, 'mshr_size': 32 }
 default_vmem = { 'pte_page_size': (1 << 12), 'num_levels': 5, 'minor_fault_penalty': 200 }
 
 cache_deprecation_keys = {
@@ -69,7 +70,7 @@ def normalize_config(config_file):
 
     # Default core elements
     # Give cores numeric indices
-    core_keys_to_copy = ('frequency', 'ifetch_buffer_size', 'decode_buffer_size', 'dispatch_buffer_size', 'rob_size', 'lq_size', 'sq_size', 'fetch_width', 'decode_width', 'dispatch_width', 'execute_width', 'lq_width', 'sq_width', 'retire_width', 'mispredict_penalty', 'scheduler_size', 'decode_latency', 'dispatch_latency', 'schedule_latency', 'execute_latency', 'branch_predictor', 'btb', 'DIB')
+    core_keys_to_copy = ('frequency', 'ifetch_buffer_size', 'decode_buffer_size', 'dispatch_buffer_size', 'rob_size', 'lq_size', 'sq_size', 'fetch_width', 'decode_width', 'dispatch_width', 'execute_width', 'lq_width', 'sq_width', 'retire_width', 'mispredict_penalty', 'scheduler_size', 'decode_latency', 'dispatch_latency', 'schedule_latency', 'execute_latency', 'wc_buffer_size', 'wc_buffer_timeout', 'branch_predictor', 'btb', 'DIB')
     cores = [util.chain(cpu, util.subdict(config_file, core_keys_to_copy), {'name': 'cpu'+str(i), '_index': i}) for i,cpu in enumerate(cores)]
 
     pinned_cache_names = ('L1I', 'L1D', 'ITLB', 'DTLB', 'L2C', 'STLB')
@@ -118,6 +119,8 @@ def parse_normalized(cores, caches, ptws, pmem, vmem, merged_configs, branch_con
     config_file = util.chain(merged_configs, default_root)
 
     pmem = util.chain(pmem, default_pmem)
+    if 'dram_cache' in pmem:
+        pmem['dram_cache'] = util.chain(pmem['dram_cache'], default_dram_cache)
     vmem = util.chain(vmem, default_vmem)
 
     cores = [util.chain(cpu, {'DIB': dict()}, default_core) for cpu in cores]
@@ -161,7 +164,10 @@ def parse_normalized(cores, caches, ptws, pmem, vmem, merged_configs, branch_con
     caches = filter_inaccessible(caches, [cpu[name] for cpu,name in itertools.product(cores, ('ITLB', 'DTLB', 'L1I', 'L1D'))])
 
     pmem['io_freq'] = pmem['frequency'] # Save value
-    scale_frequencies(itertools.chain(cores, caches.values(), ptws.values(), (pmem,)))
+    dram_caches = (pmem['dram_cache'],) if 'dram_cache' in pmem else ()
+    for drc in dram_caches:
+        drc['io_freq'] = drc['frequency'] # Save value
+    scale_frequencies(itertools.chain(cores, caches.values(), ptws.values(), (pmem,), dram_caches))
 
     # TODO can these be removed in favor of the defaults in inc/defaults.hpp?
     # All cores have a default branch predictor and BTB
@@ -0,0 +1,46 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ACCESS_REPLAY_H
+#define ACCESS_REPLAY_H
+
+#include <vector>
+
+#include "access_trace.h"
+#include "cache.h"
+
+namespace champsim
+{
+enum class replay_fill_policy {
+  fill_on_miss,  // every lookup that misses allocates immediately
+  recorded_fills // blocks are allocated only where the recorded cache filled them, keeping the original fill timing
+};
+
+/**
+ * Drive the replacement policy of the given cache with a recorded access stream, without simulating the rest of the system.
+ * The contents of the cache are discarded. Accesses recorded during warmup update the cache, but are not counted.
+ */
+cache_stats replay_access_trace(CACHE& cache, const std::vector<access_trace_record>& records,
+                                replay_fill_policy policy = replay_fill_policy::fill_on_miss);
+
+/**
+ * Find the hit rate of Belady's optimal replacement policy, with bypassing, on a recorded access stream.
+ */
+cache_stats replay_optimal(uint32_t sets, uint32_t ways, unsigned offset_bits, const std::vector<access_trace_record>& records,
+                           replay_fill_policy policy = replay_fill_policy::fill_on_miss);
+} // namespace champsim
+
+#endif
@@ -0,0 +1,89 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ACCESS_TRACE_H
+#define ACCESS_TRACE_H
+
+#include <array>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace champsim
+{
+/**
+ * One access seen by a cache, in the order the cache resolved it.
+ * Lookups are recorded when the tag check completes; fills are recorded when the block is written into the array.
+ */
+struct access_trace_record {
+  uint64_t address;
+  uint64_t ip;
+  uint64_t cycle;
+  uint32_t cpu;
+  uint8_t type; // access_type
+  uint8_t flags;
+  uint8_t padding[2] = {};
+
+  constexpr static uint8_t HIT = 1 << 0;
+  constexpr static uint8_t FILL = 1 << 1;
+  constexpr static uint8_t WARMUP = 1 << 2;
+
+  bool is_hit() const { return (flags & HIT) != 0; }
+  bool is_fill() const { return (flags & FILL) != 0; }
+  bool is_warmup() const { return (flags & WARMUP) != 0; }
+};
+
+/**
+ * The geometry of the cache that produced a trace, stored at the head of the file.
+ */
+struct access_trace_header {
+  constexpr static std::array<char, 8> expected_magic{'C', 'S', 'A', 'C', 'C', 'T', 'R', '1'};
+
+  std::array<char, 8> magic = expected_magic;
+  uint32_t sets = 0;
+  uint32_t ways = 0;
+  uint32_t offset_bits = 0;
+  uint32_t padding = 0;
+};
+
+class access_trace_writer
+{
+  constexpr static std::size_t buffer_size = 1 << 16;
+
+  std::ofstream file;
+  std::vector<access_trace_record> buffer{};
+
+public:
+  access_trace_writer(std::string filename, access_trace_header header);
+  ~access_trace_writer();
+
+  access_trace_writer(const access_trace_writer&) = delete;
+  access_trace_writer& operator=(const access_trace_writer&) = delete;
+
+  void record(access_trace_record rec);
+  void flush();
+};
+
+struct access_trace {
+  access_trace_header header;
+  std::vector<access_trace_record> records;
+};
+
+access_trace read_access_trace(std::string filename);
+} // namespace champsim
+
+#endif
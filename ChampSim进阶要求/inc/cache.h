@@ -24,19 +24,53 @@
 
 #include <array>
 #include <bitset>
-#include <deque>
 #include <memory>
 #include <stdexcept>
 #include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
 
+#include "access_trace.h"
+#include "cache_hints.h"
+#include "cache_geometry.h"
 #include "champsim.h"
 #include "champsim_constants.h"
 #include "channel.h"
 #include "module_impl.h"
 #include "operable.h"
+#include "prefetch_throttle.h"
+#include "util/lru_table.h"
+#include "util/open_address_map.h"
+#include "util/ring_buffer.h"
+#include "way_partitioner.h"
 #include <type_traits>
 
+namespace champsim
+{
+// How the contents of a cache relate to those of its upper levels
+enum class inclusion_policy { non_inclusive, inclusive, exclusive };
+// Whether a write that misses allocates a block, or is passed to the lower level without one
+enum class write_policy { write_allocate, no_write_allocate };
+// What a prefetch that misses does when it finds no free MSHR. It may wait for one, or, if it would not fill this cache,
+// be sent to the lower level without one. A prefetch from this cache's own prefetcher may also be dropped.
+enum class full_mshr_policy { stall, forward, drop };
+// What CACHE::prefetch_line() did with a prefetch. In a cache with more than one prefetcher, a prefetch is queued until the prefetches requested with it
+// are arbitrated, which may drop it. Only a refused prefetch converts to false.
+enum prefetch_status : int { prefetch_refused = 0, prefetch_issued = 1, prefetch_queued = 2 };
+} // namespace champsim
+
+class MEMORY_CONTROLLER;
+
+// The prefetches of one of a cache's prefetchers
+struct prefetcher_stats {
+  std::string name;
+  uint64_t requested = 0;
+  uint64_t issued = 0;
+  uint64_t useful = 0;
+  uint64_t useless = 0;
+};
+
 struct cache_stats {
   std::string name;
   // prefetch stats
@@ -45,12 +79,64 @@ struct cache_stats {
   uint64_t pf_useful = 0;
   uint64_t pf_useless = 0;
   uint64_t pf_fill = 0;
+  uint64_t pf_dropped = 0; // prefetches from this cache's prefetcher that found no free MSHR
+
+  // Demand misses that merged into one of this cache's prefetches while it was in flight, and the cycles they still waited for it
+  uint64_t pf_late = 0;
+  uint64_t pf_late_cycles = 0;
+  // Demand misses to prefetched blocks that were evicted unused, and the cycles from the eviction to the miss
+  uint64_t pf_early = 0;
+  uint64_t pf_early_cycles = 0;
+  // The cycles between the fill and the eviction of the prefetched blocks that were never used
+  uint64_t pf_useless_cycles = 0;
+  // Demand misses to blocks that a prefetch evicted
+  uint64_t pf_pollution = 0;
+  // Prefetches that the throttle dropped, and the sum of the levels it chose at each interval, from which their average is found
+  uint64_t pf_throttled = 0;
+  uint64_t throttle_level_sum = 0;
+  uint64_t throttle_intervals = 0;
+  // Prefetches that were not issued because the replacement policy of the level they would fill predicted their region dead
+  uint64_t pf_suppressed = 0;
+
+  // The prefetches of each prefetcher, in the order of their slots. With more than one prefetcher, the prefetches that duplicated a better-ranked
+  // prefetch, and those that lost the arbitration because the prefetch queue filled.
+  std::vector<prefetcher_stats> prefetchers = {};
+  uint64_t pf_duplicates = 0;
+  uint64_t pf_outranked = 0;
 
   std::array<std::array<uint64_t, NUM_CPUS>, champsim::to_underlying(access_type::NUM_TYPES)> hits = {};
   std::array<std::array<uint64_t, NUM_CPUS>, champsim::to_underlying(access_type::NUM_TYPES)> misses = {};
 
   double avg_miss_latency = 0;
   uint64_t total_miss_latency = 0;
+
+  // Misses in a sectored cache, divided by whether the sector of the missing block was present
+  uint64_t sector_miss = 0;
+  uint64_t subblock_miss = 0;
+
+  // Tag checks begun in each bank of a banked cache, and the cycles that a ready tag check waited because its bank was busy
+  std::vector<uint64_t> bank_accesses = {};
+  uint64_t bank_conflicts = 0;
+  uint64_t cycles = 0;
+
+  // Blocks that an inclusive cache invalidated in its upper levels, and blocks that an exclusive cache received as victims of its upper levels
+  uint64_t back_invalidations = 0;
+  uint64_t victim_inserts = 0;
+
+  // The ways that a partitioned cache allocated to each core, and the cycle on which it allocated them
+  std::vector<std::pair<uint64_t, std::vector<uint32_t>>> way_allocations = {};
+
+  // Misses in the main array that the victim buffer held, misses that it did not hold, and blocks that moved from it back into the main array
+  uint64_t victim_hits = 0;
+  uint64_t victim_misses = 0;
+  uint64_t victim_swaps = 0;
+
+  // The bytes of the writes this cache received, counting each write as a whole block, and the writes it passed to its lower level without allocating
+  uint64_t bytes_written = 0;
+  uint64_t write_arounds = 0;
+
+  // Storage taken for dependency and return lists while this cache operated
+  uint64_t dependency_list_allocations = 0;
 };
 
 class CACHE : public champsim::operable
@@ -76,15 +162,17 @@ class CACHE : public champsim::operable
     access_type type;
     bool prefetch_from_this;
     bool skip_fill;
+    bool clean_victim;
     bool is_translated;
     bool translate_issued = false;
+    unsigned pf_source = 0; // the slot of the prefetcher that requested this prefetch
 
     uint8_t asid[2] = {std::numeric_limits<uint8_t>::max(), std::numeric_limits<uint8_t>::max()};
 
     uint64_t event_cycle = std::numeric_limits<uint64_t>::max();
 
-    std::vector<std::reference_wrapper<ooo_model_instr>> instr_depend_on_me{};
-    std::vector<std::deque<response_type>*> to_return{};
+    champsim::pooled_list<std::reference_wrapper<ooo_model_instr>> instr_depend_on_me{};
+    champsim::pooled_list<champsim::ring_buffer<response_type>*> to_return{};
 
     explicit tag_lookup_type(request_type req) : tag_lookup_type(req, false, false) {}
     tag_lookup_type(request_type req, bool local_pref, bool skip);
@@ -102,23 +190,30 @@ class CACHE : public champsim::operable
 
     access_type type;
     bool prefetch_from_this;
+    bool clean_victim;
+    bool prefetch_partition = false; // whether this entry is one of the MSHRs held apart for this cache's prefetches
+    unsigned pf_source;
+    uint64_t demand_merge_cycle = std::numeric_limits<uint64_t>::max(); // when a demand miss merged into this prefetch
 
     uint8_t asid[2] = {std::numeric_limits<uint8_t>::max(), std::numeric_limits<uint8_t>::max()};
 
     uint64_t event_cycle = std::numeric_limits<uint64_t>::max();
     uint64_t cycle_enqueued;
 
-    std::vector<std::reference_wrapper<ooo_model_instr>> instr_depend_on_me{};
-    std::vector<std::deque<response_type>*> to_return{};
+    champsim::pooled_list<std::reference_wrapper<ooo_model_instr>> instr_depend_on_me{};
+    champsim::pooled_list<champsim::ring_buffer<response_type>*> to_return{};
 
     mshr_type(tag_lookup_type req, uint64_t cycle);
     static mshr_type merge(mshr_type predecessor, mshr_type successor);
   };
 
-  bool try_hit(const tag_lookup_type& handle_pkt);
-  bool handle_fill(const mshr_type& fill_mshr);
+  template <typename G, typename M>
+  bool try_hit(const G& geom, M& modules, const tag_lookup_type& handle_pkt);
+  template <typename G, typename M>
+  bool handle_fill(const G& geom, M& modules, const mshr_type& fill_mshr);
   bool handle_miss(const tag_lookup_type& handle_pkt);
   bool handle_write(const tag_lookup_type& handle_pkt);
+  bool handle_write_around(const tag_lookup_type& handle_pkt);
   void finish_packet(const response_type& packet);
   void finish_translation(const response_type& packet);
 
@@ -134,15 +229,33 @@ class CACHE : public champsim::operable
     uint64_t data = 0;
 
     uint32_t pf_metadata = 0;
+    uint64_t fill_cycle = 0;
+    unsigned pf_source = 0; // the slot of the prefetcher that filled the most recent prefetched block
+
+    // The blocks of the sector that are valid, dirty, or were prefetched. A cache that is not sectored uses only the lowest bit.
+    // valid, dirty, and prefetch are set if any block of the sector is.
+    uint64_t valid_blocks = 0;
+    uint64_t dirty_blocks = 0;
+    uint64_t prefetch_blocks = 0;
 
     BLOCK() = default;
-    explicit BLOCK(mshr_type mshr);
+    explicit BLOCK(mshr_type mshr, uint64_t subblock = 1);
   };
   using set_type = std::vector<BLOCK>;
 
-  std::pair<set_type::iterator, set_type::iterator> get_set_span(uint64_t address);
-  std::pair<set_type::const_iterator, set_type::const_iterator> get_set_span(uint64_t address) const;
-  std::size_t get_set_index(uint64_t address) const;
+  template <typename G>
+  std::size_t get_set_index(const G& geom, uint64_t address) const;
+  template <typename G>
+  std::size_t get_set_index(const G& geom, uint64_t address, std::size_t way) const;
+
+  // The body of operate(), specialized on the geometry this cache was built with and on the type through which it calls its modules.
+  // M is module_concept if the modules are called virtually, or the module_model they are bound into.
+  template <typename G, typename M>
+  long operate_with();
+  long (CACHE::*operate_impl)();
+
+  template <typename G>
+  G geometry() const;
 
   template <typename T>
   bool should_activate_prefetcher(const T& pkt) const;
@@ -150,9 +263,94 @@ class CACHE : public champsim::operable
   template <bool>
   auto initiate_tag_check(champsim::channel* ul = nullptr);
 
-  std::deque<tag_lookup_type> internal_PQ{};
-  std::deque<tag_lookup_type> inflight_tag_check{};
-  std::deque<tag_lookup_type> translation_stash{};
+  champsim::ring_buffer<tag_lookup_type> internal_PQ{};
+  champsim::ring_buffer<tag_lookup_type> inflight_tag_check{};
+  champsim::ring_buffer<tag_lookup_type> translation_stash{};
+
+  std::unique_ptr<champsim::access_trace_writer> access_trace_out{};
+  void record_access(uint64_t address, uint64_t ip, uint32_t triggering_cpu, access_type type, uint8_t flags);
+
+  // The bit of the address's block within its sector, in BLOCK::valid_blocks and friends
+  uint64_t subblock_bit(uint64_t address) const;
+  // The address of the lowest block of the sector that is set in blocks
+  uint64_t subblock_address(uint64_t sector_address, uint64_t blocks) const;
+  void count_sector_miss(uint64_t address);
+
+  // The bank that checks the tag of the address, and the last cycle on which each bank began a tag check
+  std::size_t get_bank(uint64_t address) const;
+  std::vector<uint64_t> bank_last_access{};
+
+  // Clear the given block of the sector at the index, leaving the sector valid if any of its other blocks are
+  void invalidate_block(std::size_t index, uint64_t subblock);
+  // Invalidate a block that an inclusive lower level has evicted, and pass the invalidation upward. Returns false if it must be retried.
+  bool back_invalidate(uint64_t address);
+  void send_invalidation(uint64_t address);
+
+  // The blocks that recently left this cache and were either prefetched and unused, or evicted by a prefetch.
+  // A demand miss that finds its block here was caused by a prefetch that came too early or polluted the cache.
+  struct evicted_block {
+    uint64_t address = 0; // the address of the sector
+    uint64_t evict_cycle = 0;
+    bool unused_prefetch = false;
+    bool prefetch_victim = false;
+
+    auto index() const { return address; }
+    auto tag() const { return address; }
+  };
+  champsim::lru_table<evicted_block> evicted_filter{64, 4};
+  void record_eviction(const BLOCK& blk, bool by_prefetch);
+  void check_evicted_filter(uint64_t address);
+
+  // The names of the prefetchers, by slot, and the slot of the one that the modules are calling
+  std::vector<std::string> prefetcher_names{};
+  unsigned active_prefetcher = 0;
+
+  // With more than one prefetcher, the prefetches requested during each call into the prefetchers wait here until arbitrate_prefetches()
+  // issues the best of them
+  struct prefetch_candidate {
+    uint64_t address;
+    bool fill_this_level;
+    uint32_t metadata;
+    unsigned source;
+    double confidence;
+    bool issued = false;
+  };
+  std::vector<prefetch_candidate> pf_candidates{};
+  // The queued prefetches that arbitration did not issue, by the slot of the prefetcher that requested them
+  std::vector<std::vector<uint64_t>> pf_dropped_candidates{};
+  void arbitrate_prefetches();
+  bool issue_prefetch(uint64_t pf_addr, bool fill_this_level, uint32_t prefetch_metadata, unsigned source, double confidence);
+  // The fraction of the prefetcher's resolved prefetches that were useful, smoothed so that a new prefetcher begins at one half
+  double prefetcher_accuracy(unsigned source) const;
+
+  // The aggressiveness of the prefetcher in a throttled cache, and the memory whose bandwidth it watches, if any
+  std::unique_ptr<champsim::prefetch_throttle> throttle{};
+  const MEMORY_CONTROLLER* throttle_memory = nullptr;
+  // The prefetches that the current trigger of the prefetcher may still issue
+  uint64_t pf_budget = std::numeric_limits<uint64_t>::max();
+  champsim::prefetch_feedback throttle_feedback() const;
+
+  // The cache below this one, if it is a cache, to whose side channel this cache's prefetches are also published
+  CACHE* lower_cache = nullptr;
+
+  // The cores' shares of the ways of a partitioned cache
+  std::unique_ptr<champsim::way_partitioner> partitioner{};
+  // The victim that keeps the core within its allocation, which is the given way if that already does
+  template <typename G>
+  std::size_t partition_victim(const G& geom, uint64_t address, uint32_t triggering_cpu, std::size_t way) const;
+  // The way that a block filled into the main array replaces, or the number of ways if the replacement policy bypasses it
+  template <typename G, typename M>
+  std::size_t choose_victim(const G& geom, M& modules, uint32_t triggering_cpu, uint64_t instr_id, uint64_t ip, uint64_t address, access_type type);
+
+  // The blocks most recently evicted from the main array, least recently evicted first
+  champsim::ring_buffer<BLOCK> victim_buffer{};
+  // Move the sector of the address from the victim buffer back into the main array, swapping the block it replaces into the buffer.
+  // Returns the way it now occupies, or the number of ways if the buffer does not hold it.
+  template <typename G, typename M>
+  std::size_t swap_victim(const G& geom, M& modules, const tag_lookup_type& handle_pkt);
+  champsim::ring_buffer<BLOCK>::iterator find_victim_entry(uint64_t address);
+  // Clear the given block of the sector in the victim buffer, removing the sector once none of its blocks are valid
+  void invalidate_victim_entry(champsim::ring_buffer<BLOCK>::iterator entry, uint64_t subblock);
 
 public:
   std::vector<channel_type*> upper_levels;
@@ -162,11 +360,47 @@ public:
   uint32_t cpu = 0;
   const std::string NAME;
   const uint32_t NUM_SET, NUM_WAY, MSHR_SIZE;
+  const uint32_t PF_MSHR_SIZE; // the MSHRs held apart for this cache's prefetches, in addition to MSHR_SIZE
   const std::size_t PQ_SIZE;
   const uint64_t HIT_LATENCY, FILL_LATENCY;
   const unsigned OFFSET_BITS;
+  const champsim::set_index_function SET_INDEX_FUNCTION;
+  const uint32_t SECTOR_SIZE; // the number of blocks covered by each tag
+  const champsim::inclusion_policy INCLUSION;
+  const champsim::write_policy WRITE_POLICY;
+  const champsim::full_mshr_policy FULL_MSHR_PREFETCH;
   set_type block{NUM_SET * NUM_WAY};
+
+  // The side channel through which this cache's prefetcher and replacement policy share their predictions
+  champsim::cache_hints hints{};
+
+private:
+  // The tag (the sector address) and valid bit of each entry in block, stored contiguously by set so that a lookup touches only a few bytes.
+  // These mirror block, so blocks must be written through write_block().
+  std::vector<uint64_t> block_tags = std::vector<uint64_t>(NUM_SET * NUM_WAY);
+  std::vector<uint8_t> block_valid = std::vector<uint8_t>(NUM_SET * NUM_WAY);
+
+  // The geometry of a cache whose geometry is not fixed at compile time, including how it indexes its sets
+  // Its offset covers a whole sector.
+  const champsim::dynamic_geometry runtime_geometry{NUM_SET, NUM_WAY, OFFSET_BITS + champsim::lg2(SECTOR_SIZE), SET_INDEX_FUNCTION};
+
+  // In a skewed cache, the blocks of a set are not adjacent. The replacement candidates for a fill are copied here, in way order.
+  set_type skewed_candidates{};
+
+  template <typename G>
+  std::size_t find_way(const G& geom, uint64_t address) const;
+  template <typename G>
+  std::size_t find_invalid_way(const G& geom, uint64_t address) const;
+  template <typename G>
+  const BLOCK* get_candidates(const G& geom, uint64_t address);
+
+public:
   const long int MAX_TAG, MAX_FILL;
+  const uint32_t NUM_BANKS; // each bank begins at most one tag check per cycle
+  const unsigned BANK_OFFSET_BITS; // the lowest address bit that selects the bank
+  const uint64_t PARTITION_INTERVAL; // the cycles between divisions of the ways among the cores, or 0 if the ways are shared
+  const std::size_t VICTIM_BUFFER_SIZE; // the blocks in the victim buffer, or 0 if there is none
+  const uint64_t PREFETCH_THROTTLE_INTERVAL; // the cycles between adjustments of the prefetcher's aggressiveness, or 0 if it is not throttled
   const bool prefetch_as_load;
   const bool match_offset_bits;
   const bool virtual_prefetch;
@@ -177,8 +411,25 @@ public:
 
   stats_type sim_stats, roi_stats;
 
-  std::deque<mshr_type> MSHR;
-  std::deque<mshr_type> inflight_writes;
+  champsim::ring_buffer<mshr_type> MSHR;
+  champsim::ring_buffer<mshr_type> inflight_writes;
+
+private:
+  // Locates MSHR entries by block address (address >> OFFSET_BITS). Each entry is numbered by its position in MSHR plus mshr_base, so
+  // that removing entries from the front of MSHR does not require renumbering. Returned entries are kept ahead of unreturned ones, and
+  // mshr_returned counts them.
+  champsim::open_address_map<uint64_t> mshr_index{MSHR_SIZE + PF_MSHR_SIZE};
+  uint64_t mshr_base = 0;
+  std::size_t mshr_returned = 0;
+
+  // The MSHR entries held in the partition for this cache's prefetches
+  std::size_t pf_mshr_occupancy = 0;
+
+  champsim::ring_buffer<mshr_type>::iterator find_mshr(uint64_t address);
+  void swap_mshr(champsim::ring_buffer<mshr_type>::iterator a, champsim::ring_buffer<mshr_type>::iterator b);
+  void retire_mshr(champsim::ring_buffer<mshr_type>::const_iterator end);
+
+public:
 
   long operate() override final;
 
@@ -208,10 +459,36 @@ public:
   std::vector<double> get_pq_occupancy_ratio() const;
 
   [[deprecated("Use get_set_index() instead.")]] uint64_t get_set(uint64_t address) const;
+
+  std::size_t get_set_index(uint64_t address) const;
+
+  /**
+   * The set that holds the address in the given way. This differs between ways only in a skewed cache.
+   * A replacement policy that keeps state per block should use this to find the state of each candidate in find_victim(), where the given set is the set in way 0.
+   */
+  std::size_t get_set_index(uint64_t address, uint32_t way) const;
   [[deprecated("This function should not be used to access the blocks directly.")]] uint64_t get_way(uint64_t address, uint64_t set) const;
 
   uint64_t invalidate_entry(uint64_t inval_addr);
+  void write_block(std::size_t index, BLOCK blk);
   int prefetch_line(uint64_t pf_addr, bool fill_this_level, uint32_t prefetch_metadata);
+  /**
+   * Request a prefetch with the prefetcher's confidence in it, from 0 to 1. When a cache has more than one prefetcher, the prefetches that they request
+   * together are ranked by confidence and by the accuracy of each prefetcher, and duplicates are removed, before any is issued.
+   */
+  int prefetch_line(uint64_t pf_addr, bool fill_this_level, uint32_t prefetch_metadata, double confidence);
+  /**
+   * The addresses of the prefetches that the calling prefetcher was told were champsim::prefetch_queued, and that were then not issued, since it
+   * last asked. A prefetch merged into another that was issued is not among them. A prefetcher that counts the prefetches it has sent can request
+   * these again.
+   */
+  std::vector<uint64_t> take_dropped_prefetches();
+
+  // How aggressive the throttle allows the prefetcher to be, from 1 to champsim::prefetch_throttle::max_level. Without a throttle, this is the middle level.
+  unsigned prefetch_throttle_level() const;
+
+  // The side channel of the cache below this one, which holds the predictions of the level that a prefetch not filling this level fills, or nullptr
+  champsim::cache_hints* lower_hints() const;
 
   [[deprecated("Use CACHE::prefetch_line(pf_addr, fill_this_level, prefetch_metadata) instead.")]] int
   prefetch_line(uint64_t ip, uint64_t base_addr, uint64_t pf_addr, bool fill_this_level, uint32_t prefetch_metadata);
@@ -291,10 +568,10 @@ public:
   class builder_conversion_tag
   {
   };
-  template <unsigned long long P_FLAG = 0, unsigned long long R_FLAG = 0>
+  template <unsigned long long P_FLAG = 0, unsigned long long R_FLAG = 0, typename GEOMETRY = champsim::dynamic_geometry, bool BIND_MODULES = false>
   class Builder
   {
-    using self_type = Builder<P_FLAG, R_FLAG>;
+    using self_type = Builder<P_FLAG, R_FLAG, GEOMETRY, BIND_MODULES>;
 
     std::string m_name{};
     double m_freq_scale{};
@@ -308,9 +585,23 @@ public:
     uint32_t m_max_tag{};
     uint32_t m_max_fill{};
     unsigned m_offset_bits{};
+    champsim::set_index_function m_set_index{champsim::set_index_function::modulo};
+    uint32_t m_sector_size{1};
+    champsim::inclusion_policy m_inclusion{champsim::inclusion_policy::non_inclusive};
+    champsim::write_policy m_write_policy{champsim::write_policy::write_allocate};
+    champsim::full_mshr_policy m_full_mshr_prefetch{champsim::full_mshr_policy::stall};
+    uint32_t m_pf_mshr_size{};
+    uint32_t m_banks{1};
+    unsigned m_bank_offset_bits{};
+    uint64_t m_partition_interval{};
+    std::size_t m_victim_buffer{};
+    uint64_t m_pf_throttle_interval{};
+    const MEMORY_CONTROLLER* m_throttle_memory{};
+    CACHE* m_lower_cache{};
     bool m_pref_load{};
     bool m_wq_full_addr{};
     bool m_va_pref{};
+    std::string m_access_trace{};
 
     unsigned m_pref_act_mask{};
     std::vector<CACHE::channel_type*> m_uls{};
@@ -319,12 +610,16 @@ public:
 
     friend class CACHE;
 
-    template <unsigned long long OTHER_P, unsigned long long OTHER_R>
-    Builder(builder_conversion_tag, const Builder<OTHER_P, OTHER_R>& other)
+    template <unsigned long long OTHER_P, unsigned long long OTHER_R, typename OTHER_G, bool OTHER_BIND>
+    Builder(builder_conversion_tag, const Builder<OTHER_P, OTHER_R, OTHER_G, OTHER_BIND>& other)
         : m_name(other.m_name), m_freq_scale(other.m_freq_scale), m_sets(other.m_sets), m_ways(other.m_ways), m_pq_size(other.m_pq_size),
           m_mshr_size(other.m_mshr_size), m_hit_lat(other.m_hit_lat), m_fill_lat(other.m_fill_lat), m_latency(other.m_latency), m_max_tag(other.m_max_tag),
-          m_max_fill(other.m_max_fill), m_offset_bits(other.m_offset_bits), m_pref_load(other.m_pref_load), m_wq_full_addr(other.m_wq_full_addr),
-          m_va_pref(other.m_va_pref), m_pref_act_mask(other.m_pref_act_mask), m_uls(other.m_uls), m_ll(other.m_ll), m_lt(other.m_lt)
+          m_max_fill(other.m_max_fill), m_offset_bits(other.m_offset_bits), m_set_index(other.m_set_index), m_sector_size(other.m_sector_size), m_inclusion(other.m_inclusion),
+          m_write_policy(other.m_write_policy), m_full_mshr_prefetch(other.m_full_mshr_prefetch), m_pf_mshr_size(other.m_pf_mshr_size), m_banks(other.m_banks),
+          m_bank_offset_bits(other.m_bank_offset_bits), m_partition_interval(other.m_partition_interval), m_victim_buffer(other.m_victim_buffer),
+          m_pf_throttle_interval(other.m_pf_throttle_interval), m_throttle_memory(other.m_throttle_memory), m_lower_cache(other.m_lower_cache),
+          m_pref_load(other.m_pref_load), m_wq_full_addr(other.m_wq_full_addr),
+          m_va_pref(other.m_va_pref), m_access_trace(other.m_access_trace), m_pref_act_mask(other.m_pref_act_mask), m_uls(other.m_uls), m_ll(other.m_ll), m_lt(other.m_lt)
     {
     }
 
@@ -391,6 +686,110 @@ public:
       m_offset_bits = offset_bits_;
       return *this;
     }
+    /**
+     * Choose how addresses are mapped to sets. Only the modulo function is available to a cache whose geometry is fixed at compile time.
+     */
+    self_type& set_index(champsim::set_index_function function_)
+    {
+      m_set_index = function_;
+      return *this;
+    }
+    /**
+     * Cover this many blocks with each tag. The blocks of a sector are filled, written back, and marked valid and dirty individually.
+     */
+    self_type& sector_size(uint32_t blocks_)
+    {
+      m_sector_size = blocks_;
+      return *this;
+    }
+    /**
+     * An inclusive cache invalidates the blocks it evicts in its upper levels. An exclusive cache does not keep the blocks it passes
+     * to its upper levels, and instead receives every block they evict.
+     */
+    self_type& inclusion(champsim::inclusion_policy policy_)
+    {
+      m_inclusion = policy_;
+      return *this;
+    }
+    /**
+     * A write-allocate cache fills a block for each write that misses. A no-write-allocate cache sends such writes on to its lower level.
+     */
+    self_type& write_policy(champsim::write_policy policy_)
+    {
+      m_write_policy = policy_;
+      return *this;
+    }
+    /**
+     * How a prefetch that misses proceeds when no MSHR is free
+     */
+    self_type& full_mshr_prefetch(champsim::full_mshr_policy policy_)
+    {
+      m_full_mshr_prefetch = policy_;
+      return *this;
+    }
+    /**
+     * Hold this many MSHRs apart for the prefetches of this cache's prefetcher, which then do not take the MSHRs of other misses
+     */
+    self_type& prefetch_mshr_size(uint32_t pf_mshr_size_)
+    {
+      m_pf_mshr_size = pf_mshr_size_;
+      return *this;
+    }
+    /**
+     * Divide the tags into this many banks, each of which can begin one tag check per cycle.
+     * The bank is selected by the address bits above the block offset, unless bank_offset_bits() chooses other bits.
+     */
+    self_type& banks(uint32_t banks_)
+    {
+      m_banks = banks_;
+      return *this;
+    }
+    self_type& bank_offset_bits(unsigned bank_offset_bits_)
+    {
+      m_bank_offset_bits = bank_offset_bits_;
+      return *this;
+    }
+    /**
+     * Divide the ways among the cores every so many cycles, by how many hits each core would gain from each additional way.
+     * A fill replaces a block of another core only while the filling core holds fewer blocks of the set than its share.
+     */
+    self_type& partition_interval(uint64_t cycles_)
+    {
+      m_partition_interval = cycles_;
+      return *this;
+    }
+    /**
+     * Keep the blocks most recently evicted from the main array in a fully-associative buffer of this many entries.
+     * A lookup that misses in the main array checks the buffer, and a block found there moves back into the main array.
+     */
+    self_type& victim_buffer(std::size_t entries_)
+    {
+      m_victim_buffer = entries_;
+      return *this;
+    }
+    /**
+     * Adjust the aggressiveness of the prefetcher every so many cycles, by the accuracy, lateness, and pollution of its prefetches and, if
+     * throttle_memory() is given, the utilization of the memory's bandwidth. Prefetches beyond the budget of the current level are dropped.
+     */
+    self_type& prefetch_throttle_interval(uint64_t cycles_)
+    {
+      m_pf_throttle_interval = cycles_;
+      return *this;
+    }
+    self_type& throttle_memory(const MEMORY_CONTROLLER* memory_)
+    {
+      m_throttle_memory = memory_;
+      return *this;
+    }
+    /**
+     * The cache that lower_level() leads to. The confidence of this cache's prefetches is published to its side channel as well, and a prefetch
+     * that would not fill this cache is suppressed by the predictions of that cache's replacement policy instead of this one's.
+     */
+    self_type& lower_cache(CACHE* cache_)
+    {
+      m_lower_cache = cache_;
+      return *this;
+    }
     self_type& set_prefetch_as_load()
     {
       m_pref_load = true;
@@ -421,6 +820,11 @@ public:
       m_va_pref = false;
       return *this;
     }
+    self_type& access_trace(std::string filename_)
+    {
+      m_access_trace = filename_;
+      return *this;
+    }
     template <typename... Elems>
     self_type& prefetch_activate(Elems... pref_act_elems)
     {
@@ -443,25 +847,104 @@ public:
       return *this;
     }
     template <unsigned long long P>
-    Builder<P, R_FLAG> prefetcher()
+    Builder<P, R_FLAG, GEOMETRY, BIND_MODULES> prefetcher()
     {
-      return Builder<P, R_FLAG>{builder_conversion_tag{}, *this};
+      return Builder<P, R_FLAG, GEOMETRY, BIND_MODULES>{builder_conversion_tag{}, *this};
     }
     template <unsigned long long R>
-    Builder<P_FLAG, R> replacement()
+    Builder<P_FLAG, R, GEOMETRY, BIND_MODULES> replacement()
     {
-      return Builder<P_FLAG, R>{builder_conversion_tag{}, *this};
+      return Builder<P_FLAG, R, GEOMETRY, BIND_MODULES>{builder_conversion_tag{}, *this};
     }
+    /**
+     * Fix the sets, ways, and offset bits at compile time, so that the cache's lookups are specialized for them.
+     * The specialization must be instantiated in src/cache.cc, which the configuration script does for each cache with "static_geometry".
+     */
+    template <uint32_t SETS, uint32_t WAYS, unsigned OFFSET_BITS>
+    Builder<P_FLAG, R_FLAG, champsim::static_geometry<SETS, WAYS, OFFSET_BITS>, BIND_MODULES> geometry()
+    {
+      Builder<P_FLAG, R_FLAG, champsim::static_geometry<SETS, WAYS, OFFSET_BITS>, BIND_MODULES> retval{builder_conversion_tag{}, *this};
+      retval.m_sets = SETS;
+      retval.m_ways = WAYS;
+      retval.m_offset_bits = OFFSET_BITS;
+      return retval;
+    }
+    /**
+     * Call the prefetcher and replacement modules directly from the cache's simulation loop, rather than through a virtual interface.
+     * The specialization must be instantiated in src/cache.cc, which the configuration script does for each cache.
+     */
+    Builder<P_FLAG, R_FLAG, GEOMETRY, true> bind_modules() { return Builder<P_FLAG, R_FLAG, GEOMETRY, true>{builder_conversion_tag{}, *this}; }
   };
 
-  template <unsigned long long P_FLAG, unsigned long long R_FLAG>
-  explicit CACHE(Builder<P_FLAG, R_FLAG> b)
-      : champsim::operable(b.m_freq_scale), upper_levels(std::move(b.m_uls)), lower_level(b.m_ll), lower_translate(b.m_lt), NAME(b.m_name), NUM_SET(b.m_sets),
-        NUM_WAY(b.m_ways), MSHR_SIZE(b.m_mshr_size), PQ_SIZE(b.m_pq_size), HIT_LATENCY((b.m_hit_lat > 0) ? b.m_hit_lat : b.m_latency - b.m_fill_lat),
-        FILL_LATENCY(b.m_fill_lat), OFFSET_BITS(b.m_offset_bits), MAX_TAG(b.m_max_tag), MAX_FILL(b.m_max_fill), prefetch_as_load(b.m_pref_load),
+  template <unsigned long long P_FLAG, unsigned long long R_FLAG, typename GEOMETRY, bool BIND_MODULES>
+  explicit CACHE(Builder<P_FLAG, R_FLAG, GEOMETRY, BIND_MODULES> b)
+      : champsim::operable(b.m_freq_scale),
+        operate_impl(&CACHE::operate_with<GEOMETRY, std::conditional_t<BIND_MODULES, module_model<P_FLAG, R_FLAG>, module_concept>>), upper_levels(std::move(b.m_uls)), lower_level(b.m_ll),
+        lower_translate(b.m_lt), NAME(b.m_name), NUM_SET(b.m_sets), NUM_WAY(b.m_ways), MSHR_SIZE(b.m_mshr_size), PF_MSHR_SIZE(b.m_pf_mshr_size), PQ_SIZE(b.m_pq_size), HIT_LATENCY((b.m_hit_lat > 0) ? b.m_hit_lat : b.m_latency - b.m_fill_lat),
+        FILL_LATENCY(b.m_fill_lat), OFFSET_BITS(b.m_offset_bits), SET_INDEX_FUNCTION(b.m_set_index), SECTOR_SIZE(b.m_sector_size), INCLUSION(b.m_inclusion), WRITE_POLICY(b.m_write_policy), FULL_MSHR_PREFETCH(b.m_full_mshr_prefetch), MAX_TAG(b.m_max_tag), MAX_FILL(b.m_max_fill),
+        NUM_BANKS(b.m_banks), BANK_OFFSET_BITS((b.m_bank_offset_bits > 0) ? b.m_bank_offset_bits : b.m_offset_bits),
+        PARTITION_INTERVAL(b.m_partition_interval), VICTIM_BUFFER_SIZE(b.m_victim_buffer),
+        PREFETCH_THROTTLE_INTERVAL(b.m_pf_throttle_interval), prefetch_as_load(b.m_pref_load),
         match_offset_bits(b.m_wq_full_addr), virtual_prefetch(b.m_va_pref), pref_activate_mask(b.m_pref_act_mask),
         module_pimpl(std::make_unique<module_model<P_FLAG, R_FLAG>>(this))
   {
+    if constexpr (champsim::is_static_geometry_v<GEOMETRY>) {
+      if (NUM_SET != GEOMETRY::sets() || NUM_WAY != GEOMETRY::ways() || OFFSET_BITS != GEOMETRY::offset_bits())
+        throw std::invalid_argument{"The sets, ways, or offset bits of " + NAME + " were changed after its geometry was fixed"};
+      if (SET_INDEX_FUNCTION != GEOMETRY::index_function())
+        throw std::invalid_argument{NAME + " cannot use a hashed set index with a geometry fixed at compile time"};
+      if (SECTOR_SIZE != 1)
+        throw std::invalid_argument{NAME + " cannot be sectored with a geometry fixed at compile time"};
+    }
+
+    if (SECTOR_SIZE == 0 || SECTOR_SIZE > 64 || (SECTOR_SIZE & (SECTOR_SIZE - 1)) != 0)
+      throw std::invalid_argument{"The sector size of " + NAME + " must be a power of two no greater than 64"};
+
+    if (INCLUSION == champsim::inclusion_policy::exclusive && WRITE_POLICY == champsim::write_policy::no_write_allocate)
+      throw std::invalid_argument{NAME + " is exclusive, so it must allocate the victims written to it"};
+
+    if (NUM_BANKS == 0 || (NUM_BANKS & (NUM_BANKS - 1)) != 0)
+      throw std::invalid_argument{"The number of banks in " + NAME + " must be a power of two"};
+    bank_last_access.resize(NUM_BANKS, std::numeric_limits<uint64_t>::max());
+
+    // Tell the neighbouring levels which messages this cache sends and receives
+    if (lower_level != nullptr)
+      lower_level->accepts_invalidations = true;
+    if (INCLUSION == champsim::inclusion_policy::exclusive) {
+      for (auto ul : upper_levels)
+        ul->accepts_victims = true;
+    }
+
+    if (runtime_geometry.skewed())
+      skewed_candidates.resize(NUM_WAY);
+
+    if (PARTITION_INTERVAL > 0)
+      partitioner = std::make_unique<champsim::way_partitioner>(NUM_CPUS, NUM_SET, NUM_WAY);
+    if (PREFETCH_THROTTLE_INTERVAL > 0)
+      throttle = std::make_unique<champsim::prefetch_throttle>();
+
+    for (auto flags = P_FLAG; flags != 0; flags &= flags - 1)
+      prefetcher_names.emplace_back(pref_names.at(champsim::lg2(flags & (~flags + 1))));
+    throttle_memory = b.m_throttle_memory;
+    lower_cache = b.m_lower_cache;
+
+    // Size the queues whose bounds are known, so that they never allocate during simulation
+    if (PQ_SIZE < std::numeric_limits<std::size_t>::max())
+      internal_PQ.reserve(PQ_SIZE);
+    inflight_tag_check.reserve(static_cast<std::size_t>(MAX_TAG) * HIT_LATENCY);
+    MSHR.reserve(MSHR_SIZE + PF_MSHR_SIZE);
+    victim_buffer.reserve(VICTIM_BUFFER_SIZE);
+    if (std::size(prefetcher_names) > 1 && PQ_SIZE < std::numeric_limits<std::size_t>::max())
+      pf_candidates.reserve(PQ_SIZE * std::size(prefetcher_names));
+    pf_dropped_candidates.resize(std::size(prefetcher_names));
+
+    if (!std::empty(b.m_access_trace)) {
+      champsim::access_trace_header header{};
+      header.sets = NUM_SET;
+      header.ways = NUM_WAY;
+      header.offset_bits = OFFSET_BITS;
+      access_trace_out = std::make_unique<champsim::access_trace_writer>(b.m_access_trace, header);
+    }
   }
 };
 
@@ -0,0 +1,152 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CACHE_GEOMETRY_H
+#define CACHE_GEOMETRY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include "util/bits.h"
+
+namespace champsim
+{
+/**
+ * The ways in which a cache can map a block address to a set.
+ */
+enum class set_index_function {
+  modulo,       // the low bits of the block address
+  xor_fold,     // every group of index bits in the block address, combined with XOR
+  prime_modulo, // the block address modulo the largest prime no greater than the number of sets. The remaining sets are not used.
+  skewed        // a different hash of the block address for each way, as in a skewed-associative cache
+};
+
+namespace detail
+{
+constexpr uint64_t xor_fold(uint64_t value, unsigned bits)
+{
+  uint64_t result = 0;
+  for (; bits > 0 && value != 0; value >>= bits)
+    result ^= value & champsim::bitmask(bits);
+  return result;
+}
+
+constexpr uint64_t largest_prime_not_above(uint64_t n)
+{
+  for (; n > 2; --n) {
+    bool is_prime = true;
+    for (uint64_t d = 2; d * d <= n && is_prime; ++d)
+      is_prime = (n % d) != 0;
+    if (is_prime)
+      return n;
+  }
+  return n;
+}
+
+// Multiplicative hashing with a different odd multiplier for each way, so that blocks that collide in one way are unlikely to collide in another
+constexpr uint64_t skewed_index(uint64_t block, uint32_t way, unsigned bits)
+{
+  uint64_t multiplier = 0x9e3779b97f4a7c15ull * (2ull * way + 1);
+  multiplier ^= multiplier >> 29;
+  return bits == 0 ? 0 : ((block * (multiplier | 1)) >> (64 - bits));
+}
+} // namespace detail
+
+/**
+ * The dimensions of a cache that are only known when it is constructed.
+ */
+class dynamic_geometry
+{
+  uint32_t num_set;
+  uint32_t num_way;
+  unsigned offset;
+  uint64_t set_mask;
+  set_index_function function;
+  unsigned index_bits;
+  uint64_t prime;
+
+  std::size_t hashed_set_index(uint64_t address, uint32_t way) const
+  {
+    const auto block = address >> offset;
+    switch (function) {
+    case set_index_function::xor_fold:
+      return detail::xor_fold(block, index_bits);
+    case set_index_function::prime_modulo:
+      return block % prime;
+    case set_index_function::skewed:
+      return detail::skewed_index(block, way, index_bits);
+    default:
+      return block & set_mask;
+    }
+  }
+
+public:
+  dynamic_geometry(uint32_t sets_, uint32_t ways_, unsigned offset_bits_, set_index_function function_ = set_index_function::modulo)
+      : num_set(sets_), num_way(ways_), offset(offset_bits_), set_mask(champsim::bitmask(champsim::lg2(sets_))), function(function_),
+        index_bits(champsim::lg2(sets_)), prime(detail::largest_prime_not_above(sets_))
+  {
+  }
+
+  uint32_t sets() const { return num_set; }
+  uint32_t ways() const { return num_way; }
+  unsigned offset_bits() const { return offset; }
+  set_index_function index_function() const { return function; }
+  bool skewed() const { return function == set_index_function::skewed; }
+
+  // The set that holds the address. In a skewed cache, this is the set in way 0.
+  std::size_t set_index(uint64_t address) const { return set_index(address, 0); }
+
+  // The set that would hold the address in the given way
+  std::size_t set_index(uint64_t address, uint32_t way) const
+  {
+    if (function == set_index_function::modulo)
+      return (address >> offset) & set_mask;
+    return hashed_set_index(address, way);
+  }
+};
+
+/**
+ * The dimensions of a cache, fixed at compile time.
+ * Code that is specialized on this type indexes sets with constant shifts and masks, and walks the ways of a set in a fixed number of steps.
+ */
+template <uint32_t SETS, uint32_t WAYS, unsigned OFFSET_BITS>
+struct static_geometry {
+  static_assert(SETS > 0 && (SETS & (SETS - 1)) == 0, "The number of sets must be a power of two");
+  static_assert(WAYS > 0, "A cache must have at least one way");
+
+  static constexpr uint32_t sets() { return SETS; }
+  static constexpr uint32_t ways() { return WAYS; }
+  static constexpr unsigned offset_bits() { return OFFSET_BITS; }
+  static constexpr set_index_function index_function() { return set_index_function::modulo; }
+  static constexpr bool skewed() { return false; }
+  static constexpr std::size_t set_index(uint64_t address) { return (address >> OFFSET_BITS) & (SETS - 1); }
+  static constexpr std::size_t set_index(uint64_t address, uint32_t) { return set_index(address); }
+};
+
+template <typename G>
+struct is_static_geometry : std::false_type {
+};
+
+template <uint32_t SETS, uint32_t WAYS, unsigned OFFSET_BITS>
+struct is_static_geometry<static_geometry<SETS, WAYS, OFFSET_BITS>> : std::true_type {
+};
+
+template <typename G>
+constexpr bool is_static_geometry_v = is_static_geometry<G>::value;
+} // namespace champsim
+
+#endif
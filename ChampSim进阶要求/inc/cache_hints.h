@@ -0,0 +1,96 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CACHE_HINTS_H
+#define CACHE_HINTS_H
+
+#include <cstdint>
+#include <optional>
+
+#include "champsim_constants.h"
+#include "util/lru_table.h"
+
+namespace champsim
+{
+// A replacement policy's expectation of whether a block will be used again before it is evicted
+enum class reuse_prediction { unknown, dead, distant, near };
+
+/**
+ * The side channel through which the modules of one cache cooperate, whichever modules they are.
+ *
+ * The replacement policy publishes its predictions of reuse, by the instruction that accessed a block and by the region (page) that holds it,
+ * and its occupancy: the fraction of the cache's blocks that it expects to be reused. The prefetcher's confidence in each prefetch is published
+ * by CACHE::prefetch_line(), to this cache and to the cache below it, so that the replacement policy of whichever level the prefetch fills may
+ * insert it by that confidence.
+ *
+ * Each kind of hint is kept in a small table of the most recent, so a hint that is not found reads as unknown.
+ */
+class cache_hints
+{
+  struct ip_entry {
+    uint64_t ip = 0;
+    reuse_prediction prediction = reuse_prediction::unknown;
+
+    auto index() const { return ip; }
+    auto tag() const { return ip; }
+  };
+
+  struct region_entry {
+    uint64_t region = 0;
+    reuse_prediction prediction = reuse_prediction::unknown;
+
+    auto index() const { return region; }
+    auto tag() const { return region; }
+  };
+
+  struct confidence_entry {
+    uint64_t block = 0;
+    double confidence = 1.0;
+
+    auto index() const { return block; }
+    auto tag() const { return block; }
+  };
+
+  champsim::lru_table<ip_entry> ip_predictions{64, 4};
+  champsim::lru_table<region_entry> region_predictions{64, 4};
+  champsim::lru_table<confidence_entry> prefetch_confidences{64, 8};
+  std::optional<double> published_occupancy{};
+
+public:
+  constexpr static unsigned LOG2_REGION_SIZE = LOG2_PAGE_SIZE;
+
+  // A prefetch with less confidence than this is one that a replacement policy should insert with low priority
+  constexpr static double low_confidence = 0.5;
+
+  // Published by the replacement policy
+  void predict_ip(uint64_t ip, reuse_prediction prediction);
+  void predict_region(uint64_t address, reuse_prediction prediction);
+  void publish_occupancy(double fraction);
+
+  reuse_prediction ip_reuse(uint64_t ip);
+  reuse_prediction region_reuse(uint64_t address);
+  std::optional<double> occupancy() const;
+
+  // Published for the prefetcher, with its confidence from 0 to 1
+  void publish_confidence(uint64_t address, double confidence);
+
+  // The confidence of the most recent prefetch of the block, if it is known
+  std::optional<double> prefetch_confidence(uint64_t address);
+  bool low_confidence_prefetch(uint64_t address);
+};
+} // namespace champsim
+
+#endif
@@ -19,13 +19,16 @@
 
 #include <array>
 #include <cstdint>
-#include <deque>
 #include <functional>
 #include <limits>
 #include <vector>
 
 #include <string_view>
 
+#include "util/open_address_map.h"
+#include "util/pooled_list.h"
+#include "util/ring_buffer.h"
+
 struct ooo_model_instr;
 
 enum class access_type : unsigned {
@@ -66,6 +69,7 @@ class channel
     bool forward_checked = false;
     bool is_translated = true;
     bool response_requested = true;
+    bool clean_victim = false; // a write that only inserts an unmodified block into an exclusive lower level
 
     uint8_t asid[2] = {std::numeric_limits<uint8_t>::max(), std::numeric_limits<uint8_t>::max()};
     access_type type{access_type::LOAD};
@@ -79,7 +83,7 @@ class channel
     uint64_t instr_id = 0;
     uint64_t ip = 0;
 
-    std::vector<std::reference_wrapper<ooo_model_instr>> instr_depend_on_me{};
+    pooled_list<std::reference_wrapper<ooo_model_instr>> instr_depend_on_me{};
   };
 
   struct response {
@@ -87,9 +91,9 @@ class channel
     uint64_t v_address;
     uint64_t data;
     uint32_t pf_metadata = 0;
-    std::vector<std::reference_wrapper<ooo_model_instr>> instr_depend_on_me{};
+    pooled_list<std::reference_wrapper<ooo_model_instr>> instr_depend_on_me{};
 
-    response(uint64_t addr, uint64_t v_addr, uint64_t data_, uint32_t pf_meta, std::vector<std::reference_wrapper<ooo_model_instr>> deps)
+    response(uint64_t addr, uint64_t v_addr, uint64_t data_, uint32_t pf_meta, pooled_list<std::reference_wrapper<ooo_model_instr>> deps)
         : address(addr), v_address(v_addr), data(data_), pf_metadata(pf_meta), instr_depend_on_me(deps)
     {
     }
@@ -99,6 +103,11 @@ class channel
   template <typename R>
   bool do_add_queue(R& queue, std::size_t queue_size, const typename R::value_type& packet);
 
+  // The position of the earliest entry in each queue for each (shifted) address, rebuilt by check_collision() when there are entries to check
+  open_address_map<std::size_t> rq_index{0}, pq_index{0}, wq_index{0};
+
+  pooled_list<ring_buffer<response>*> return_list{};
+
   std::size_t RQ_SIZE = std::numeric_limits<std::size_t>::max();
   std::size_t PQ_SIZE = std::numeric_limits<std::size_t>::max();
   std::size_t WQ_SIZE = std::numeric_limits<std::size_t>::max();
@@ -110,8 +119,16 @@ public:
   using request_type = request;
   using stats_type = cache_queue_stats;
 
-  std::deque<request_type> RQ{}, PQ{}, WQ{};
-  std::deque<response_type> returned{};
+  ring_buffer<request_type> RQ{}, PQ{}, WQ{};
+  ring_buffer<response_type> returned{};
+
+  // Blocks that an inclusive lower level has evicted, which the upper level must invalidate.
+  // They are only sent if the upper level will drain them, which it announces with accepts_invalidations.
+  ring_buffer<uint64_t> invalidations{};
+  bool accepts_invalidations = false;
+
+  // Set by an exclusive lower level, which should receive every block that the upper level evicts
+  bool accepts_victims = false;
 
   stats_type sim_stats{}, roi_stats{};
 
@@ -131,6 +148,11 @@ public:
   std::size_t pq_size() const;
 
   void check_collision();
+
+  /**
+   * A list that directs responses to this channel's returned queue. Every packet that takes it shares the same storage.
+   */
+  const pooled_list<ring_buffer<response_type>*>& return_to_this();
 };
 } // namespace champsim
 
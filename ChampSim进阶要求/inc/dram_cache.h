@@ -0,0 +1,260 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DRAM_CACHE_H
+#define DRAM_CACHE_H
+
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "channel.h"
+#include "operable.h"
+#include "util/ring_buffer.h"
+
+namespace champsim
+{
+// Where a DRAM cache keeps its tags. Tags in DRAM are read alongside the data, in the same row. A tag cache holds the tags of recently used sets
+// in SRAM, so that a lookup that finds them there knows whether it hits without accessing the DRAM.
+enum class dram_cache_tags { in_dram, tag_cache };
+} // namespace champsim
+
+struct dram_cache_stats {
+  std::string name{};
+
+  uint64_t read_hits = 0, read_misses = 0, write_hits = 0, write_misses = 0;
+  uint64_t tag_cache_hits = 0, tag_cache_misses = 0;
+  uint64_t row_buffer_hits = 0, row_buffer_misses = 0;
+  uint64_t writebacks = 0;
+
+  uint64_t total_miss_latency = 0;
+};
+
+/**
+ * A cache built from stacked DRAM, between the last-level cache and the memory controller.
+ *
+ * Each set occupies consecutive columns of one row of one bank, so that its tags and data are read together. With one way, each block is stored
+ * with its tag and a lookup is a single access, as in the Alloy cache. With more ways, the tags of the set are read first, and a hit then reads
+ * the data from the same row. The banks keep their rows open, and each access pays the row timing of the main memory's banks (tRP, tRCD, tCAS)
+ * and then waits for the data bus.
+ *
+ * Writes from the upper levels are allocated. Misses are sent to the lower level, and dirty victims are written back to it.
+ */
+class DRAM_CACHE : public champsim::operable
+{
+  using channel_type = champsim::channel;
+  using request_type = typename channel_type::request_type;
+  using response_type = typename channel_type::response_type;
+
+  enum class stage { tag_check, data_read, miss, complete };
+
+  struct request_entry {
+    request_type pkt;
+    channel_type* ul;
+    stage step;
+    bool data_ready; // whether the tag check also read the data
+    uint64_t event_cycle;
+    uint64_t cycle_enqueued;
+  };
+
+  struct bank_type {
+    std::size_t open_row = std::numeric_limits<std::size_t>::max();
+    uint64_t ready_cycle = 0;
+  };
+
+  std::vector<channel_type*> upper_levels;
+  channel_type* lower_level;
+
+  champsim::ring_buffer<request_entry> inflight{};
+  // Dirty victims waiting for the lower level. No block is installed while MSHR_SIZE of them are waiting.
+  champsim::ring_buffer<request_type> writebacks{};
+
+  // The tag, state, and last use of each block, by set and then way
+  std::vector<uint64_t> block_tags;
+  std::vector<uint8_t> block_valid, block_dirty;
+  std::vector<uint64_t> block_last_use;
+  std::vector<uint64_t> block_data;
+
+  // The set whose tags each entry of the tag cache holds
+  std::vector<uint64_t> tag_cache;
+
+  std::vector<bank_type> banks;
+  uint64_t dbus_cycle_available = 0;
+
+  std::size_t get_set(uint64_t address) const;
+  std::size_t find_way(std::size_t set, uint64_t address) const;
+
+  // Reserve the bank and data bus for an access to the set. Returns the cycle on which the data has been transferred.
+  uint64_t access_dram(std::size_t set);
+  // Whether the tag cache holds the tags of the set. A lookup that misses brings them in.
+  bool lookup_tag_cache(std::size_t set);
+
+  // Whether a block can be installed, which may write back its victim
+  bool can_install() const;
+  // Write the block into the set, evicting the least recently used block
+  void install(uint64_t address, uint64_t data, bool dirty);
+  void respond(const request_entry& entry, uint64_t data);
+
+  long receive_requests();
+  long check_tags();
+  long finish_reads();
+  long finish_misses();
+  long send_writebacks();
+
+public:
+  const std::string NAME;
+  const uint32_t NUM_SET, NUM_WAY, NUM_BANK, NUM_COLUMN;
+  const std::size_t QUEUE_SIZE, MSHR_SIZE;
+  const champsim::dram_cache_tags TAGS;
+  const uint64_t TAG_LATENCY;
+  const uint64_t tRP, tRCD, tCAS, DBUS_RETURN_TIME;
+
+  using stats_type = dram_cache_stats;
+  stats_type roi_stats, sim_stats;
+
+  class Builder
+  {
+    std::string m_name{};
+    double m_freq_scale{1};
+    int m_io_freq{3200};
+    uint32_t m_sets{};
+    uint32_t m_ways{1};
+    uint32_t m_banks{16};
+    uint32_t m_columns{32};
+    std::size_t m_channel_width{16};
+    double m_t_rp{12.5}, m_t_rcd{12.5}, m_t_cas{12.5};
+    champsim::dram_cache_tags m_tags{champsim::dram_cache_tags::in_dram};
+    uint32_t m_tag_cache_sets{};
+    uint64_t m_tag_latency{2};
+    std::size_t m_queue_size{64};
+    std::size_t m_mshr_size{32};
+    std::vector<channel_type*> m_uls{};
+    channel_type* m_ll{};
+
+    friend class DRAM_CACHE;
+
+  public:
+    Builder& name(std::string name_)
+    {
+      m_name = name_;
+      return *this;
+    }
+    Builder& frequency(double freq_scale_)
+    {
+      m_freq_scale = freq_scale_;
+      return *this;
+    }
+    /**
+     * The data rate of the stacked DRAM, in MT/s, by which its timings are converted to cycles
+     */
+    Builder& io_freq(int io_freq_)
+    {
+      m_io_freq = io_freq_;
+      return *this;
+    }
+    Builder& sets(uint32_t sets_)
+    {
+      m_sets = sets_;
+      return *this;
+    }
+    Builder& ways(uint32_t ways_)
+    {
+      m_ways = ways_;
+      return *this;
+    }
+    Builder& banks(uint32_t banks_)
+    {
+      m_banks = banks_;
+      return *this;
+    }
+    /**
+     * The blocks in each row of each bank
+     */
+    Builder& columns(uint32_t columns_)
+    {
+      m_columns = columns_;
+      return *this;
+    }
+    /**
+     * The width of the data bus, in bytes
+     */
+    Builder& channel_width(std::size_t channel_width_)
+    {
+      m_channel_width = channel_width_;
+      return *this;
+    }
+    /**
+     * The row timings, in nanoseconds
+     */
+    Builder& timing(double t_rp_, double t_rcd_, double t_cas_)
+    {
+      m_t_rp = t_rp_;
+      m_t_rcd = t_rcd_;
+      m_t_cas = t_cas_;
+      return *this;
+    }
+    /**
+     * Hold the tags of this many sets in an SRAM tag cache, which answers a lookup in tag_latency() cycles
+     */
+    Builder& tag_cache(uint32_t sets_)
+    {
+      m_tags = champsim::dram_cache_tags::tag_cache;
+      m_tag_cache_sets = sets_;
+      return *this;
+    }
+    Builder& tag_latency(uint64_t tag_latency_)
+    {
+      m_tag_latency = tag_latency_;
+      return *this;
+    }
+    /**
+     * The requests that may be in the DRAM cache at once, of which mshr_size() may be waiting for the lower level
+     */
+    Builder& queue_size(std::size_t queue_size_)
+    {
+      m_queue_size = queue_size_;
+      return *this;
+    }
+    /**
+     * The misses that may be waiting for the lower level at once. As many dirty victims may be waiting to be written back.
+     */
+    Builder& mshr_size(std::size_t mshr_size_)
+    {
+      m_mshr_size = mshr_size_;
+      return *this;
+    }
+    Builder& upper_levels(std::vector<channel_type*>&& uls_)
+    {
+      m_uls = std::move(uls_);
+      return *this;
+    }
+    Builder& lower_level(channel_type* ll_)
+    {
+      m_ll = ll_;
+      return *this;
+    }
+  };
+
+  explicit DRAM_CACHE(Builder b);
+
+  long operate() override final;
+  void begin_phase() override final;
+  void end_phase(unsigned cpu) override final;
+  void print_deadlock() override final;
+};
+
+#endif
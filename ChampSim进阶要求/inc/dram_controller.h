@@ -22,11 +22,15 @@
 #include <limits>
 #include <optional>
 #include <string>
+#include <utility>
 
 #include "champsim_constants.h"
 #include "channel.h"
 #include "operable.h"
 
+// The number of cycles at the given data rate, in MT/s, that the time, in microseconds, spans, rounded up
+uint64_t cycles(double time, int io_freq);
+
 struct dram_stats {
   std::string name{};
   uint64_t dbus_cycle_congested = 0, dbus_count_congested = 0;
@@ -49,8 +53,8 @@ struct DRAM_CHANNEL {
     uint64_t data = 0;
     uint64_t event_cycle = std::numeric_limits<uint64_t>::max();
 
-    std::vector<std::reference_wrapper<ooo_model_instr>> instr_depend_on_me{};
-    std::vector<std::deque<response_type>*> to_return{};
+    champsim::pooled_list<std::reference_wrapper<ooo_model_instr>> instr_depend_on_me{};
+    champsim::pooled_list<champsim::ring_buffer<response_type>*> to_return{};
 
     explicit request_type(typename champsim::channel::request_type);
   };
@@ -74,6 +78,7 @@ struct DRAM_CHANNEL {
 
   bool write_mode = false;
   uint64_t dbus_cycle_available = 0;
+  uint64_t dbus_busy_cycles = 0; // the cycles the data bus has carried transfers since the simulation began
 
   using stats_type = dram_stats;
   stats_type roi_stats, sim_stats;
@@ -114,6 +119,9 @@ public:
 
   std::size_t size() const;
 
+  // The cycles that the data buses of all channels have carried transfers, and the cycles that they could have, since the simulation began
+  std::pair<uint64_t, uint64_t> bus_usage() const;
+
   uint32_t dram_get_channel(uint64_t address);
   uint32_t dram_get_rank(uint64_t address);
   uint32_t dram_get_bank(uint64_t address);
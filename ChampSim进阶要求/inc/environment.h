@@ -21,6 +21,7 @@
 #include <vector>
 
 #include "cache.h"
+#include "dram_cache.h"
 #include "dram_controller.h"
 #include "ooo_cpu.h"
 #include "operable.h"
@@ -32,6 +33,7 @@ struct environment {
   virtual std::vector<std::reference_wrapper<O3_CPU>> cpu_view() = 0;
   virtual std::vector<std::reference_wrapper<CACHE>> cache_view() = 0;
   virtual std::vector<std::reference_wrapper<PageTableWalker>> ptw_view() = 0;
+  virtual std::vector<std::reference_wrapper<DRAM_CACHE>> dram_cache_view() = 0;
   virtual MEMORY_CONTROLLER& dram_view() = 0;
   virtual std::vector<std::reference_wrapper<operable>> operable_view() = 0;
 };
@@ -0,0 +1,288 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef INSTRUCTION_WINDOW_H
+#define INSTRUCTION_WINDOW_H
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "instruction.h"
+
+namespace champsim
+{
+/**
+ * The instructions in flight in a core, from fetch to retirement, held in program order in a single circular array.
+ *
+ * The array is allocated once, at the capacity given to the constructor (rounded up to a power of two). An instruction is moved into its slot
+ * when it is fetched and stays there until it retires, so a reference to an instruction is valid for as long as it is in flight.
+ *
+ * Each instruction is numbered in sequence as it enters the window. The pipeline stages are consecutive ranges of sequence numbers, the oldest
+ * first, so an instruction passes from one stage to the next when the boundary between them moves past it.
+ */
+class instruction_window
+{
+  std::vector<std::optional<ooo_model_instr>> slots;
+  std::size_t mask;
+
+  // The first sequence number of each stage, and then the next sequence number to be allocated
+  std::vector<uint64_t> bounds;
+
+  static std::size_t round_capacity(std::size_t capacity)
+  {
+    std::size_t size = 1;
+    while (size < capacity)
+      size <<= 1;
+    return size;
+  }
+
+  template <bool Const>
+  class basic_iterator
+  {
+    using window_type = std::conditional_t<Const, const instruction_window, instruction_window>;
+    window_type* window = nullptr;
+    uint64_t seq = 0;
+
+    friend class instruction_window;
+    template <bool>
+    friend class basic_iterator;
+
+    basic_iterator(window_type* win, uint64_t s) : window(win), seq(s) {}
+
+  public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = ooo_model_instr;
+    using difference_type = std::ptrdiff_t;
+    using pointer = std::conditional_t<Const, const ooo_model_instr*, ooo_model_instr*>;
+    using reference = std::conditional_t<Const, const ooo_model_instr&, ooo_model_instr&>;
+
+    basic_iterator() = default;
+
+    template <bool OtherConst, typename = std::enable_if_t<Const && !OtherConst>>
+    basic_iterator(const basic_iterator<OtherConst>& other) : window(other.window), seq(other.seq)
+    {
+    }
+
+    reference operator*() const { return (*window)[seq]; }
+    pointer operator->() const { return &(*window)[seq]; }
+    reference operator[](difference_type n) const { return *(*this + n); }
+
+    basic_iterator& operator++()
+    {
+      ++seq;
+      return *this;
+    }
+    basic_iterator operator++(int)
+    {
+      auto retval = *this;
+      ++seq;
+      return retval;
+    }
+    basic_iterator& operator--()
+    {
+      --seq;
+      return *this;
+    }
+    basic_iterator operator--(int)
+    {
+      auto retval = *this;
+      --seq;
+      return retval;
+    }
+    basic_iterator& operator+=(difference_type n)
+    {
+      seq += static_cast<uint64_t>(n);
+      return *this;
+    }
+    basic_iterator& operator-=(difference_type n)
+    {
+      seq -= static_cast<uint64_t>(n);
+      return *this;
+    }
+
+    friend basic_iterator operator+(basic_iterator it, difference_type n) { return it += n; }
+    friend basic_iterator operator+(difference_type n, basic_iterator it) { return it += n; }
+    friend basic_iterator operator-(basic_iterator it, difference_type n) { return it -= n; }
+    friend difference_type operator-(const basic_iterator& lhs, const basic_iterator& rhs) { return static_cast<difference_type>(lhs.seq - rhs.seq); }
+
+    friend bool operator==(const basic_iterator& lhs, const basic_iterator& rhs) { return lhs.seq == rhs.seq; }
+    friend bool operator!=(const basic_iterator& lhs, const basic_iterator& rhs) { return lhs.seq != rhs.seq; }
+    friend bool operator<(const basic_iterator& lhs, const basic_iterator& rhs) { return lhs.seq < rhs.seq; }
+    friend bool operator>(const basic_iterator& lhs, const basic_iterator& rhs) { return lhs.seq > rhs.seq; }
+    friend bool operator<=(const basic_iterator& lhs, const basic_iterator& rhs) { return lhs.seq <= rhs.seq; }
+    friend bool operator>=(const basic_iterator& lhs, const basic_iterator& rhs) { return lhs.seq >= rhs.seq; }
+  };
+
+public:
+  using iterator = basic_iterator<false>;
+  using const_iterator = basic_iterator<true>;
+
+private:
+  iterator iterator_to(uint64_t seq) { return iterator{this, seq}; }
+  const_iterator iterator_to(uint64_t seq) const { return const_iterator{this, seq}; }
+
+public:
+  /**
+   * One stage of the window, which reads as a queue of the instructions in it.
+   *
+   * Instructions can be added only to the youngest stage that holds any, since the stages are in program order, and leave a stage only from its
+   * front, by advancing to the stage after it in the pipeline.
+   */
+  class stage
+  {
+    instruction_window* window;
+    std::size_t index;
+
+    uint64_t first() const { return window->bounds[index]; }
+    uint64_t last() const { return window->bounds[index + 1]; }
+
+  public:
+    using value_type = ooo_model_instr;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using reference = ooo_model_instr&;
+    using const_reference = const ooo_model_instr&;
+    using iterator = instruction_window::iterator;
+    using const_iterator = instruction_window::const_iterator;
+
+    stage(instruction_window* win, std::size_t idx) : window(win), index(idx) { assert(index + 1 < std::size(window->bounds)); }
+
+    std::size_t size() const { return static_cast<std::size_t>(last() - first()); }
+    bool empty() const { return first() == last(); }
+
+    iterator begin() { return window->iterator_to(first()); }
+    iterator end() { return window->iterator_to(last()); }
+    const_iterator begin() const { return std::as_const(*window).iterator_to(first()); }
+    const_iterator end() const { return std::as_const(*window).iterator_to(last()); }
+    const_iterator cbegin() const { return begin(); }
+    const_iterator cend() const { return end(); }
+
+    ooo_model_instr& operator[](std::size_t pos) { return (*window)[first() + pos]; }
+    const ooo_model_instr& operator[](std::size_t pos) const { return (*window)[first() + pos]; }
+
+    ooo_model_instr& at(std::size_t pos)
+    {
+      if (pos >= size())
+        throw std::out_of_range{"instruction_window::stage::at"};
+      return (*this)[pos];
+    }
+    const ooo_model_instr& at(std::size_t pos) const { return const_cast<stage*>(this)->at(pos); }
+
+    ooo_model_instr& front()
+    {
+      assert(!empty());
+      return (*this)[0];
+    }
+    const ooo_model_instr& front() const
+    {
+      assert(!empty());
+      return (*this)[0];
+    }
+    ooo_model_instr& back()
+    {
+      assert(!empty());
+      return (*this)[size() - 1];
+    }
+    const ooo_model_instr& back() const
+    {
+      assert(!empty());
+      return (*this)[size() - 1];
+    }
+
+    template <typename... Args>
+    ooo_model_instr& emplace_back(Args&&... args)
+    {
+      return window->emplace(index, std::forward<Args>(args)...);
+    }
+
+    void push_back(const ooo_model_instr& instr) { emplace_back(instr); }
+    void push_back(ooo_model_instr&& instr) { emplace_back(std::move(instr)); }
+
+    template <typename InputIt>
+    iterator insert(const_iterator pos, InputIt first, InputIt last)
+    {
+      assert(pos == cend());
+      auto offset = std::distance(cbegin(), pos);
+      for (; first != last; ++first)
+        emplace_back(*first);
+      return std::next(begin(), offset);
+    }
+
+    // Pass the given number of instructions at the front of this stage to the next stage of the pipeline, or retire them from the last
+    void advance(std::size_t count) { window->advance(index, count); }
+  };
+
+  instruction_window(std::size_t capacity, std::size_t num_stages)
+      : slots(round_capacity(capacity)), mask(std::size(slots) - 1), bounds(num_stages + 1, 0)
+  {
+  }
+
+  std::size_t capacity() const { return std::size(slots); }
+  std::size_t size() const { return static_cast<std::size_t>(bounds.back() - bounds.front()); }
+  bool empty() const { return size() == 0; }
+
+  // The instruction with the given sequence number, which must be in the window
+  ooo_model_instr& operator[](uint64_t seq)
+  {
+    assert(bounds.front() <= seq && seq < bounds.back());
+    return *slots[seq & mask];
+  }
+  const ooo_model_instr& operator[](uint64_t seq) const
+  {
+    assert(bounds.front() <= seq && seq < bounds.back());
+    return *slots[seq & mask];
+  }
+
+  /**
+   * Construct an instruction at the back of the given stage, which must be the youngest stage that holds any instructions.
+   */
+  template <typename... Args>
+  ooo_model_instr& emplace(std::size_t index, Args&&... args)
+  {
+    assert(size() < capacity());
+    assert(bounds[index + 1] == bounds.back());
+
+    auto& slot = slots[bounds.back() & mask];
+    slot.emplace(std::forward<Args>(args)...);
+    for (auto it = std::next(std::begin(bounds), static_cast<long>(index) + 1); it != std::end(bounds); ++it)
+      ++(*it);
+    return *slot;
+  }
+
+  /**
+   * Pass the given number of instructions at the front of the given stage to the stage before it in the window, which is the next stage of the
+   * pipeline. Instructions that advance out of the first stage are retired.
+   */
+  void advance(std::size_t index, std::size_t count)
+  {
+    assert(bounds[index] + count <= bounds[index + 1]);
+    if (index == 0) {
+      for (auto seq = bounds[0]; seq != bounds[0] + count; ++seq)
+        slots[seq & mask].reset();
+    }
+    bounds[index] += count;
+  }
+};
+} // namespace champsim
+
+#endif
@@ -26,6 +26,15 @@ template <typename T>
 struct take_last {
   T operator()(T, T last) const { return last; }
 };
+
+// The position of a module among the modules whose flags are set, counting from the lowest flag
+constexpr unsigned module_slot(unsigned long long flags, unsigned long long module)
+{
+  unsigned slot = 0;
+  for (auto lower = flags & (module - 1); lower != 0; lower &= lower - 1)
+    ++slot;
+  return slot;
+}
 } // namespace detail
 
 } // namespace champsim
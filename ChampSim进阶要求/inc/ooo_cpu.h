@@ -22,6 +22,7 @@
 #ifndef OOO_CPU_H
 #define OOO_CPU_H
 
+#include <algorithm>
 #include <array>
 #include <bitset>
 #include <deque>
@@ -36,9 +37,11 @@
 #include "champsim_constants.h"
 #include "channel.h"
 #include "instruction.h"
+#include "instruction_window.h"
 #include "module_impl.h"
 #include "operable.h"
 #include "util/lru_table.h"
+#include "util/timing_wheel.h"
 #include <type_traits>
 
 enum STATUS { INFLIGHT = 1, COMPLETED = 2 };
@@ -70,6 +73,11 @@ struct cpu_stats {
   std::array<long long, 8> total_branch_types = {};
   std::array<long long, 8> branch_type_misses = {};
 
+  // Stores gathered by the write-combining buffer, those that joined a block it already held, and the blocks it wrote to the L1D
+  uint64_t wc_stores = 0;
+  uint64_t wc_merges = 0;
+  uint64_t wc_writes = 0;
+
   uint64_t instrs() const { return end_instrs - begin_instrs; }
   uint64_t cycles() const { return end_cycles - begin_cycles; }
 };
@@ -87,7 +95,16 @@ struct LSQ_ENTRY {
   std::vector<std::reference_wrapper<std::optional<LSQ_ENTRY>>> lq_depend_on_me{};
 
   LSQ_ENTRY(uint64_t id, uint64_t addr, uint64_t ip, std::array<uint8_t, 2> asid);
-  void finish(std::deque<ooo_model_instr>::iterator begin, std::deque<ooo_model_instr>::iterator end) const;
+  // Count one of the memory operations of the instruction in the ROB as done, and return the instruction
+  ooo_model_instr& finish(champsim::instruction_window::iterator begin, champsim::instruction_window::iterator end) const;
+};
+
+// A block in the write-combining buffer, which gathers the stores to it into a single write
+struct WC_ENTRY {
+  uint64_t instr_id = 0; // the first store to the block
+  uint64_t virtual_address = 0;
+  uint64_t ip = 0;
+  uint64_t event_cycle = 0; // the cycle on which the block was opened
 };
 
 // cpu
@@ -122,14 +139,18 @@ public:
   using dib_type = champsim::lru_table<uint64_t, dib_shift, dib_shift>;
   dib_type DIB;
 
+  // The instructions in flight, which the fetch, decode, and dispatch buffers and the reorder buffer hold in consecutive stages
+  champsim::instruction_window instr_window;
+
   // reorder buffer, load/store queue, register file
-  std::deque<ooo_model_instr> IFETCH_BUFFER;
-  std::deque<ooo_model_instr> DISPATCH_BUFFER;
-  std::deque<ooo_model_instr> DECODE_BUFFER;
-  std::deque<ooo_model_instr> ROB;
+  champsim::instruction_window::stage ROB{&instr_window, 0};
+  champsim::instruction_window::stage DISPATCH_BUFFER{&instr_window, 1};
+  champsim::instruction_window::stage DECODE_BUFFER{&instr_window, 2};
+  champsim::instruction_window::stage IFETCH_BUFFER{&instr_window, 3};
 
   std::vector<std::optional<LSQ_ENTRY>> LQ;
   std::deque<LSQ_ENTRY> SQ;
+  std::deque<WC_ENTRY> WC_BUFFER;
 
   std::array<std::vector<std::reference_wrapper<ooo_model_instr>>, std::numeric_limits<uint8_t>::max() + 1> reg_producers;
 
@@ -140,6 +161,8 @@ public:
   const long int RETIRE_WIDTH;
   const unsigned BRANCH_MISPREDICT_PENALTY, DISPATCH_LATENCY, DECODE_LATENCY, SCHEDULING_LATENCY, EXEC_LATENCY;
   const long int L1I_BANDWIDTH, L1D_BANDWIDTH;
+  const std::size_t WC_BUFFER_SIZE; // the blocks in the write-combining buffer, or 0 if stores are written to the L1D individually
+  const uint64_t WC_BUFFER_TIMEOUT; // the cycles a block stays open in the write-combining buffer
 
   // branch
   uint64_t fetch_resume_cycle = 0;
@@ -150,6 +173,17 @@ public:
   CacheBus L1I_bus, L1D_bus;
   CACHE* l1i;
 
+  // The instructions at the head of the ROB that have been scheduled, and those of them that are waiting to execute
+  std::size_t num_scheduled = 0;
+  long scheduler_occupancy = 0;
+
+  // Scheduled instructions wake up on their event cycle once their register dependencies are satisfied, and executing instructions wake up
+  // on theirs to complete once their memory operations are done. The awake instructions wait in heaps ordered oldest first.
+  champsim::timing_wheel<ooo_model_instr*> execute_wakeups;
+  champsim::timing_wheel<ooo_model_instr*> complete_wakeups;
+  std::vector<ooo_model_instr*> ready_to_execute{};
+  std::vector<ooo_model_instr*> ready_to_complete{};
+
   void initialize() override final;
   long operate() override final;
   void begin_phase() override final;
@@ -164,23 +198,40 @@ public:
   long schedule_instruction();
   long execute_instruction();
   long operate_lsq();
+  long drain_wc_buffer();
   long complete_inflight_instruction();
   long handle_memory_return();
   long retire_rob();
 
   bool do_init_instruction(ooo_model_instr& instr);
   bool do_predict_branch(ooo_model_instr& instr);
+
+  // The parts of operate() that call the branch predictor and BTB, specialized on the type through which they are called.
+  // M is module_concept if the modules are called virtually, or the module_model they are bound into.
+  template <typename M>
+  long operate_with();
+  template <typename M>
+  void initialize_instruction(M& modules);
+  template <typename M>
+  bool do_init_instruction(M& modules, ooo_model_instr& instr);
+  template <typename M>
+  bool do_predict_branch(M& modules, ooo_model_instr& instr);
+  long (O3_CPU::*operate_impl)();
+
   void do_check_dib(ooo_model_instr& instr);
-  bool do_fetch_instruction(std::deque<ooo_model_instr>::iterator begin, std::deque<ooo_model_instr>::iterator end);
+  bool do_fetch_instruction(champsim::instruction_window::iterator begin, champsim::instruction_window::iterator end);
   void do_dib_update(const ooo_model_instr& instr);
   void do_scheduling(ooo_model_instr& instr);
   void do_execution(ooo_model_instr& rob_it);
   void do_memory_scheduling(ooo_model_instr& instr);
   void do_complete_execution(ooo_model_instr& instr);
+  void wake_execution(ooo_model_instr& instr);
+  void wake_completion(ooo_model_instr& instr);
   void do_sq_forward_to_lq(LSQ_ENTRY& sq_entry, LSQ_ENTRY& lq_entry);
 
   void do_finish_store(const LSQ_ENTRY& sq_entry);
   bool do_complete_store(const LSQ_ENTRY& sq_entry);
+  bool do_combine_store(const LSQ_ENTRY& sq_entry);
   bool execute_load(const LSQ_ENTRY& lq_entry);
 
   uint64_t roi_instr() const { return roi_stats.instrs(); }
@@ -237,10 +288,10 @@ public:
   class builder_conversion_tag
   {
   };
-  template <unsigned long long B_FLAG = 0, unsigned long long T_FLAG = 0>
+  template <unsigned long long B_FLAG = 0, unsigned long long T_FLAG = 0, bool BIND_MODULES = false>
   class Builder
   {
-    using self_type = Builder<B_FLAG, T_FLAG>;
+    using self_type = Builder<B_FLAG, T_FLAG, BIND_MODULES>;
 
     uint32_t m_cpu{};
     double m_freq_scale{};
@@ -270,13 +321,15 @@ public:
     CACHE* m_l1i{};
     long int m_l1i_bw{};
     long int m_l1d_bw{};
+    std::size_t m_wc_buffer_size{};
+    uint64_t m_wc_buffer_timeout{100};
     champsim::channel* m_fetch_queues{};
     champsim::channel* m_data_queues{};
 
     friend class O3_CPU;
 
-    template <unsigned long long OTHER_B, unsigned long long OTHER_T>
-    Builder(builder_conversion_tag, const Builder<OTHER_B, OTHER_T>& other)
+    template <unsigned long long OTHER_B, unsigned long long OTHER_T, bool OTHER_BIND>
+    Builder(builder_conversion_tag, const Builder<OTHER_B, OTHER_T, OTHER_BIND>& other)
         : m_cpu(other.m_cpu), m_freq_scale(other.m_freq_scale), m_dib_set(other.m_dib_set), m_dib_way(other.m_dib_way), m_dib_window(other.m_dib_window),
           m_ifetch_buffer_size(other.m_ifetch_buffer_size), m_decode_buffer_size(other.m_decode_buffer_size),
           m_dispatch_buffer_size(other.m_dispatch_buffer_size), m_rob_size(other.m_rob_size), m_lq_size(other.m_lq_size), m_sq_size(other.m_sq_size),
@@ -284,7 +337,8 @@ public:
           m_schedule_width(other.m_schedule_width), m_execute_width(other.m_execute_width), m_lq_width(other.m_lq_width), m_sq_width(other.m_sq_width),
           m_retire_width(other.m_retire_width), m_mispredict_penalty(other.m_mispredict_penalty), m_decode_latency(other.m_decode_latency),
           m_dispatch_latency(other.m_dispatch_latency), m_schedule_latency(other.m_schedule_latency), m_execute_latency(other.m_execute_latency),
-          m_l1i(other.m_l1i), m_l1i_bw(other.m_l1i_bw), m_l1d_bw(other.m_l1d_bw), m_fetch_queues(other.m_fetch_queues), m_data_queues(other.m_data_queues)
+          m_l1i(other.m_l1i), m_l1i_bw(other.m_l1i_bw), m_l1d_bw(other.m_l1d_bw), m_wc_buffer_size(other.m_wc_buffer_size),
+          m_wc_buffer_timeout(other.m_wc_buffer_timeout), m_fetch_queues(other.m_fetch_queues), m_data_queues(other.m_data_queues)
     {
     }
 
@@ -426,6 +480,20 @@ public:
       m_l1d_bw = l1d_bw_;
       return *this;
     }
+    /**
+     * Gather completed stores to the same block in a write-combining buffer of this many blocks, each of which is written to the L1D once.
+     * A block is written when it has been open for wc_buffer_timeout() cycles, or when the buffer is full.
+     */
+    self_type& wc_buffer_size(std::size_t wc_buffer_size_)
+    {
+      m_wc_buffer_size = wc_buffer_size_;
+      return *this;
+    }
+    self_type& wc_buffer_timeout(uint64_t wc_buffer_timeout_)
+    {
+      m_wc_buffer_timeout = wc_buffer_timeout_;
+      return *this;
+    }
     self_type& fetch_queues(champsim::channel* fetch_queues_)
     {
       m_fetch_queues = fetch_queues_;
@@ -438,26 +506,34 @@ public:
     }
 
     template <unsigned long long B>
-    Builder<B, T_FLAG> branch_predictor()
+    Builder<B, T_FLAG, BIND_MODULES> branch_predictor()
     {
-      return Builder<B, T_FLAG>{builder_conversion_tag{}, *this};
+      return Builder<B, T_FLAG, BIND_MODULES>{builder_conversion_tag{}, *this};
     }
     template <unsigned long long T>
-    Builder<B_FLAG, T> btb()
+    Builder<B_FLAG, T, BIND_MODULES> btb()
     {
-      return Builder<B_FLAG, T>{builder_conversion_tag{}, *this};
+      return Builder<B_FLAG, T, BIND_MODULES>{builder_conversion_tag{}, *this};
     }
+    /**
+     * Call the branch predictor and BTB modules directly from the core's simulation loop, rather than through a virtual interface.
+     * The specialization must be instantiated in src/ooo_cpu.cc, which the configuration script does for each core.
+     */
+    Builder<B_FLAG, T_FLAG, true> bind_modules() { return Builder<B_FLAG, T_FLAG, true>{builder_conversion_tag{}, *this}; }
   };
 
-  template <unsigned long long B_FLAG, unsigned long long T_FLAG>
-  explicit O3_CPU(Builder<B_FLAG, T_FLAG> b)
+  template <unsigned long long B_FLAG, unsigned long long T_FLAG, bool BIND_MODULES>
+  explicit O3_CPU(Builder<B_FLAG, T_FLAG, BIND_MODULES> b)
       : champsim::operable(b.m_freq_scale), cpu(b.m_cpu), DIB(b.m_dib_set, b.m_dib_way, {champsim::lg2(b.m_dib_window)}, {champsim::lg2(b.m_dib_window)}),
-        LQ(b.m_lq_size), IFETCH_BUFFER_SIZE(b.m_ifetch_buffer_size), DISPATCH_BUFFER_SIZE(b.m_dispatch_buffer_size), DECODE_BUFFER_SIZE(b.m_decode_buffer_size),
+        instr_window(b.m_ifetch_buffer_size + b.m_decode_buffer_size + b.m_dispatch_buffer_size + b.m_rob_size, 4), LQ(b.m_lq_size), IFETCH_BUFFER_SIZE(b.m_ifetch_buffer_size), DISPATCH_BUFFER_SIZE(b.m_dispatch_buffer_size), DECODE_BUFFER_SIZE(b.m_decode_buffer_size),
         ROB_SIZE(b.m_rob_size), SQ_SIZE(b.m_sq_size), FETCH_WIDTH(b.m_fetch_width), DECODE_WIDTH(b.m_decode_width), DISPATCH_WIDTH(b.m_dispatch_width),
         SCHEDULER_SIZE(b.m_schedule_width), EXEC_WIDTH(b.m_execute_width), LQ_WIDTH(b.m_lq_width), SQ_WIDTH(b.m_sq_width), RETIRE_WIDTH(b.m_retire_width),
         BRANCH_MISPREDICT_PENALTY(b.m_mispredict_penalty), DISPATCH_LATENCY(b.m_dispatch_latency), DECODE_LATENCY(b.m_decode_latency),
         SCHEDULING_LATENCY(b.m_schedule_latency), EXEC_LATENCY(b.m_execute_latency), L1I_BANDWIDTH(b.m_l1i_bw), L1D_BANDWIDTH(b.m_l1d_bw),
-        L1I_bus(b.m_cpu, b.m_fetch_queues), L1D_bus(b.m_cpu, b.m_data_queues), l1i(b.m_l1i), module_pimpl(std::make_unique<module_model<B_FLAG, T_FLAG>>(this))
+        WC_BUFFER_SIZE(b.m_wc_buffer_size), WC_BUFFER_TIMEOUT(b.m_wc_buffer_timeout), L1I_bus(b.m_cpu, b.m_fetch_queues), L1D_bus(b.m_cpu, b.m_data_queues), l1i(b.m_l1i),
+        execute_wakeups(std::max(b.m_schedule_latency, b.m_execute_latency)), complete_wakeups(std::max(b.m_schedule_latency, b.m_execute_latency)),
+        operate_impl(&O3_CPU::operate_with<std::conditional_t<BIND_MODULES, module_model<B_FLAG, T_FLAG>, module_concept>>),
+        module_pimpl(std::make_unique<module_model<B_FLAG, T_FLAG>>(this))
   {
   }
 };
@@ -0,0 +1,73 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef PREFETCH_THROTTLE_H
+#define PREFETCH_THROTTLE_H
+
+#include <cstdint>
+#include <limits>
+
+namespace champsim
+{
+// The running totals from which a throttle measures each interval. Each is counted since the simulation began.
+struct prefetch_feedback {
+  uint64_t issued = 0;
+  uint64_t useful = 0;
+  uint64_t late = 0;
+  uint64_t pollution = 0;
+  uint64_t demand_misses = 0;
+
+  // The cycles that the memory's data buses carried transfers, and the cycles that they could have
+  uint64_t bus_busy = 0;
+  uint64_t bus_cycles = 0;
+};
+
+/**
+ * Adjusts the aggressiveness of a cache's prefetcher by the feedback of each interval (feedback-directed prefetching).
+ *
+ * At the end of each interval, update() measures the accuracy of the interval's prefetches, the fraction of them that demands found still in
+ * flight, the fraction of the demand misses that were to blocks the prefetches had evicted, and the utilization of the memory's data buses. An
+ * accurate prefetcher that is late is made more aggressive, and one that pollutes the cache or wastes a busy memory's bandwidth is made less so.
+ *
+ * The level runs from 1 (most conservative) to max_level, and begins in the middle. budget() gives the prefetches that each trigger of the
+ * prefetcher may issue at the current level.
+ */
+class prefetch_throttle
+{
+  prefetch_feedback last{};
+  unsigned current_level = middle_level;
+
+public:
+  constexpr static unsigned max_level = 5;
+  constexpr static unsigned middle_level = 3;
+
+  constexpr static double accuracy_high = 0.75;
+  constexpr static double accuracy_low = 0.40;
+  constexpr static double lateness_threshold = 0.01;
+  constexpr static double pollution_threshold = 0.005;
+  constexpr static double bandwidth_threshold = 0.75;
+
+  // Measure the interval that ends with these totals, and move the level by at most one step
+  void update(const prefetch_feedback& totals);
+  // Begin a new interval from these totals, keeping the level, as when the counts they come from are cleared
+  void restart(const prefetch_feedback& totals);
+
+  unsigned level() const;
+  uint64_t budget() const;
+};
+} // namespace champsim
+
+#endif
@@ -18,12 +18,12 @@
 #define PTW_H
 
 #include <array>
-#include <deque>
 #include <string>
 
 #include "channel.h"
 #include "operable.h"
 #include "util/lru_table.h"
+#include "util/ring_buffer.h"
 
 class VirtualMemory;
 class PageTableWalker : public champsim::operable
@@ -49,8 +49,8 @@ class PageTableWalker : public champsim::operable
     uint64_t v_address = 0;
     uint64_t data = 0;
 
-    std::vector<std::reference_wrapper<ooo_model_instr>> instr_depend_on_me{};
-    std::vector<std::deque<response_type>*> to_return{};
+    champsim::pooled_list<std::reference_wrapper<ooo_model_instr>> instr_depend_on_me{};
+    champsim::pooled_list<champsim::ring_buffer<response_type>*> to_return{};
 
     uint64_t event_cycle = std::numeric_limits<uint64_t>::max();
     uint32_t pf_metadata = 0;
@@ -62,9 +62,9 @@ class PageTableWalker : public champsim::operable
     mshr_type(request_type req, std::size_t level);
   };
 
-  std::deque<mshr_type> MSHR;
-  std::deque<mshr_type> finished;
-  std::deque<mshr_type> completed;
+  champsim::ring_buffer<mshr_type> MSHR;
+  champsim::ring_buffer<mshr_type> finished;
+  champsim::ring_buffer<mshr_type> completed;
 
   std::vector<channel_type*> upper_levels;
   channel_type* lower_level;
@@ -0,0 +1,174 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SLICE_NETWORK_H
+#define SLICE_NETWORK_H
+
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "channel.h"
+#include "operable.h"
+#include "util/ring_buffer.h"
+
+namespace champsim
+{
+// How the upper levels and the slices are connected. Each upper level and each slice sits at a stop, and a packet travels over the links between stops.
+enum class slice_topology { ring, mesh };
+} // namespace champsim
+
+/**
+ * An on-chip network that connects the upper levels of a cache that has been divided into slices to those slices.
+ * Each request is sent to the slice selected by a hash of its block address, and takes a number of hops to get there that depends on the topology.
+ * The responses of the slices travel back the same way.
+ */
+class SliceNetwork : public champsim::operable
+{
+  using channel_type = champsim::channel;
+  using request_type = typename channel_type::request_type;
+  using response_type = typename channel_type::response_type;
+
+  enum class queue_kind { RQ, WQ, PQ };
+
+  struct request_in_flight {
+    request_type pkt;
+    queue_kind kind;
+    std::size_t upper;
+    std::size_t slice;
+    uint64_t event_cycle;
+  };
+
+  struct response_in_flight {
+    response_type pkt;
+    std::size_t upper;
+    uint64_t event_cycle;
+  };
+
+  std::vector<channel_type*> upper_levels;
+
+  // The channels into each slice, one for each upper level, so that each slice returns its responses to the upper level that requested them
+  std::vector<std::vector<channel_type*>> slices;
+
+  champsim::ring_buffer<request_in_flight> requests{};
+  champsim::ring_buffer<response_in_flight> responses{};
+
+  // The requests from each upper level that have left its queues and have not yet reached their slice
+  std::vector<std::size_t> upper_in_flight{};
+
+  // Packets that have crossed each link in the current cycle
+  std::vector<long> upper_link_use{};
+  std::vector<long> slice_link_use{};
+
+  long receive_requests();
+  long deliver_requests();
+  long receive_responses();
+  long deliver_responses();
+
+public:
+  const std::string NAME;
+  const unsigned OFFSET_BITS;
+  const champsim::slice_topology TOPOLOGY;
+  const uint64_t HOP_LATENCY;
+  const long int LINK_BANDWIDTH;
+  const std::size_t LINK_BUFFER_SIZE;
+
+  class Builder
+  {
+    std::string m_name{};
+    double m_freq_scale{1};
+    unsigned m_offset_bits{};
+    champsim::slice_topology m_topology{champsim::slice_topology::ring};
+    uint64_t m_hop_latency{1};
+    uint32_t m_link_bandwidth{1};
+    std::size_t m_link_buffer{32};
+    std::vector<channel_type*> m_uls{};
+    std::vector<std::vector<channel_type*>> m_slices{};
+
+    friend class SliceNetwork;
+
+  public:
+    Builder& name(std::string name_)
+    {
+      m_name = name_;
+      return *this;
+    }
+    Builder& frequency(double freq_scale_)
+    {
+      m_freq_scale = freq_scale_;
+      return *this;
+    }
+    Builder& offset_bits(unsigned offset_bits_)
+    {
+      m_offset_bits = offset_bits_;
+      return *this;
+    }
+    Builder& topology(champsim::slice_topology topology_)
+    {
+      m_topology = topology_;
+      return *this;
+    }
+    /**
+     * The cycles that a packet takes to cross each link between stops. Every packet also takes a cycle to enter the network.
+     */
+    Builder& hop_latency(uint64_t hop_latency_)
+    {
+      m_hop_latency = hop_latency_;
+      return *this;
+    }
+    /**
+     * The packets that may enter or leave the network at each stop per cycle
+     */
+    Builder& link_bandwidth(uint32_t link_bandwidth_)
+    {
+      m_link_bandwidth = link_bandwidth_;
+      return *this;
+    }
+    /**
+     * The requests that each upper level may have travelling in the network at once
+     */
+    Builder& link_buffer_size(std::size_t link_buffer_)
+    {
+      m_link_buffer = link_buffer_;
+      return *this;
+    }
+    Builder& upper_levels(std::vector<channel_type*>&& uls_)
+    {
+      m_uls = std::move(uls_);
+      return *this;
+    }
+    /**
+     * The channels into each slice. Each slice has a channel for each upper level, in the order given to upper_levels().
+     */
+    Builder& slices(std::vector<std::vector<channel_type*>>&& slices_)
+    {
+      m_slices = std::move(slices_);
+      return *this;
+    }
+  };
+
+  explicit SliceNetwork(Builder b);
+
+  std::size_t get_slice(uint64_t address) const;
+  uint64_t hops(std::size_t upper, std::size_t slice) const;
+
+  void initialize() override final;
+  long operate() override final;
+  void print_deadlock() override final;
+};
+
+#endif
@@ -18,6 +18,7 @@
 #include <vector>
 
 #include "cache.h"
+#include "dram_cache.h"
 #include "dram_controller.h"
 #include "ooo_cpu.h"
 #include "phase_info.h"
@@ -30,6 +31,7 @@ class plain_printer
 
   void print(O3_CPU::stats_type);
   void print(CACHE::stats_type);
+  void print(DRAM_CACHE::stats_type);
   void print(DRAM_CHANNEL::stats_type);
 
   template <typename T>
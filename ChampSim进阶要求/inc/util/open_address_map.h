@@ -0,0 +1,125 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef UTIL_OPEN_ADDRESS_MAP_H
+#define UTIL_OPEN_ADDRESS_MAP_H
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+namespace champsim
+{
+/**
+ * A fixed-capacity map from 64-bit keys to values, stored in a single flat array with linear probing.
+ * The table is sized for at most twice the requested capacity, so probe sequences stay short and no allocation occurs after construction.
+ * Erasure shifts later members of the probe sequence backward, so there are no tombstones.
+ */
+template <typename V>
+class open_address_map
+{
+  struct slot {
+    uint64_t key = 0;
+    V value{};
+    bool occupied = false;
+  };
+
+  std::vector<slot> slots;
+  std::size_t mask;
+  std::size_t occupancy = 0;
+
+  std::size_t home(uint64_t key) const
+  {
+    // Fibonacci hashing; block addresses differ mostly in their low bits
+    return static_cast<std::size_t>((key * 0x9e3779b97f4a7c15ull) >> 32) & mask;
+  }
+
+  static std::size_t table_size(std::size_t capacity)
+  {
+    std::size_t size = 2;
+    while (size < 2 * capacity)
+      size <<= 1;
+    return size;
+  }
+
+public:
+  explicit open_address_map(std::size_t capacity) : slots(table_size(capacity)), mask(std::size(slots) - 1) {}
+
+  std::size_t size() const { return occupancy; }
+  std::size_t capacity() const { return std::size(slots) / 2; }
+  bool empty() const { return occupancy == 0; }
+
+  V* find(uint64_t key)
+  {
+    for (auto idx = home(key); slots[idx].occupied; idx = (idx + 1) & mask) {
+      if (slots[idx].key == key)
+        return &slots[idx].value;
+    }
+    return nullptr;
+  }
+
+  const V* find(uint64_t key) const { return const_cast<open_address_map*>(this)->find(key); }
+
+  /**
+   * Insert the key, or overwrite its value if it is already present.
+   */
+  void insert_or_assign(uint64_t key, V value)
+  {
+    auto idx = home(key);
+    for (; slots[idx].occupied; idx = (idx + 1) & mask) {
+      if (slots[idx].key == key) {
+        slots[idx].value = value;
+        return;
+      }
+    }
+
+    assert(occupancy < std::size(slots) - 1);
+    slots[idx] = {key, value, true};
+    ++occupancy;
+  }
+
+  bool erase(uint64_t key)
+  {
+    auto idx = home(key);
+    for (; slots[idx].occupied && slots[idx].key != key; idx = (idx + 1) & mask) {
+    }
+
+    if (!slots[idx].occupied)
+      return false;
+
+    // Move later members of the probe sequence into the hole, if doing so does not carry them past their home slot
+    for (auto next = (idx + 1) & mask; slots[next].occupied; next = (next + 1) & mask) {
+      if (((next - home(slots[next].key)) & mask) >= ((next - idx) & mask)) {
+        slots[idx] = slots[next];
+        idx = next;
+      }
+    }
+
+    slots[idx] = {};
+    --occupancy;
+    return true;
+  }
+
+  void clear()
+  {
+    std::fill(std::begin(slots), std::end(slots), slot{});
+    occupancy = 0;
+  }
+};
+} // namespace champsim
+
+#endif
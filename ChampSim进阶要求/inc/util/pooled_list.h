@@ -0,0 +1,199 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef UTIL_POOLED_LIST_H
+#define UTIL_POOLED_LIST_H
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+namespace champsim
+{
+/**
+ * The number of times any pooled_list has needed storage of its own, either for new contents or to copy shared contents before a write.
+ */
+inline uint64_t pooled_list_allocations = 0;
+
+/**
+ * A handle to an immutable-until-written list, whose storage is shared between copies and recycled through a pool.
+ *
+ * Copying a handle only increments a reference count, so packets can carry their dependency lists from hop to hop without copying them.
+ * A handle that is written while its storage is shared first takes a private copy. Storage that is released returns to a free list with
+ * its capacity intact, so that steady-state simulation does not reach the heap allocator. Empty lists hold no storage at all.
+ */
+template <typename T>
+class pooled_list
+{
+  struct node {
+    std::vector<T> items{};
+    std::size_t refs = 0;
+  };
+
+  static std::vector<node*>& free_nodes()
+  {
+    // Never destroyed, so that lists held by objects with static storage duration may be released at any time
+    static auto* nodes = new std::vector<node*>{};
+    return *nodes;
+  }
+
+  static node* acquire()
+  {
+    ++pooled_list_allocations;
+
+    auto& pool = free_nodes();
+    if (std::empty(pool))
+      return new node{};
+
+    auto* retval = pool.back();
+    pool.pop_back();
+    return retval;
+  }
+
+  void release()
+  {
+    if (storage != nullptr && --storage->refs == 0) {
+      storage->items.clear();
+      free_nodes().push_back(storage);
+    }
+    storage = nullptr;
+  }
+
+  // Make this handle the sole owner of its storage, so that it may be written
+  std::vector<T>& writable()
+  {
+    if (storage == nullptr) {
+      storage = acquire();
+      storage->refs = 1;
+    } else if (storage->refs > 1) {
+      auto* copy = acquire();
+      copy->items = storage->items;
+      copy->refs = 1;
+      --storage->refs;
+      storage = copy;
+    }
+    return storage->items;
+  }
+
+  node* storage = nullptr;
+
+public:
+  using value_type = T;
+  using const_iterator = typename std::vector<T>::const_iterator;
+  using iterator = const_iterator;
+  using size_type = std::size_t;
+
+  pooled_list() = default;
+  pooled_list(std::initializer_list<T> init) { assign(std::begin(init), std::end(init)); }
+
+  template <typename It, typename = typename std::iterator_traits<It>::iterator_category>
+  pooled_list(It first, It last)
+  {
+    assign(first, last);
+  }
+
+  pooled_list(const pooled_list& other) : storage(other.storage)
+  {
+    if (storage != nullptr)
+      ++storage->refs;
+  }
+
+  pooled_list(pooled_list&& other) noexcept : storage(std::exchange(other.storage, nullptr)) {}
+
+  pooled_list& operator=(const pooled_list& other)
+  {
+    if (other.storage != nullptr)
+      ++other.storage->refs;
+    release();
+    storage = other.storage;
+    return *this;
+  }
+
+  pooled_list& operator=(pooled_list&& other) noexcept
+  {
+    if (this != &other) {
+      release();
+      storage = std::exchange(other.storage, nullptr);
+    }
+    return *this;
+  }
+
+  ~pooled_list() { release(); }
+
+  template <typename It>
+  void assign(It first, It last)
+  {
+    release();
+    if (first != last)
+      writable().assign(first, last);
+  }
+
+  const_iterator begin() const { return storage == nullptr ? const_iterator{} : std::cbegin(storage->items); }
+  const_iterator end() const { return storage == nullptr ? const_iterator{} : std::cend(storage->items); }
+  size_type size() const { return storage == nullptr ? 0 : std::size(storage->items); }
+  bool empty() const { return size() == 0; }
+
+  const T& front() const
+  {
+    assert(!empty());
+    return storage->items.front();
+  }
+
+  void push_back(const T& value) { writable().push_back(value); }
+
+  const_iterator erase(const_iterator pos)
+  {
+    auto offset = std::distance(begin(), pos);
+    auto& items = writable();
+    auto retval = items.erase(std::next(std::cbegin(items), offset));
+    if (std::empty(items)) {
+      release();
+      return end();
+    }
+    return retval;
+  }
+
+  void clear() { release(); }
+
+  /**
+   * Whether the two handles refer to the same storage. Handles that do are certainly equal.
+   */
+  bool shares_storage_with(const pooled_list& other) const { return storage == other.storage; }
+};
+
+/**
+ * Form the sorted union of two sorted lists. Where one list is empty or both share storage, the result shares storage with an input.
+ */
+template <typename T, typename Compare = std::less<>>
+pooled_list<T> merge_sorted(const pooled_list<T>& lhs, const pooled_list<T>& rhs, Compare comp = {})
+{
+  if (std::empty(rhs) || lhs.shares_storage_with(rhs))
+    return lhs;
+  if (std::empty(lhs))
+    return rhs;
+
+  pooled_list<T> retval{};
+  std::set_union(std::begin(lhs), std::end(lhs), std::begin(rhs), std::end(rhs), std::back_inserter(retval), comp);
+  return retval;
+}
+} // namespace champsim
+
+#endif
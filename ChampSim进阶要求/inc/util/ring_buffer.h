@@ -0,0 +1,326 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef UTIL_RING_BUFFER_H
+#define UTIL_RING_BUFFER_H
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace champsim
+{
+/**
+ * A double-ended queue held in a single circular array, for queues whose capacity is known when they are built.
+ *
+ * The array is allocated once, at the capacity given to the constructor (rounded up to a power of two), and elements are constructed in place,
+ * so pushing and popping never allocate. Queues without a configured bound grow by doubling when full, so they allocate only until they
+ * reach their high-water mark. Erasing from the middle moves whichever side of the erased range is shorter. Iterators are random-access,
+ * and are invalidated by any insertion or erasure.
+ */
+template <typename T>
+class ring_buffer
+{
+  T* storage = nullptr;
+  std::size_t mask = 0;
+  std::size_t head = 0;
+  std::size_t occupancy = 0;
+
+  static std::size_t round_capacity(std::size_t capacity)
+  {
+    std::size_t size = 1;
+    while (size < capacity)
+      size <<= 1;
+    return size;
+  }
+
+  T* slot(std::size_t pos) const { return storage + ((head + pos) & mask); }
+
+  // Move the contents into a new array of the given capacity. If an element is to be added at the back, it is constructed before the
+  // old array is released, so that its arguments may refer to an element of this buffer.
+  template <typename... Args>
+  void reallocate(std::size_t new_capacity, Args&&... args)
+  {
+    auto* new_storage = std::allocator<T>{}.allocate(new_capacity);
+    if constexpr (sizeof...(Args) > 0)
+      ::new (static_cast<void*>(new_storage + occupancy)) T(std::forward<Args>(args)...);
+
+    for (std::size_t i = 0; i < occupancy; ++i) {
+      ::new (static_cast<void*>(new_storage + i)) T(std::move(*slot(i)));
+      std::destroy_at(slot(i));
+    }
+
+    if (storage != nullptr)
+      std::allocator<T>{}.deallocate(storage, capacity());
+    storage = new_storage;
+    mask = new_capacity - 1;
+    head = 0;
+    if constexpr (sizeof...(Args) > 0)
+      ++occupancy;
+  }
+
+  template <bool Const>
+  class basic_iterator
+  {
+    using buffer_type = std::conditional_t<Const, const ring_buffer, ring_buffer>;
+    buffer_type* buffer = nullptr;
+    std::ptrdiff_t pos = 0;
+
+    friend class ring_buffer;
+    template <bool>
+    friend class basic_iterator;
+
+    basic_iterator(buffer_type* buf, std::ptrdiff_t p) : buffer(buf), pos(p) {}
+
+  public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = std::conditional_t<Const, const T*, T*>;
+    using reference = std::conditional_t<Const, const T&, T&>;
+
+    basic_iterator() = default;
+
+    template <bool OtherConst, typename = std::enable_if_t<Const && !OtherConst>>
+    basic_iterator(const basic_iterator<OtherConst>& other) : buffer(other.buffer), pos(other.pos)
+    {
+    }
+
+    reference operator*() const { return *buffer->slot(static_cast<std::size_t>(pos)); }
+    pointer operator->() const { return buffer->slot(static_cast<std::size_t>(pos)); }
+    reference operator[](difference_type n) const { return *(*this + n); }
+
+    basic_iterator& operator++()
+    {
+      ++pos;
+      return *this;
+    }
+    basic_iterator operator++(int)
+    {
+      auto retval = *this;
+      ++pos;
+      return retval;
+    }
+    basic_iterator& operator--()
+    {
+      --pos;
+      return *this;
+    }
+    basic_iterator operator--(int)
+    {
+      auto retval = *this;
+      --pos;
+      return retval;
+    }
+    basic_iterator& operator+=(difference_type n)
+    {
+      pos += n;
+      return *this;
+    }
+    basic_iterator& operator-=(difference_type n)
+    {
+      pos -= n;
+      return *this;
+    }
+
+    friend basic_iterator operator+(basic_iterator it, difference_type n) { return it += n; }
+    friend basic_iterator operator+(difference_type n, basic_iterator it) { return it += n; }
+    friend basic_iterator operator-(basic_iterator it, difference_type n) { return it -= n; }
+    friend difference_type operator-(const basic_iterator& lhs, const basic_iterator& rhs) { return lhs.pos - rhs.pos; }
+
+    friend bool operator==(const basic_iterator& lhs, const basic_iterator& rhs) { return lhs.pos == rhs.pos; }
+    friend bool operator!=(const basic_iterator& lhs, const basic_iterator& rhs) { return lhs.pos != rhs.pos; }
+    friend bool operator<(const basic_iterator& lhs, const basic_iterator& rhs) { return lhs.pos < rhs.pos; }
+    friend bool operator>(const basic_iterator& lhs, const basic_iterator& rhs) { return lhs.pos > rhs.pos; }
+    friend bool operator<=(const basic_iterator& lhs, const basic_iterator& rhs) { return lhs.pos <= rhs.pos; }
+    friend bool operator>=(const basic_iterator& lhs, const basic_iterator& rhs) { return lhs.pos >= rhs.pos; }
+  };
+
+public:
+  using value_type = T;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+  using reference = T&;
+  using const_reference = const T&;
+  using iterator = basic_iterator<false>;
+  using const_iterator = basic_iterator<true>;
+
+  ring_buffer() = default;
+  explicit ring_buffer(std::size_t capacity) { reserve(capacity); }
+
+  ring_buffer(const ring_buffer& other)
+  {
+    reserve(other.occupancy);
+    std::copy(std::begin(other), std::end(other), std::back_inserter(*this));
+  }
+
+  ring_buffer(ring_buffer&& other) noexcept
+      : storage(std::exchange(other.storage, nullptr)), mask(std::exchange(other.mask, 0)), head(std::exchange(other.head, 0)),
+        occupancy(std::exchange(other.occupancy, 0))
+  {
+  }
+
+  ring_buffer& operator=(ring_buffer other) noexcept
+  {
+    swap(other);
+    return *this;
+  }
+
+  ~ring_buffer()
+  {
+    clear();
+    if (storage != nullptr)
+      std::allocator<T>{}.deallocate(storage, capacity());
+  }
+
+  void swap(ring_buffer& other) noexcept
+  {
+    std::swap(storage, other.storage);
+    std::swap(mask, other.mask);
+    std::swap(head, other.head);
+    std::swap(occupancy, other.occupancy);
+  }
+
+  /**
+   * Ensure that the buffer can hold the given number of elements without allocating.
+   */
+  void reserve(std::size_t new_capacity)
+  {
+    if (new_capacity > capacity())
+      reallocate(round_capacity(new_capacity));
+  }
+
+  std::size_t capacity() const { return storage == nullptr ? 0 : mask + 1; }
+  std::size_t size() const { return occupancy; }
+  bool empty() const { return occupancy == 0; }
+
+  iterator begin() { return iterator{this, 0}; }
+  iterator end() { return iterator{this, static_cast<difference_type>(occupancy)}; }
+  const_iterator begin() const { return const_iterator{this, 0}; }
+  const_iterator end() const { return const_iterator{this, static_cast<difference_type>(occupancy)}; }
+  const_iterator cbegin() const { return begin(); }
+  const_iterator cend() const { return end(); }
+
+  T& operator[](std::size_t pos) { return *slot(pos); }
+  const T& operator[](std::size_t pos) const { return *slot(pos); }
+
+  T& at(std::size_t pos)
+  {
+    if (pos >= occupancy)
+      throw std::out_of_range{"ring_buffer::at"};
+    return *slot(pos);
+  }
+  const T& at(std::size_t pos) const { return const_cast<ring_buffer*>(this)->at(pos); }
+
+  T& front()
+  {
+    assert(!empty());
+    return *slot(0);
+  }
+  const T& front() const
+  {
+    assert(!empty());
+    return *slot(0);
+  }
+  T& back()
+  {
+    assert(!empty());
+    return *slot(occupancy - 1);
+  }
+  const T& back() const
+  {
+    assert(!empty());
+    return *slot(occupancy - 1);
+  }
+
+  template <typename... Args>
+  T& emplace_back(Args&&... args)
+  {
+    if (occupancy == capacity())
+      reallocate(std::max<std::size_t>(2 * capacity(), 4), std::forward<Args>(args)...);
+    else
+      ::new (static_cast<void*>(slot(occupancy++))) T(std::forward<Args>(args)...);
+    return back();
+  }
+
+  void push_back(const T& value) { emplace_back(value); }
+  void push_back(T&& value) { emplace_back(std::move(value)); }
+
+  void pop_front()
+  {
+    assert(!empty());
+    std::destroy_at(slot(0));
+    head = (head + 1) & mask;
+    --occupancy;
+  }
+
+  void pop_back()
+  {
+    assert(!empty());
+    std::destroy_at(slot(--occupancy));
+  }
+
+  void clear()
+  {
+    for (std::size_t i = 0; i < occupancy; ++i)
+      std::destroy_at(slot(i));
+    head = 0;
+    occupancy = 0;
+  }
+
+  iterator erase(const_iterator first, const_iterator last)
+  {
+    const auto first_pos = static_cast<std::size_t>(first.pos);
+    const auto last_pos = static_cast<std::size_t>(last.pos);
+    const auto count = last_pos - first_pos;
+    if (count == 0)
+      return iterator{this, first.pos};
+
+    if (first_pos < occupancy - last_pos) {
+      // Fewer elements ahead of the range: shift them back over it and retire the front
+      std::move_backward(begin(), std::next(begin(), first.pos), std::next(begin(), last.pos));
+      for (std::size_t i = 0; i < count; ++i)
+        std::destroy_at(slot(i));
+      head = (head + count) & mask;
+    } else {
+      std::move(std::next(begin(), last.pos), end(), std::next(begin(), first.pos));
+      for (std::size_t i = occupancy - count; i < occupancy; ++i)
+        std::destroy_at(slot(i));
+    }
+    occupancy -= count;
+    return iterator{this, first.pos};
+  }
+
+  iterator erase(const_iterator pos) { return erase(pos, std::next(pos)); }
+
+  template <typename InputIt>
+  iterator insert(const_iterator pos, InputIt first, InputIt last)
+  {
+    const auto old_size = static_cast<difference_type>(occupancy);
+    std::copy(first, last, std::back_inserter(*this));
+    std::rotate(std::next(begin(), pos.pos), std::next(begin(), old_size), end());
+    return iterator{this, pos.pos};
+  }
+};
+} // namespace champsim
+
+#endif
@@ -0,0 +1,61 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef UTIL_SIMD_H
+#define UTIL_SIMD_H
+
+#include <algorithm>
+#include <cstdint>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace champsim
+{
+/**
+ * Find the first element of [begin, end) that is equal to value, as std::find() would.
+ * Where the host supports it, several elements are compared per instruction. The tail, or the whole range on other hosts, is searched one element at a time.
+ */
+inline const uint64_t* find_tag(const uint64_t* begin, const uint64_t* end, uint64_t value)
+{
+  auto it = begin;
+#if defined(__AVX2__)
+  const auto needle = _mm256_set1_epi64x(static_cast<long long>(value));
+  for (; end - it >= 4; it += 4) {
+    auto eq = _mm256_cmpeq_epi64(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(it)), needle);
+    auto mask = static_cast<unsigned>(_mm256_movemask_pd(_mm256_castsi256_pd(eq)));
+    if (mask != 0)
+      return it + __builtin_ctz(mask);
+  }
+#elif defined(__SSE2__)
+  const auto needle = _mm_set1_epi64x(static_cast<long long>(value));
+  for (; end - it >= 2; it += 2) {
+    auto eq32 = _mm_cmpeq_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(it)), needle);
+    // A 64-bit lane is equal only if both of its 32-bit halves are
+    auto eq = _mm_and_si128(eq32, _mm_shuffle_epi32(eq32, _MM_SHUFFLE(2, 3, 0, 1)));
+    auto mask = static_cast<unsigned>(_mm_movemask_pd(_mm_castsi128_pd(eq)));
+    if (mask != 0)
+      return it + __builtin_ctz(mask);
+  }
+#endif
+  return std::find(it, end, value);
+}
+} // namespace champsim
+
+#endif
@@ -0,0 +1,101 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef UTIL_TIMING_WHEEL_H
+#define UTIL_TIMING_WHEEL_H
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace champsim
+{
+/**
+ * Holds values until the cycles on which they are due, in slots indexed by cycle, so that advancing through a cycle visits only the values due then.
+ *
+ * A value due within the horizon given at construction is visited on its cycle. One due further ahead waits in its slot through the revolutions
+ * before it. A value scheduled for a cycle that has already been advanced through is due on the next cycle advanced through.
+ */
+template <typename T>
+class timing_wheel
+{
+  struct entry {
+    uint64_t cycle;
+    T value;
+  };
+
+  std::vector<std::vector<entry>> slots;
+  std::vector<entry> visiting{};
+  uint64_t next_cycle = 0; // the earliest cycle that has not been advanced through
+  std::size_t pending = 0;
+
+  static std::size_t slots_for(std::size_t horizon)
+  {
+    std::size_t count = 1;
+    while (count <= horizon)
+      count <<= 1;
+    return count;
+  }
+
+  std::vector<entry>& slot_of(uint64_t cycle) { return slots[cycle & (std::size(slots) - 1)]; }
+
+public:
+  explicit timing_wheel(std::size_t horizon) : slots(slots_for(horizon)) {}
+
+  void schedule(uint64_t cycle, T value)
+  {
+    cycle = std::max(cycle, next_cycle);
+    slot_of(cycle).push_back({cycle, std::move(value)});
+    ++pending;
+  }
+
+  // Visit the values due on or before the cycle, in the order of the cycles they were due, then remove them
+  template <typename F>
+  void advance(uint64_t cycle, F&& func)
+  {
+    if (cycle < next_cycle)
+      return;
+
+    const auto first = next_cycle;
+    const auto count = std::min<uint64_t>(cycle - first + 1, std::size(slots));
+    next_cycle = cycle + 1;
+
+    for (uint64_t i = 0; i < count && pending > 0; ++i) {
+      auto& slot = slot_of(first + i);
+      if (std::empty(slot))
+        continue;
+
+      // The values that are not yet due stay, and the visited values may schedule others
+      std::swap(visiting, slot);
+      for (auto& item : visiting) {
+        if (item.cycle <= cycle) {
+          --pending;
+          func(item.value);
+        } else {
+          slot_of(item.cycle).push_back(std::move(item));
+        }
+      }
+      visiting.clear();
+    }
+  }
+
+  bool empty() const { return pending == 0; }
+  std::size_t size() const { return pending; }
+};
+} // namespace champsim
+
+#endif
@@ -0,0 +1,74 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef WAY_PARTITIONER_H
+#define WAY_PARTITIONER_H
+
+#include <cstdint>
+#include <vector>
+
+namespace champsim
+{
+/**
+ * Divides the ways of a shared cache among the cores by the utility of each additional way to each core (utility-based cache partitioning).
+ *
+ * Each core has a utility monitor: a set of shadow tags with the full associativity of the cache, kept for a sample of the sets, that counts
+ * how many of the core's accesses would have hit at each position of an LRU stack. repartition() gives the ways to the cores with the lookahead
+ * algorithm, which repeatedly grants the core that gains the most hits per way over any number of the remaining ways.
+ *
+ * The partitioner also keeps the core that filled each block, and when each block was last used, so that the cache can constrain its victims to
+ * the allocations, whatever its replacement policy.
+ */
+class way_partitioner
+{
+  std::size_t NUM_CPUS, NUM_SET, NUM_WAY, SAMPLE_STRIDE;
+
+  // The shadow tags of each core, in LRU order within each sampled set, and the hits counted at each LRU position
+  std::vector<std::vector<uint64_t>> shadow_tags;
+  std::vector<std::vector<uint64_t>> way_hits;
+
+  std::vector<uint32_t> allocation;
+
+  std::vector<uint32_t> block_owner;
+  std::vector<uint64_t> block_last_use;
+
+  uint64_t utility(std::size_t cpu, std::size_t ways) const;
+
+public:
+  way_partitioner(std::size_t cpus, std::size_t sets, std::size_t ways);
+
+  // Whether the set is monitored by the shadow tags
+  bool sampled(std::size_t set) const;
+
+  // Record an access by the core to the block in the set, if the set is sampled
+  void monitor(uint32_t cpu, std::size_t set, uint64_t block);
+
+  // Record that a block was filled by the core, or used by any core, at the given cycle. The index is that of the block in CACHE::block.
+  void fill(std::size_t index, uint32_t cpu, uint64_t cycle);
+  void touch(std::size_t index, uint64_t cycle);
+
+  uint32_t owner(std::size_t index) const;
+  uint64_t last_use(std::size_t index) const;
+
+  // Divide the ways by the hits that the monitors counted, then halve the counts so that the next division favors recent behavior
+  void repartition();
+
+  const std::vector<uint32_t>& allocations() const;
+  const std::vector<uint64_t>& hits(uint32_t cpu) const;
+};
+} // namespace champsim
+
+#endif
@@ -2,6 +2,8 @@
 
 #include <cassert>
 #include <iostream>
+#include <limits>
+#include <optional>
 
 #include "cache.h"
 
@@ -68,6 +70,14 @@ uint32_t CACHE::prefetcher_cache_operate(uint64_t addr, uint64_t ip, uint8_t cac
     ::PT.update_pattern(last_sig, delta);
 
   // Stage 3: Start prefetching
+  // The occupancy that a replacement policy publishes for this cache, or else for the cache below it, bounds the lookahead depth
+  uint32_t max_depth = std::numeric_limits<uint32_t>::max();
+  std::optional<double> occupancy = hints.occupancy();
+  if (!occupancy.has_value() && lower_hints() != nullptr)
+    occupancy = lower_hints()->occupancy();
+  if (occupancy.has_value())
+    max_depth = falcon::GetInitialDepth(static_cast<uint32_t>(100 * occupancy.value()));
+
   uint64_t base_addr = addr;
   uint32_t lookahead_conf = 100, pf_q_head = 0, pf_q_tail = 0;
   uint8_t do_lookahead = 0;
@@ -82,17 +92,10 @@ uint32_t CACHE::prefetcher_cache_operate(uint64_t addr, uint64_t ip, uint8_t cac
         uint64_t pf_addr = (base_addr & ~(BLOCK_SIZE - 1)) + (delta_q[i] << LOG2_BLOCK_SIZE);
 
         if ((addr & ~(PAGE_SIZE - 1)) == (pf_addr & ~(PAGE_SIZE - 1))) { // Prefetch request is in the same physical page
-          if (::FILTER.check(pf_addr, ((confidence_q[i] >= falcon::fill_threshold) ? falcon::FALCON_L2C_PREFETCH : falcon::FALCON_LLC_PREFETCH))) {
-            // NOTE: add Feedback Logic
-            Feedback feedback = falcon::GetGliderFeedback();
-            uint32_t depth = falcon::AdjustDepth(feedback, i);
-            uint32_t cache_utilization = falcon::GetCacheUtilization(feedback);
-            uint32_t initial_depth = falcon::GetInitialDepth(feedback);
-            uint32_t candidate = 0;
-            if constexpr (falcon::FALCON_DEBUG_PRINT) {
-              std::cout << "Prefetcher cycle operate: depth=" << depth << ", cacheUtilization=" << cache_utilization << std::endl;
-            }
-            prefetch_line(pf_addr, (confidence_q[i] >= falcon::FILL_THRESHOLD), 0); // Use addr (not base_addr) to obey the same physical page boundary
+          if (::FILTER.check(pf_addr, ((confidence_q[i] >= falcon::FILL_THRESHOLD) ? falcon::FALCON_L2C_PREFETCH : falcon::FALCON_LLC_PREFETCH))) {
+            // Use addr (not base_addr) to obey the same physical page boundary
+            // The confidence lets the replacement policy of the level this fills insert a doubtful prefetch with low priority
+            prefetch_line(pf_addr, (confidence_q[i] >= falcon::FILL_THRESHOLD), 0, confidence_q[i] / 100.0);
 
             if (confidence_q[i] >= falcon::FILL_THRESHOLD) {
               ::GHR.pf_issued++;
@@ -144,7 +147,7 @@ uint32_t CACHE::prefetcher_cache_operate(uint64_t addr, uint64_t ip, uint8_t cac
       std::cout << "Looping curr_sig: " << std::hex << curr_sig << " base_addr: " << base_addr << std::dec;
       std::cout << " pf_q_head: " << pf_q_head << " pf_q_tail: " << pf_q_tail << " depth: " << depth << std::endl;
     }
-  } while (falcon::LOOKAHEAD_ON && do_lookahead);
+  } while (falcon::LOOKAHEAD_ON && do_lookahead && depth < max_depth);
 
   return metadata_in;
 }
@@ -4,9 +4,6 @@
 #include <cstdint>
 #include <vector>
 
-#include "../../replacement/glider/glider.cc"
-#include "glider_predictor.h"
-
 namespace falcon
 {
 // FALCON functional knobs
@@ -47,8 +44,6 @@ constexpr unsigned GLOBAL_COUNTER_BIT = 10;
 constexpr uint32_t GLOBAL_COUNTER_MAX = ((1 << GLOBAL_COUNTER_BIT) - 1);
 constexpr std::size_t MAX_GHR_ENTRY = 8;
 
-constexpr Prediction HIGH_CONFIDENCE_THRESHOLD = Prediction::Medium;
-
 enum FILTER_REQUEST { FALCON_L2C_PREFETCH, FALCON_LLC_PREFETCH, L2C_DEMAND, L2C_EVICT }; // Request type for prefetch filter
 uint64_t get_hash(uint64_t key);
 
@@ -144,63 +139,27 @@ public:
   uint32_t check_entry(uint32_t page_offset);
 };
 
-uint32_t pf_depth;
-
-#define MAX_PF_DEPTH 3
-#define MIN_PF_DEPTH 1
-
-uint32_t GetCP(const Feedback& feedback)
-{
-  uint32_t pressure = static_cast<uint32_t>(0.4 * feedback.miss_rate + 0.4 * feedback.replace_rate + 0.2 * (100 - feedback.utilization));
-  return pressure;
-}
-
-static uint32_t AdjustDepth(const Feedback& feedback, uint32_t pf_depth)
-{
-  // Define the thresholds for good and poor performance
-  const uint32_t GOOD_MISS_RATE = 10; // Example threshold
-  const uint32_t POOR_HIT_RATE = 50;  // Example threshold
-
-  if (feedback.miss_rate < GOOD_MISS_RATE) {
-    // Increase prefetch depth if the miss rate is good (low).
-    pf_depth = std::min((int)pf_depth + 1, MAX_PF_DEPTH);
-  } else if (feedback.hit_rate > POOR_HIT_RATE) {
-    // Decrease prefetch depth if the hit rate is poor (high).
-    pf_depth = std::max((int)pf_depth - 1, MIN_PF_DEPTH);
-  }
-  // No change to prefetch depth if feedback is neutral.
-  return pf_depth;
-}
+// Utilization thresholds of the cache that the prefetches fill, in percent of its blocks that its replacement policy expects to be reused
+constexpr uint32_t HIGH_UTILIZATION_THRESHOLD = 80;
+constexpr uint32_t LOW_UTILIZATION_THRESHOLD = 20;
 
-uint32_t GetCacheUtilization(Feedback it) { return it.utilization; }
+// Lookahead depths for different utilizations
+constexpr uint32_t AGGRESSIVE_PREFETCH_DEPTH = 5;
+constexpr uint32_t CONSERVATIVE_PREFETCH_DEPTH = 2;
+constexpr uint32_t DEFAULT_PREFETCH_DEPTH = 3;
 
-static uint32_t GetInitialDepth(Feedback feedback)
+constexpr uint32_t GetInitialDepth(uint32_t utilization)
 {
-  uint32_t cacheUtilization = GetCacheUtilization(feedback);
-
-  // Define thresholds for cache utilization
-  const uint32_t HIGH_UTILIZATION_THRESHOLD = 80; // Example value, represents 80% utilization
-  const uint32_t LOW_UTILIZATION_THRESHOLD = 20;  // Example value, represents 20% utilization
-
-  // Define initial prefetch depths for different scenarios
-  const uint32_t AGGRESSIVE_PREFETCH_DEPTH = 5;   // Example value for high prefetch depth
-  const uint32_t CONSERVATIVE_PREFETCH_DEPTH = 2; // Example value for low prefetch depth
-  const uint32_t DEFAULT_PREFETCH_DEPTH = 3;      // Default prefetch depth if conditions are neutral
-
-  // Set initial prefetch depth based on cache utilization
-  if (cacheUtilization > HIGH_UTILIZATION_THRESHOLD) {
+  if (utilization > HIGH_UTILIZATION_THRESHOLD) {
     // If cache is highly utilized, be conservative with prefetching
     return CONSERVATIVE_PREFETCH_DEPTH;
-  } else if (cacheUtilization < LOW_UTILIZATION_THRESHOLD) {
+  } else if (utilization < LOW_UTILIZATION_THRESHOLD) {
     // If cache is underutilized, be more aggressive with prefetching
     return AGGRESSIVE_PREFETCH_DEPTH;
-  } else {
-    // For neutral cache utilization, use default prefetch depth
-    return DEFAULT_PREFETCH_DEPTH;
   }
+  // For neutral cache utilization, use default prefetch depth
+  return DEFAULT_PREFETCH_DEPTH;
 }
-
-Feedback GetGliderFeedback() { return predictor_demand->get_feedback(); }
 } // namespace falcon
 
 #endif
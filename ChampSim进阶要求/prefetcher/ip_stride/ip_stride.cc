@@ -30,6 +30,13 @@ struct tracker {
 
   std::optional<lookahead_entry> active_lookahead;
 
+  // A prefetch that waits to be arbitrated against those of other prefetchers, and the lookahead from before it was requested
+  struct queued_entry {
+    uint64_t address = 0;
+    lookahead_entry lookahead;
+  };
+  std::optional<queued_entry> queued_prefetch;
+
   champsim::msl::lru_table<tracker_entry> table{TRACKER_SETS, TRACKER_WAYS};
 
 public:
@@ -47,8 +54,10 @@ public:
 
       // Initialize prefetch state unless we somehow saw the same address twice in
       // a row or if this is the first time we've seen this stride
-      if (stride != 0 && stride == found->last_stride)
+      if (stride != 0 && stride == found->last_stride) {
         active_lookahead = {cl_addr << LOG2_BLOCK_SIZE, stride, PREFETCH_DEGREE};
+        queued_prefetch.reset();
+      }
     }
 
     // update tracking set
@@ -57,6 +66,12 @@ public:
 
   void advance_lookahead(CACHE* cache)
   {
+    // If the last prefetch was queued and then dropped, step the lookahead back to request it again
+    auto dropped = cache->take_dropped_prefetches();
+    if (queued_prefetch.has_value() && std::find(std::begin(dropped), std::end(dropped), queued_prefetch->address) != std::end(dropped))
+      active_lookahead = queued_prefetch->lookahead;
+    queued_prefetch.reset();
+
     // If a lookahead is active
     if (active_lookahead.has_value()) {
       auto [old_pf_address, stride, degree] = active_lookahead.value();
@@ -68,8 +83,11 @@ public:
       // If the next step would exceed the degree or run off the page, stop
       if (cache->virtual_prefetch || (pf_address >> LOG2_PAGE_SIZE) == (old_pf_address >> LOG2_PAGE_SIZE)) {
         // check the MSHR occupancy to decide if we're going to prefetch to this level or not
-        bool success = cache->prefetch_line(pf_address, (cache->get_mshr_occupancy_ratio() < 0.5), 0);
-        if (success)
+        // the further ahead of the demand stream, the less confident the prefetch
+        auto status = cache->prefetch_line(pf_address, (cache->get_mshr_occupancy_ratio() < 0.5), 0, static_cast<double>(degree) / PREFETCH_DEGREE);
+        if (status == champsim::prefetch_queued)
+          queued_prefetch = {pf_address, active_lookahead.value()};
+        if (status != champsim::prefetch_refused)
           active_lookahead = {pf_address, stride, degree - 1};
         // If we fail, try again next cycle
 
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <bitset>
 #include <map>
 #include <vector>
@@ -67,9 +68,12 @@ uint32_t CACHE::prefetcher_cache_operate(uint64_t addr, uint64_t ip, uint8_t cac
   // mark this demand access
   demand_region->access_map.set(page_offset);
 
+  // the degree follows the cache's throttle, and is PREFETCH_DEGREE at its middle level
+  const int degree = std::max<int>(1, PREFETCH_DEGREE * static_cast<int>(prefetch_throttle_level()) / static_cast<int>(champsim::prefetch_throttle::middle_level));
+
   // attempt to prefetch in the positive, then negative direction
   for (auto direction : {1, -1}) {
-    for (int i = 1, prefetches_issued = 0; i <= MAX_DISTANCE && prefetches_issued < PREFETCH_DEGREE; i++) {
+    for (int i = 1, prefetches_issued = 0; i <= MAX_DISTANCE && prefetches_issued < degree; i++) {
       const auto pos_step_addr = addr + direction * (i * (signed)BLOCK_SIZE);
       const auto neg_step_addr = addr - direction * (i * (signed)BLOCK_SIZE);
       const auto neg_2step_addr = addr - direction * (2 * i * (signed)BLOCK_SIZE);
@@ -43,6 +43,10 @@ uint64_t sample_signature[LLC_SETS][LLC_WAYS];
 // 每个采样器集合的时间戳计数器，用于OPTgen算法中跟踪cache行的年龄
 uint64_t set_timer[LLC_SETS];
 
+// 每个集合中Glider预测会被重用（RRIP值小于MAXRRIP）的路数及其总数，用于向预取器发布cache占用率
+uint32_t friendly_ways[LLC_SETS];
+uint64_t friendly_total = 0;
+
 // 数学函数用于计算采样集合
 #define bitmask(l) (((l) == 64) ? (unsigned long long)(-1LL) : ((1LL << (l)) - 1LL))
 // 从x中提取从i开始的l长度的位
@@ -145,6 +149,25 @@ void update_cache_history(unsigned int sample_set, unsigned int currentVal)
   }
 }
 
+/**
+ * 重新统计集合中预测会被重用的路数，并通过cache的旁路通道发布占用率。
+ *
+ * @param hints 发布预测的cache旁路通道。
+ * @param set cache集合的索引。
+ */
+void publish_occupancy(champsim::cache_hints& hints, uint32_t set)
+{
+  uint32_t count = 0;
+  for (uint32_t i = 0; i < LLC_WAYS; i++) {
+    if (rrip[set][i] < MAXRRIP) {
+      count++;
+    }
+  }
+  friendly_total = friendly_total + count - friendly_ways[set];
+  friendly_ways[set] = count;
+  hints.publish_occupancy(static_cast<double>(friendly_total) / (LLC_SETS * LLC_WAYS));
+}
+
 /**
  * 更新给定组和路的cache替换状态。
  *
@@ -240,6 +263,18 @@ void CACHE::update_replacement_state(uint32_t triggering_cpu, uint32_t set, uint
   // 从Glider预测器获取对此行的预测结果
   Prediction prediction = predictor_demand->get_prediction(ip);
 
+  // 通过cache的旁路通道向预取器发布预测结果。预取请求不带指令地址，所以只有需求访问预测其所在区域
+  if (access_type{type} != access_type::PREFETCH) {
+    champsim::reuse_prediction reuse = champsim::reuse_prediction::near;
+    if (prediction == Prediction::Low) {
+      reuse = champsim::reuse_prediction::dead;
+    } else if (prediction == Prediction::Medium) {
+      reuse = champsim::reuse_prediction::distant;
+    }
+    hints.predict_ip(ip, reuse);
+    hints.predict_region(full_addr, reuse);
+  }
+
   // 记录此cache行的最后一个IP值
   sample_signature[set][way] = ip;
   // 如果Glider决定以低优先级插入，则将其RRIP值设为MAXRRIP
@@ -273,6 +308,13 @@ void CACHE::update_replacement_state(uint32_t triggering_cpu, uint32_t set, uint
     // 将当前行的RRIP值设为0，表示最近使用过
     rrip[set][way] = 0;
   }
+
+  // 预取器置信度低的预取行以低优先级插入
+  if (!hit && access_type{type} == access_type::PREFETCH && hints.low_confidence_prefetch(full_addr)) {
+    rrip[set][way] = MAXRRIP;
+  }
+
+  publish_occupancy(hints, set);
 }
 
 void CACHE::replacement_final_stats() {}
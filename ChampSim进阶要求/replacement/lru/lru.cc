@@ -14,6 +14,17 @@ void CACHE::initialize_replacement() { ::last_used_cycles[this] = std::vector<ui
 
 uint32_t CACHE::find_victim(uint32_t triggering_cpu, uint64_t instr_id, uint32_t set, const BLOCK* current_set, uint64_t ip, uint64_t full_addr, uint32_t type)
 {
+  if (SET_INDEX_FUNCTION == champsim::set_index_function::skewed) {
+    // Each candidate lies in a different set
+    auto last_used = [this, full_addr, &cycles = ::last_used_cycles[this]](uint32_t way) { return cycles.at(get_set_index(full_addr, way) * NUM_WAY + way); };
+    uint32_t victim = 0;
+    for (uint32_t way = 1; way < NUM_WAY; ++way) {
+      if (last_used(way) < last_used(victim))
+        victim = way;
+    }
+    return victim;
+  }
+
   auto begin = std::next(std::begin(::last_used_cycles[this]), set * NUM_WAY);
   auto end = std::next(begin, NUM_WAY);
 
@@ -0,0 +1,174 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "access_replay.h"
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+#include <stdexcept>
+#include <unordered_map>
+
+#include "util/bits.h"
+
+namespace
+{
+std::size_t set_index(uint64_t address, uint32_t sets, unsigned offset_bits) { return (address >> offset_bits) & champsim::bitmask(champsim::lg2(sets)); }
+
+void count(cache_stats& stats, const champsim::access_trace_record& rec, bool hit)
+{
+  if (rec.is_warmup())
+    return;
+
+  assert(rec.cpu < NUM_CPUS);
+  if (hit)
+    ++stats.hits.at(rec.type).at(rec.cpu);
+  else
+    ++stats.misses.at(rec.type).at(rec.cpu);
+}
+} // namespace
+
+cache_stats champsim::replay_access_trace(CACHE& cache, const std::vector<access_trace_record>& records, replay_fill_policy policy)
+{
+  if (cache.SET_INDEX_FUNCTION == set_index_function::skewed)
+    throw std::invalid_argument{"Access traces cannot be replayed into the skewed cache " + cache.NAME};
+  if (cache.SECTOR_SIZE != 1)
+    throw std::invalid_argument{"Access traces cannot be replayed into the sectored cache " + cache.NAME};
+
+  cache_stats stats;
+  stats.name = cache.NAME;
+
+  for (std::size_t i = 0; i < std::size(cache.block); ++i)
+    cache.write_block(i, {});
+  cache.impl_initialize_replacement();
+
+  for (const auto& rec : records) {
+    cache.current_cycle = rec.cycle;
+    cache.warmup = rec.is_warmup();
+    cache.cpu = rec.cpu;
+
+    const auto set = static_cast<uint32_t>(cache.get_set_index(rec.address));
+    auto set_begin = std::next(std::begin(cache.block), static_cast<long>(set * cache.NUM_WAY));
+    auto set_end = std::next(set_begin, cache.NUM_WAY);
+    auto way = std::find_if(set_begin, set_end, [match = rec.address >> cache.OFFSET_BITS, shamt = cache.OFFSET_BITS](const auto& entry) {
+      return entry.valid && (entry.address >> shamt) == match;
+    });
+
+    if (!rec.is_fill()) {
+      const bool hit = (way != set_end);
+      count(stats, rec, hit);
+
+      if (hit) {
+        cache.impl_update_replacement_state(rec.cpu, set, static_cast<uint32_t>(std::distance(set_begin, way)), way->address, rec.ip, 0, rec.type, true);
+        way->dirty |= (rec.type == champsim::to_underlying(access_type::WRITE));
+      }
+
+      if (hit || policy != replay_fill_policy::fill_on_miss)
+        continue;
+    } else if (way != set_end || policy != replay_fill_policy::recorded_fills) {
+      continue;
+    }
+
+    // Fill the block, following the same sequence as CACHE::handle_fill()
+    way = std::find_if_not(set_begin, set_end, [](const auto& x) { return x.valid; });
+    if (way == set_end)
+      way = std::next(set_begin, cache.impl_find_victim(rec.cpu, 0, set, &*set_begin, rec.ip, rec.address, rec.type));
+    assert(set_begin <= way);
+    assert(way <= set_end);
+    const auto way_idx = static_cast<uint32_t>(std::distance(set_begin, way)); // cast protected by earlier assertion
+
+    if (way != set_end) {
+      auto evicting_address = way->address & ~champsim::bitmask(cache.OFFSET_BITS);
+
+      auto filled = *way;
+      filled.valid = true;
+      filled.prefetch = (rec.type == champsim::to_underlying(access_type::PREFETCH));
+      filled.dirty = (rec.type == champsim::to_underlying(access_type::WRITE));
+      filled.address = rec.address;
+      filled.v_address = rec.address;
+      filled.data = 0;
+      filled.pf_metadata = 0;
+      cache.write_block(static_cast<std::size_t>(std::distance(std::begin(cache.block), way)), filled);
+
+      cache.impl_update_replacement_state(rec.cpu, set, way_idx, rec.address, rec.ip, evicting_address, rec.type, false);
+    } else {
+      // Bypass
+      cache.impl_update_replacement_state(rec.cpu, set, way_idx, rec.address, rec.ip, 0, rec.type, false);
+    }
+  }
+
+  return stats;
+}
+
+cache_stats champsim::replay_optimal(uint32_t sets, uint32_t ways, unsigned offset_bits, const std::vector<access_trace_record>& records,
+                                     replay_fill_policy policy)
+{
+  constexpr auto never = std::numeric_limits<std::size_t>::max();
+
+  // For each record, find the position of the next lookup of the same block
+  std::vector<std::size_t> next_use(std::size(records));
+  std::unordered_map<uint64_t, std::size_t> upcoming;
+  for (auto i = std::size(records); i-- > 0;) {
+    auto [it, inserted] = upcoming.try_emplace(records[i].address >> offset_bits, never);
+    next_use[i] = it->second;
+    if (!records[i].is_fill())
+      it->second = i;
+  }
+
+  struct opt_block {
+    bool valid = false;
+    uint64_t block_addr = 0;
+    std::size_t next_use = 0;
+  };
+  std::vector<opt_block> blocks(std::size_t{sets} * ways);
+
+  cache_stats stats;
+  stats.name = "OPT";
+
+  for (std::size_t i = 0; i < std::size(records); ++i) {
+    const auto& rec = records[i];
+    const auto block_addr = rec.address >> offset_bits;
+
+    auto set_begin = std::next(std::begin(blocks), static_cast<long>(set_index(rec.address, sets, offset_bits) * ways));
+    auto set_end = std::next(set_begin, ways);
+    auto way = std::find_if(set_begin, set_end, [block_addr](const auto& entry) { return entry.valid && entry.block_addr == block_addr; });
+
+    if (!rec.is_fill()) {
+      const bool hit = (way != set_end);
+      count(stats, rec, hit);
+
+      if (hit)
+        way->next_use = next_use[i];
+
+      if (hit || policy != replay_fill_policy::fill_on_miss)
+        continue;
+    } else if (way != set_end || policy != replay_fill_policy::recorded_fills) {
+      continue;
+    }
+
+    // Evict the block that is used furthest in the future, or bypass if that is the incoming block
+    way = std::find_if_not(set_begin, set_end, [](const auto& x) { return x.valid; });
+    if (way == set_end) {
+      way = std::max_element(set_begin, set_end, [](const auto& x, const auto& y) { return x.next_use < y.next_use; });
+      if (way->next_use <= next_use[i])
+        continue;
+    }
+
+    *way = opt_block{true, block_addr, next_use[i]};
+  }
+
+  return stats;
+}
@@ -0,0 +1,67 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "access_trace.h"
+
+#include <stdexcept>
+#include <type_traits>
+
+static_assert(std::is_trivially_copyable_v<champsim::access_trace_record>);
+static_assert(std::is_trivially_copyable_v<champsim::access_trace_header>);
+static_assert(sizeof(champsim::access_trace_record) == 32);
+
+champsim::access_trace_writer::access_trace_writer(std::string filename, access_trace_header header) : file(filename, std::ios::binary)
+{
+  if (!file)
+    throw std::runtime_error{"Could not open access trace " + filename};
+  buffer.reserve(buffer_size);
+  file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+}
+
+champsim::access_trace_writer::~access_trace_writer() { flush(); }
+
+void champsim::access_trace_writer::record(access_trace_record rec)
+{
+  buffer.push_back(rec);
+  if (std::size(buffer) >= buffer_size)
+    flush();
+}
+
+void champsim::access_trace_writer::flush()
+{
+  file.write(reinterpret_cast<const char*>(std::data(buffer)), static_cast<std::streamsize>(std::size(buffer) * sizeof(access_trace_record)));
+  file.flush();
+  buffer.clear();
+}
+
+auto champsim::read_access_trace(std::string filename) -> access_trace
+{
+  std::ifstream file{filename, std::ios::binary | std::ios::ate};
+  if (!file)
+    throw std::runtime_error{"Could not open access trace " + filename};
+
+  auto file_size = static_cast<std::size_t>(file.tellg());
+  file.seekg(0);
+
+  access_trace retval{};
+  file.read(reinterpret_cast<char*>(&retval.header), sizeof(retval.header));
+  if (!file || retval.header.magic != access_trace_header::expected_magic)
+    throw std::runtime_error{filename + " is not an access trace"};
+
+  retval.records.resize((file_size - sizeof(access_trace_header)) / sizeof(access_trace_record));
+  file.read(reinterpret_cast<char*>(std::data(retval.records)), static_cast<std::streamsize>(std::size(retval.records) * sizeof(access_trace_record)));
+  return retval;
+}
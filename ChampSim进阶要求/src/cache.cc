@@ -21,43 +21,44 @@
 #include <cmath>
 #include <iomanip>
 #include <numeric>
+#include <tuple>
+#include <utility>
 #include <fmt/core.h>
 #include <fmt/ranges.h>
 
 #include "champsim.h"
 #include "champsim_constants.h"
 #include "deadlock.h"
+#include "dram_controller.h"
 #include "instruction.h"
 #include "util/algorithm.h"
+#include "util/simd.h"
 #include "util/span.h"
 #include <fmt/core.h>
 
 CACHE::tag_lookup_type::tag_lookup_type(request_type req, bool local_pref, bool skip)
     : address(req.address), v_address(req.v_address), data(req.data), ip(req.ip), instr_id(req.instr_id), pf_metadata(req.pf_metadata), cpu(req.cpu),
-      type(req.type), prefetch_from_this(local_pref), skip_fill(skip), is_translated(req.is_translated), instr_depend_on_me(req.instr_depend_on_me)
+      type(req.type), prefetch_from_this(local_pref), skip_fill(skip), clean_victim(req.clean_victim), is_translated(req.is_translated), instr_depend_on_me(req.instr_depend_on_me)
 {
 }
 
 CACHE::mshr_type::mshr_type(tag_lookup_type req, uint64_t cycle)
     : address(req.address), v_address(req.v_address), data(req.data), ip(req.ip), instr_id(req.instr_id), pf_metadata(req.pf_metadata), cpu(req.cpu),
-      type(req.type), prefetch_from_this(req.prefetch_from_this), cycle_enqueued(cycle), instr_depend_on_me(req.instr_depend_on_me), to_return(req.to_return)
+      type(req.type), prefetch_from_this(req.prefetch_from_this), clean_victim(req.clean_victim), pf_source(req.pf_source), cycle_enqueued(cycle), instr_depend_on_me(req.instr_depend_on_me), to_return(req.to_return)
 {
 }
 
 CACHE::mshr_type CACHE::mshr_type::merge(mshr_type predecessor, mshr_type successor)
 {
-  std::vector<std::reference_wrapper<ooo_model_instr>> merged_instr{};
-  std::vector<std::deque<response_type>*> merged_return{};
-
-  std::set_union(std::begin(predecessor.instr_depend_on_me), std::end(predecessor.instr_depend_on_me), std::begin(successor.instr_depend_on_me),
-                 std::end(successor.instr_depend_on_me), std::back_inserter(merged_instr), ooo_model_instr::program_order);
-  std::set_union(std::begin(predecessor.to_return), std::end(predecessor.to_return), std::begin(successor.to_return), std::end(successor.to_return),
-                 std::back_inserter(merged_return));
+  auto merged_instr = champsim::merge_sorted(predecessor.instr_depend_on_me, successor.instr_depend_on_me, ooo_model_instr::program_order);
+  auto merged_return = champsim::merge_sorted(predecessor.to_return, successor.to_return);
 
   mshr_type retval{(successor.type == access_type::PREFETCH) ? predecessor : successor};
-  retval.instr_depend_on_me = merged_instr;
-  retval.to_return = merged_return;
+  retval.instr_depend_on_me = std::move(merged_instr);
+  retval.to_return = std::move(merged_return);
   retval.data = predecessor.data;
+  retval.prefetch_partition = predecessor.prefetch_partition;
+  retval.demand_merge_cycle = predecessor.demand_merge_cycle;
 
   if (predecessor.event_cycle < std::numeric_limits<uint64_t>::max()) {
     retval.event_cycle = predecessor.event_cycle;
@@ -74,71 +75,137 @@ CACHE::mshr_type CACHE::mshr_type::merge(mshr_type predecessor, mshr_type succes
   return retval;
 }
 
-CACHE::BLOCK::BLOCK(mshr_type mshr)
-    : valid(true), prefetch(mshr.prefetch_from_this), dirty(mshr.type == access_type::WRITE), address(mshr.address), v_address(mshr.v_address), data(mshr.data)
+CACHE::BLOCK::BLOCK(mshr_type mshr, uint64_t subblock)
+    : valid(true), prefetch(mshr.prefetch_from_this), dirty(mshr.type == access_type::WRITE && !mshr.clean_victim), address(mshr.address), v_address(mshr.v_address), data(mshr.data),
+      fill_cycle(mshr.event_cycle), pf_source(mshr.pf_source),
+      valid_blocks(subblock), dirty_blocks(dirty ? subblock : 0), prefetch_blocks(prefetch ? subblock : 0)
 {
 }
 
-bool CACHE::handle_fill(const mshr_type& fill_mshr)
+template <typename G, typename M>
+bool CACHE::handle_fill(const G& geom, M& modules, const mshr_type& fill_mshr)
 {
   cpu = fill_mshr.cpu;
 
+  // An exclusive cache passes the blocks that its upper levels requested through without keeping them
+  const bool pass_through = (INCLUSION == champsim::inclusion_policy::exclusive && fill_mshr.type != access_type::WRITE && !std::empty(fill_mshr.to_return));
+
+  // In a sectored cache, a block whose sector is present fills into it
+  std::size_t way_idx = geom.ways();
+  if (SECTOR_SIZE > 1 && !pass_through) {
+    way_idx = find_way(geom, fill_mshr.address);
+    if (way_idx < geom.ways() && !block_valid[get_set_index(geom, fill_mshr.address, way_idx) * geom.ways() + way_idx])
+      way_idx = geom.ways();
+  }
+  const bool sector_present = (way_idx < geom.ways());
+
   // find victim
-  auto [set_begin, set_end] = get_set_span(fill_mshr.address);
-  auto way = std::find_if_not(set_begin, set_end, [](auto x) { return x.valid; });
-  if (way == set_end)
-    way = std::next(set_begin, impl_find_victim(fill_mshr.cpu, fill_mshr.instr_id, get_set_index(fill_mshr.address), &*set_begin, fill_mshr.ip,
-                                                fill_mshr.address, champsim::to_underlying(fill_mshr.type)));
-  assert(set_begin <= way);
-  assert(way <= set_end);
-  const auto way_idx = static_cast<std::size_t>(std::distance(set_begin, way)); // cast protected by earlier assertion
+  if (!sector_present && !pass_through)
+    way_idx = choose_victim(geom, modules, fill_mshr.cpu, fill_mshr.instr_id, fill_mshr.ip, fill_mshr.address, fill_mshr.type);
+  assert(way_idx <= geom.ways());
+
+  // A bypass is reported in the set the address would occupy in way 0
+  const auto set_idx = get_set_index(geom, fill_mshr.address, way_idx < geom.ways() ? way_idx : 0);
+  const auto way = std::next(std::begin(block), static_cast<long>(set_idx * geom.ways() + way_idx));
 
   if constexpr (champsim::debug_print) {
     fmt::print(
         "[{}] {} instr_id: {} address: {:#x} v_address: {:#x} set: {} way: {} type: {} prefetch_metadata: {} cycle_enqueued: {} cycle: {}\n",
-        NAME, __func__, fill_mshr.instr_id, fill_mshr.address, fill_mshr.v_address, get_set_index(fill_mshr.address), way_idx,
+        NAME, __func__, fill_mshr.instr_id, fill_mshr.address, fill_mshr.v_address, set_idx, way_idx,
         access_type_names.at(champsim::to_underlying(fill_mshr.type)), fill_mshr.pf_metadata, fill_mshr.cycle_enqueued, current_cycle);
   }
 
   bool success = true;
   auto metadata_thru = fill_mshr.pf_metadata;
   auto pkt_address = (virtual_prefetch ? fill_mshr.v_address : fill_mshr.address) & ~champsim::bitmask(match_offset_bits ? 0 : OFFSET_BITS);
-  if (way != set_end) {
-    if (way->valid && way->dirty) {
-      request_type writeback_packet;
-
-      writeback_packet.cpu = fill_mshr.cpu;
-      writeback_packet.address = way->address;
-      writeback_packet.data = way->data;
-      writeback_packet.instr_id = fill_mshr.instr_id;
-      writeback_packet.ip = 0;
-      writeback_packet.type = access_type::WRITE;
-      writeback_packet.pf_metadata = way->pf_metadata;
-      writeback_packet.response_requested = false;
+  const auto subblock = subblock_bit(fill_mshr.address);
+  if (way_idx < geom.ways()) {
+    // With a victim buffer, the evicted block moves into the buffer, and the block that leaves this cache is the buffer's oldest, if it is full
+    const bool evicting = !sector_present && way->valid;
+    const BLOCK* outgoing = &*way;
+    if (evicting && VICTIM_BUFFER_SIZE > 0)
+      outgoing = (std::size(victim_buffer) == VICTIM_BUFFER_SIZE) ? &victim_buffer.front() : nullptr;
+
+    if (evicting && outgoing != nullptr && (outgoing->dirty || lower_level->accepts_victims)) {
+      // Every dirty block of an evicted sector is written back, so there must be room for all of them.
+      // An exclusive lower level receives the clean blocks, too.
+      const auto victims = lower_level->accepts_victims ? outgoing->valid_blocks : outgoing->dirty_blocks;
+      const auto writebacks = std::bitset<64>{victims}.count();
+      success = (writebacks <= 1) || (lower_level->wq_occupancy() + writebacks <= lower_level->wq_size());
+
+      for (auto remaining = victims; success && remaining != 0; remaining &= remaining - 1) {
+        request_type writeback_packet;
+
+        writeback_packet.cpu = fill_mshr.cpu;
+        writeback_packet.address = outgoing->address;
+        writeback_packet.data = outgoing->data;
+        writeback_packet.instr_id = fill_mshr.instr_id;
+        writeback_packet.ip = 0;
+        writeback_packet.type = access_type::WRITE;
+        writeback_packet.pf_metadata = outgoing->pf_metadata;
+        writeback_packet.response_requested = false;
+        writeback_packet.clean_victim = (outgoing->dirty_blocks & remaining & (~remaining + 1)) == 0;
+        writeback_packet.address = subblock_address(outgoing->address, remaining);
+
+        if constexpr (champsim::debug_print) {
+          fmt::print("[{}] {} evict address: {:#x} v_address: {:#x} prefetch_metadata: {}\n", NAME,
+              __func__, writeback_packet.address, writeback_packet.v_address, fill_mshr.pf_metadata);
+        }
 
-      if constexpr (champsim::debug_print) {
-        fmt::print("[{}] {} evict address: {:#x} v_address: {:#x} prefetch_metadata: {}\n", NAME,
-            __func__, writeback_packet.address, writeback_packet.v_address, fill_mshr.pf_metadata);
+        success = lower_level->add_wq(writeback_packet);
       }
-
-      success = lower_level->add_wq(writeback_packet);
     }
 
     if (success) {
-      auto evicting_address = (ever_seen_data ? way->address : way->v_address) & ~champsim::bitmask(match_offset_bits ? 0 : OFFSET_BITS);
-
-      if (way->prefetch)
-        ++sim_stats.pf_useless;
+      uint64_t evicting_address = 0;
+
+      if (sector_present) {
+        // Only the block becomes valid. The sector keeps its tag, so the tag array does not change.
+        way->valid_blocks |= subblock;
+        if (fill_mshr.type == access_type::WRITE)
+          way->dirty_blocks |= subblock;
+        if (fill_mshr.prefetch_from_this) {
+          way->prefetch_blocks |= subblock;
+          way->pf_source = fill_mshr.pf_source;
+        }
+        way->dirty = (way->dirty_blocks != 0);
+        way->prefetch = (way->prefetch_blocks != 0);
+        if (partitioner != nullptr)
+          partitioner->touch(static_cast<std::size_t>(std::distance(std::begin(block), way)), current_cycle);
+      } else {
+        evicting_address = (ever_seen_data ? way->address : way->v_address) & ~champsim::bitmask(match_offset_bits ? 0 : OFFSET_BITS);
+        if (evicting && outgoing != nullptr) {
+          if (INCLUSION == champsim::inclusion_policy::inclusive) {
+            for (auto remaining = outgoing->valid_blocks; remaining != 0; remaining &= remaining - 1) {
+              send_invalidation(subblock_address(outgoing->address, remaining));
+              ++sim_stats.back_invalidations;
+            }
+          }
+          sim_stats.pf_useless += std::bitset<64>{outgoing->prefetch_blocks}.count();
+          if (outgoing->pf_source < std::size(sim_stats.prefetchers))
+            sim_stats.prefetchers[outgoing->pf_source].useless += std::bitset<64>{outgoing->prefetch_blocks}.count();
+          record_eviction(*outgoing, fill_mshr.type == access_type::PREFETCH && fill_mshr.prefetch_from_this);
+        }
+        if (evicting && VICTIM_BUFFER_SIZE > 0) {
+          if (std::size(victim_buffer) == VICTIM_BUFFER_SIZE)
+            victim_buffer.pop_front();
+          victim_buffer.push_back(*way);
+        }
+        write_block(static_cast<std::size_t>(std::distance(std::begin(block), way)), BLOCK{fill_mshr, subblock});
+        if (partitioner != nullptr)
+          partitioner->fill(static_cast<std::size_t>(std::distance(std::begin(block), way)), fill_mshr.cpu, current_cycle);
+      }
 
       if (fill_mshr.type == access_type::PREFETCH)
         ++sim_stats.pf_fill;
 
-      *way = BLOCK{fill_mshr};
-
-      metadata_thru = impl_prefetcher_cache_fill(pkt_address, get_set_index(fill_mshr.address), way_idx, fill_mshr.type == access_type::PREFETCH,
-                                                 evicting_address, metadata_thru);
-      impl_update_replacement_state(fill_mshr.cpu, get_set_index(fill_mshr.address), way_idx, fill_mshr.address, fill_mshr.ip, evicting_address,
-                                    champsim::to_underlying(fill_mshr.type), false);
+      if (throttle != nullptr)
+        pf_budget = throttle->budget();
+      metadata_thru = modules.impl_prefetcher_cache_fill(pkt_address, static_cast<uint32_t>(set_idx), static_cast<uint32_t>(way_idx),
+                                                         fill_mshr.type == access_type::PREFETCH, evicting_address, metadata_thru);
+      arbitrate_prefetches();
+      modules.impl_update_replacement_state(fill_mshr.cpu, static_cast<uint32_t>(set_idx), static_cast<uint32_t>(way_idx), fill_mshr.address, fill_mshr.ip,
+                                            evicting_address, champsim::to_underlying(fill_mshr.type), false);
 
       way->pf_metadata = metadata_thru;
     }
@@ -146,15 +213,22 @@ bool CACHE::handle_fill(const mshr_type& fill_mshr)
     // Bypass
     assert(fill_mshr.type != access_type::WRITE);
 
-    metadata_thru =
-        impl_prefetcher_cache_fill(pkt_address, get_set_index(fill_mshr.address), way_idx, fill_mshr.type == access_type::PREFETCH, 0, metadata_thru);
-    impl_update_replacement_state(fill_mshr.cpu, get_set_index(fill_mshr.address), way_idx, fill_mshr.address, fill_mshr.ip, 0,
-                                  champsim::to_underlying(fill_mshr.type), false);
+    if (throttle != nullptr)
+      pf_budget = throttle->budget();
+    metadata_thru = modules.impl_prefetcher_cache_fill(pkt_address, static_cast<uint32_t>(set_idx), static_cast<uint32_t>(way_idx),
+                                                       fill_mshr.type == access_type::PREFETCH, 0, metadata_thru);
+    arbitrate_prefetches();
+    modules.impl_update_replacement_state(fill_mshr.cpu, static_cast<uint32_t>(set_idx), static_cast<uint32_t>(way_idx), fill_mshr.address, fill_mshr.ip, 0,
+                                          champsim::to_underlying(fill_mshr.type), false);
   }
 
   if (success) {
+    record_access(fill_mshr.address, fill_mshr.ip, fill_mshr.cpu, fill_mshr.type, champsim::access_trace_record::FILL);
+
     // COLLECT STATS
     sim_stats.total_miss_latency += current_cycle - (fill_mshr.cycle_enqueued + 1);
+    if (fill_mshr.demand_merge_cycle < current_cycle)
+      sim_stats.pf_late_cycles += current_cycle - fill_mshr.demand_merge_cycle;
 
     response_type response{fill_mshr.address, fill_mshr.v_address, fill_mshr.data, metadata_thru, fill_mshr.instr_depend_on_me};
     for (auto ret : fill_mshr.to_return)
@@ -164,20 +238,24 @@ bool CACHE::handle_fill(const mshr_type& fill_mshr)
   return success;
 }
 
-bool CACHE::try_hit(const tag_lookup_type& handle_pkt)
+template <typename G, typename M>
+bool CACHE::try_hit(const G& geom, M& modules, const tag_lookup_type& handle_pkt)
 {
   cpu = handle_pkt.cpu;
 
   // access cache
-  auto [set_begin, set_end] = get_set_span(handle_pkt.address);
-  auto way = std::find_if(set_begin, set_end,
-                          [match = handle_pkt.address >> OFFSET_BITS, shamt = OFFSET_BITS](const auto& entry) { return (entry.address >> shamt) == match; });
-  const auto hit = (way != set_end);
-  const auto useful_prefetch = (hit && way->prefetch && !handle_pkt.prefetch_from_this);
+  auto way_idx = find_way(geom, handle_pkt.address);
+  if (way_idx == geom.ways() && VICTIM_BUFFER_SIZE > 0)
+    way_idx = swap_victim(geom, modules, handle_pkt);
+  const auto subblock = subblock_bit(handle_pkt.address);
+  const auto set_idx = get_set_index(geom, handle_pkt.address, way_idx < geom.ways() ? way_idx : 0);
+  const auto way = std::next(std::begin(block), static_cast<long>(set_idx * geom.ways() + way_idx));
+  const auto hit = (way_idx < geom.ways()) && (way->valid_blocks & subblock) != 0;
+  const auto useful_prefetch = (hit && (way->prefetch_blocks & subblock) != 0 && !handle_pkt.prefetch_from_this);
 
   if constexpr (champsim::debug_print) {
     fmt::print("[{}] {} instr_id: {} address: {:#x} v_address: {:#x} data: {:#x} set: {} way: {} ({}) type: {} cycle: {}\n", NAME, __func__, handle_pkt.instr_id,
-               handle_pkt.address, handle_pkt.v_address, handle_pkt.data, get_set_index(handle_pkt.address), std::distance(set_begin, way), hit ? "HIT" : "MISS",
+               handle_pkt.address, handle_pkt.v_address, handle_pkt.data, set_idx, way_idx, hit ? "HIT" : "MISS",
                access_type_names.at(champsim::to_underlying(handle_pkt.type)), current_cycle);
   }
 
@@ -185,28 +263,44 @@ bool CACHE::try_hit(const tag_lookup_type& handle_pkt)
   auto metadata_thru = handle_pkt.pf_metadata;
   if (should_activate_prefetcher(handle_pkt)) {
     uint64_t pf_base_addr = (virtual_prefetch ? handle_pkt.v_address : handle_pkt.address) & ~champsim::bitmask(match_offset_bits ? 0 : OFFSET_BITS);
-    metadata_thru = impl_prefetcher_cache_operate(pf_base_addr, handle_pkt.ip, hit, useful_prefetch, champsim::to_underlying(handle_pkt.type), metadata_thru);
+    if (throttle != nullptr)
+      pf_budget = throttle->budget();
+    metadata_thru = modules.impl_prefetcher_cache_operate(pf_base_addr, handle_pkt.ip, hit, useful_prefetch, champsim::to_underlying(handle_pkt.type), metadata_thru);
+    arbitrate_prefetches();
   }
 
   if (hit) {
     ++sim_stats.hits[champsim::to_underlying(handle_pkt.type)][handle_pkt.cpu];
+    record_access(handle_pkt.address, handle_pkt.ip, handle_pkt.cpu, handle_pkt.type, champsim::access_trace_record::HIT);
 
     // update replacement policy
-    const auto way_idx = static_cast<std::size_t>(std::distance(set_begin, way)); // cast protected by earlier assertion
-    impl_update_replacement_state(handle_pkt.cpu, get_set_index(handle_pkt.address), way_idx, way->address, handle_pkt.ip, 0,
-                                  champsim::to_underlying(handle_pkt.type), true);
+    modules.impl_update_replacement_state(handle_pkt.cpu, static_cast<uint32_t>(set_idx), static_cast<uint32_t>(way_idx), way->address, handle_pkt.ip, 0,
+                                          champsim::to_underlying(handle_pkt.type), true);
+    if (partitioner != nullptr)
+      partitioner->touch(set_idx * geom.ways() + way_idx, current_cycle);
 
     response_type response{handle_pkt.address, handle_pkt.v_address, way->data, metadata_thru, handle_pkt.instr_depend_on_me};
     for (auto ret : handle_pkt.to_return)
       ret->push_back(response);
 
-    way->dirty |= (handle_pkt.type == access_type::WRITE);
+    if (handle_pkt.type == access_type::WRITE && !handle_pkt.clean_victim) {
+      way->dirty_blocks |= subblock;
+      way->dirty = true;
+    }
 
     // update prefetch stats and reset prefetch bit
     if (useful_prefetch) {
       ++sim_stats.pf_useful;
-      way->prefetch = false;
+      if (way->pf_source < std::size(sim_stats.prefetchers))
+        ++sim_stats.prefetchers[way->pf_source].useful;
+      way->prefetch_blocks &= ~subblock;
+      way->prefetch = (way->prefetch_blocks != 0);
     }
+
+    // An exclusive cache gives up a block that moves to an upper level. A modified block stays, since this cache must still write it back.
+    if (INCLUSION == champsim::inclusion_policy::exclusive && handle_pkt.type != access_type::WRITE && !std::empty(handle_pkt.to_return)
+        && (way->dirty_blocks & subblock) == 0)
+      invalidate_block(set_idx * geom.ways() + way_idx, subblock);
   }
 
   return hit;
@@ -225,27 +319,39 @@ bool CACHE::handle_miss(const tag_lookup_type& handle_pkt)
   cpu = handle_pkt.cpu;
 
   // check mshr
-  auto mshr_entry = std::find_if(std::begin(MSHR), std::end(MSHR), [match = handle_pkt.address >> OFFSET_BITS, shamt = OFFSET_BITS](const auto& entry) {
-    return (entry.address >> shamt) == match;
-  });
-  bool mshr_full = (MSHR.size() == MSHR_SIZE);
+  auto mshr_entry = find_mshr(handle_pkt.address);
+  const bool use_pf_partition = (PF_MSHR_SIZE > 0 && handle_pkt.prefetch_from_this);
+  bool mshr_full = use_pf_partition ? (pf_mshr_occupancy == PF_MSHR_SIZE) : (std::size(MSHR) - pf_mshr_occupancy == MSHR_SIZE);
+  // A prefetch that will not fill this cache needs no MSHR
+  const bool needs_mshr = (!handle_pkt.prefetch_from_this || !handle_pkt.skip_fill);
 
   if (mshr_entry != MSHR.end()) // miss already inflight
   {
-    if (mshr_entry->type == access_type::PREFETCH && handle_pkt.type != access_type::PREFETCH) {
-      // Mark the prefetch as useful
-      if (mshr_entry->prefetch_from_this)
-        ++sim_stats.pf_useful;
+    // Mark the prefetch as useful, but late
+    const bool late_prefetch = (mshr_entry->type == access_type::PREFETCH && handle_pkt.type != access_type::PREFETCH && mshr_entry->prefetch_from_this);
+    if (late_prefetch) {
+      ++sim_stats.pf_useful;
+      ++sim_stats.pf_late;
+      if (mshr_entry->pf_source < std::size(sim_stats.prefetchers))
+        ++sim_stats.prefetchers[mshr_entry->pf_source].useful;
     }
 
     *mshr_entry = mshr_type::merge(*mshr_entry, to_allocate);
+    if (late_prefetch)
+      mshr_entry->demand_merge_cycle = current_cycle;
   } else {
-    if (mshr_full) { // not enough MSHR resource
+    if (mshr_full && (needs_mshr || FULL_MSHR_PREFETCH == champsim::full_mshr_policy::stall)) { // not enough MSHR resource
+      // Nothing waits on this cache's own prefetches, so they may be dropped rather than hold back the tag checks behind them
+      if (FULL_MSHR_PREFETCH == champsim::full_mshr_policy::drop && handle_pkt.prefetch_from_this) {
+        ++sim_stats.pf_dropped;
+        return true;
+      }
+
       if constexpr (champsim::debug_print) {
         fmt::print("[{}] {} MSHR full\n", NAME, __func__);
       }
 
-      return false;  // TODO should we allow prefetches anyway if they will not be filled to this level?
+      return false;
     }
 
     request_type fwd_pkt;
@@ -263,7 +369,7 @@ bool CACHE::handle_miss(const tag_lookup_type& handle_pkt)
     fwd_pkt.ip = handle_pkt.ip;
 
     fwd_pkt.instr_depend_on_me = handle_pkt.instr_depend_on_me;
-    fwd_pkt.response_requested = (!handle_pkt.prefetch_from_this || !handle_pkt.skip_fill);
+    fwd_pkt.response_requested = needs_mshr;
 
     bool success;
     if (prefetch_as_load || handle_pkt.type != access_type::PREFETCH)
@@ -283,10 +389,21 @@ bool CACHE::handle_miss(const tag_lookup_type& handle_pkt)
     if (fwd_pkt.response_requested) {
       MSHR.push_back(to_allocate);
       MSHR.back().pf_metadata = fwd_pkt.pf_metadata;
+      MSHR.back().prefetch_partition = use_pf_partition;
+      if (use_pf_partition)
+        ++pf_mshr_occupancy;
+      mshr_index.insert_or_assign(handle_pkt.address >> OFFSET_BITS, mshr_base + std::size(MSHR) - 1);
     }
+
+    if (handle_pkt.type != access_type::PREFETCH)
+      check_evicted_filter(handle_pkt.address);
   }
 
   ++sim_stats.misses[champsim::to_underlying(handle_pkt.type)][handle_pkt.cpu];
+  if (VICTIM_BUFFER_SIZE > 0)
+    ++sim_stats.victim_misses;
+  count_sector_miss(handle_pkt.address);
+  record_access(handle_pkt.address, handle_pkt.ip, handle_pkt.cpu, handle_pkt.type, 0);
 
   return true;
 }
@@ -303,10 +420,107 @@ bool CACHE::handle_write(const tag_lookup_type& handle_pkt)
   inflight_writes.back().event_cycle = current_cycle + (warmup ? 0 : FILL_LATENCY);
     
   ++sim_stats.misses[champsim::to_underlying(handle_pkt.type)][handle_pkt.cpu];
+  if (INCLUSION == champsim::inclusion_policy::exclusive)
+    ++sim_stats.victim_inserts;
+  if (VICTIM_BUFFER_SIZE > 0)
+    ++sim_stats.victim_misses;
+  count_sector_miss(handle_pkt.address);
+  record_access(handle_pkt.address, handle_pkt.ip, handle_pkt.cpu, handle_pkt.type, 0);
 
   return true;
 }
 
+bool CACHE::handle_write_around(const tag_lookup_type& handle_pkt)
+{
+  if constexpr (champsim::debug_print) {
+    fmt::print("[{}] {} instr_id: {} address: {:#x} v_address: {:#x} type: {} cycle: {}\n", NAME, __func__, handle_pkt.instr_id, handle_pkt.address,
+               handle_pkt.v_address, access_type_names.at(champsim::to_underlying(handle_pkt.type)), current_cycle);
+  }
+
+  request_type fwd_pkt;
+
+  fwd_pkt.asid[0] = handle_pkt.asid[0];
+  fwd_pkt.asid[1] = handle_pkt.asid[1];
+  fwd_pkt.type = access_type::WRITE;
+  fwd_pkt.pf_metadata = handle_pkt.pf_metadata;
+  fwd_pkt.cpu = handle_pkt.cpu;
+
+  fwd_pkt.address = handle_pkt.address;
+  fwd_pkt.v_address = handle_pkt.v_address;
+  fwd_pkt.data = handle_pkt.data;
+  fwd_pkt.instr_id = handle_pkt.instr_id;
+  fwd_pkt.ip = handle_pkt.ip;
+  fwd_pkt.clean_victim = handle_pkt.clean_victim;
+  fwd_pkt.response_requested = false;
+
+  if (!lower_level->add_wq(fwd_pkt))
+    return false;
+
+  ++sim_stats.misses[champsim::to_underlying(handle_pkt.type)][handle_pkt.cpu];
+  ++sim_stats.write_arounds;
+  if (VICTIM_BUFFER_SIZE > 0)
+    ++sim_stats.victim_misses;
+  record_access(handle_pkt.address, handle_pkt.ip, handle_pkt.cpu, handle_pkt.type, 0);
+
+  return true;
+}
+
+uint64_t CACHE::subblock_bit(uint64_t address) const { return 1ull << ((address >> OFFSET_BITS) & (SECTOR_SIZE - 1)); }
+
+uint64_t CACHE::subblock_address(uint64_t sector_address, uint64_t blocks) const
+{
+  if (SECTOR_SIZE == 1)
+    return sector_address;
+  return champsim::splice_bits(sector_address, static_cast<uint64_t>(__builtin_ctzll(blocks)) << OFFSET_BITS, runtime_geometry.offset_bits());
+}
+
+std::size_t CACHE::get_bank(uint64_t address) const { return (address >> BANK_OFFSET_BITS) & (NUM_BANKS - 1); }
+
+void CACHE::count_sector_miss(uint64_t address)
+{
+  if (SECTOR_SIZE == 1)
+    return;
+
+  if (find_way(runtime_geometry, address) < NUM_WAY)
+    ++sim_stats.subblock_miss;
+  else
+    ++sim_stats.sector_miss;
+}
+
+void CACHE::record_eviction(const BLOCK& blk, bool by_prefetch)
+{
+  const bool unused_prefetch = (blk.prefetch_blocks != 0);
+  if (unused_prefetch)
+    sim_stats.pf_useless_cycles += current_cycle - std::min(blk.fill_cycle, current_cycle);
+
+  if (unused_prefetch || by_prefetch)
+    evicted_filter.fill({blk.address >> runtime_geometry.offset_bits(), current_cycle, unused_prefetch, by_prefetch});
+}
+
+void CACHE::check_evicted_filter(uint64_t address)
+{
+  auto found = evicted_filter.invalidate({address >> runtime_geometry.offset_bits()});
+  if (!found.has_value())
+    return;
+
+  if (found->unused_prefetch) {
+    ++sim_stats.pf_early;
+    sim_stats.pf_early_cycles += current_cycle - found->evict_cycle;
+  }
+  if (found->prefetch_victim)
+    ++sim_stats.pf_pollution;
+}
+
+void CACHE::record_access(uint64_t address, uint64_t ip, uint32_t triggering_cpu, access_type type, uint8_t flags)
+{
+  if (access_trace_out == nullptr)
+    return;
+
+  if (warmup)
+    flags = static_cast<uint8_t>(flags | champsim::access_trace_record::WARMUP);
+  access_trace_out->record({address, ip, current_cycle, triggering_cpu, static_cast<uint8_t>(champsim::to_underlying(type)), flags});
+}
+
 template <bool UpdateRequest>
 auto CACHE::initiate_tag_check(champsim::channel* ul)
 {
@@ -316,7 +530,7 @@ auto CACHE::initiate_tag_check(champsim::channel* ul)
 
     if constexpr (UpdateRequest) {
       if (entry.response_requested)
-        retval.to_return = {&ul->returned};
+        retval.to_return = ul->return_to_this();
     }
 
     if constexpr (champsim::debug_print) {
@@ -328,9 +542,24 @@ auto CACHE::initiate_tag_check(champsim::channel* ul)
   };
 }
 
-long CACHE::operate()
+long CACHE::operate() { return (this->*operate_impl)(); }
+
+template <typename G>
+G CACHE::geometry() const
 {
+  if constexpr (champsim::is_static_geometry_v<G>)
+    return G{};
+  else
+    return runtime_geometry;
+}
+
+template <typename G, typename M>
+long CACHE::operate_with()
+{
+  const auto geom = geometry<G>();
+  auto& modules = static_cast<M&>(*module_pimpl);
   long progress{0};
+  const auto dependency_allocations_before = champsim::pooled_list_allocations;
 
   for (auto ul : upper_levels)
     ul->check_collision();
@@ -347,13 +576,21 @@ long CACHE::operate()
     lower_translate->returned.clear();
   }
 
+  // Invalidate the blocks that an inclusive lower level has evicted
+  auto invalidations_end = std::find_if_not(std::begin(lower_level->invalidations), std::end(lower_level->invalidations),
+                                            [this](uint64_t address) { return this->back_invalidate(address); });
+  progress += std::distance(std::begin(lower_level->invalidations), invalidations_end);
+  lower_level->invalidations.erase(std::begin(lower_level->invalidations), invalidations_end);
+
   // Perform fills
   auto fill_bw = MAX_FILL;
   for (auto q : {std::ref(MSHR), std::ref(inflight_writes)}) {
     auto [fill_begin, fill_end] =
         champsim::get_span_p(std::cbegin(q.get()), std::cend(q.get()), fill_bw, [cycle = current_cycle](const auto& x) { return x.event_cycle <= cycle; });
-    auto complete_end = std::find_if_not(fill_begin, fill_end, [this](const auto& x) { return this->handle_fill(x); });
+    auto complete_end = std::find_if_not(fill_begin, fill_end, [this, &geom, &modules](const auto& x) { return this->handle_fill(geom, modules, x); });
     fill_bw -= std::distance(fill_begin, complete_end);
+    if (&q.get() == &MSHR)
+      retire_mshr(complete_end);
     q.get().erase(fill_begin, complete_end);
   }
   progress += MAX_FILL - fill_bw;
@@ -391,23 +628,67 @@ long CACHE::operate()
   inflight_tag_check.erase(last_not_missed, std::end(inflight_tag_check));
 
   // Perform tag checks
-  auto do_tag_check = [this](const auto& pkt) {
-    if (this->try_hit(pkt))
+  auto do_tag_check = [this, &geom, &modules](const auto& pkt) {
+    if (this->try_hit(geom, modules, pkt))
       return true;
+    if (pkt.type == access_type::WRITE && this->WRITE_POLICY == champsim::write_policy::no_write_allocate)
+      return this->handle_write_around(pkt);
     if (pkt.type == access_type::WRITE && !this->match_offset_bits)
       return this->handle_write(pkt); // Treat writes (that is, writebacks) like fills
     else
       return this->handle_miss(pkt); // Treat writes (that is, stores) like reads
   };
-  auto [tag_check_ready_begin, tag_check_ready_end] =
-      champsim::get_span_p(std::begin(inflight_tag_check), std::end(inflight_tag_check), MAX_TAG,
-                           [cycle = current_cycle](const auto& pkt) { return pkt.event_cycle <= cycle && pkt.is_translated; });
+  auto tag_check_ready = [cycle = current_cycle](const auto& pkt) { return pkt.event_cycle <= cycle && pkt.is_translated; };
+  // In a banked cache, tag checks begin in order, so one that finds its bank busy holds back those behind it
+  auto bank_available = [this, tag_check_ready](const auto& pkt) {
+    if (!tag_check_ready(pkt))
+      return false;
+    auto& last_access = this->bank_last_access[this->get_bank(pkt.address)];
+    if (last_access == this->current_cycle) {
+      ++this->sim_stats.bank_conflicts;
+      return false;
+    }
+    last_access = this->current_cycle;
+    return true;
+  };
+  auto [tag_check_ready_begin, tag_check_ready_end] = (NUM_BANKS > 1)
+                                                          ? champsim::get_span_p(std::begin(inflight_tag_check), std::end(inflight_tag_check), MAX_TAG, bank_available)
+                                                          : champsim::get_span_p(std::begin(inflight_tag_check), std::end(inflight_tag_check), MAX_TAG, tag_check_ready);
   auto finish_tag_check_end = std::find_if_not(tag_check_ready_begin, tag_check_ready_end, do_tag_check);
   auto tag_bw_consumed = std::distance(tag_check_ready_begin, finish_tag_check_end);
+  if (NUM_BANKS > 1) {
+    std::for_each(tag_check_ready_begin, finish_tag_check_end, [this](const auto& pkt) { ++this->sim_stats.bank_accesses.at(this->get_bank(pkt.address)); });
+  }
+  std::for_each(tag_check_ready_begin, finish_tag_check_end, [this](const auto& pkt) {
+    if (pkt.type == access_type::WRITE)
+      this->sim_stats.bytes_written += (1ull << this->OFFSET_BITS);
+  });
+  // The utility monitors of a partitioned cache see every access except writebacks
+  if (partitioner != nullptr) {
+    std::for_each(tag_check_ready_begin, finish_tag_check_end, [this, &geom](const auto& pkt) {
+      if (pkt.type != access_type::WRITE)
+        this->partitioner->monitor(pkt.cpu, this->get_set_index(geom, pkt.address), pkt.address >> geom.offset_bits());
+    });
+  }
+  ++sim_stats.cycles;
   progress += std::distance(tag_check_ready_begin, finish_tag_check_end);
   inflight_tag_check.erase(tag_check_ready_begin, finish_tag_check_end);
 
-  impl_prefetcher_cycle_operate();
+  if (throttle != nullptr)
+    pf_budget = throttle->budget();
+  modules.impl_prefetcher_cycle_operate();
+  arbitrate_prefetches();
+
+  if (throttle != nullptr && current_cycle > 0 && current_cycle % PREFETCH_THROTTLE_INTERVAL == 0) {
+    throttle->update(throttle_feedback());
+    sim_stats.throttle_level_sum += throttle->level();
+    ++sim_stats.throttle_intervals;
+  }
+
+  if (partitioner != nullptr && current_cycle > 0 && current_cycle % PARTITION_INTERVAL == 0) {
+    partitioner->repartition();
+    sim_stats.way_allocations.emplace_back(current_cycle, partitioner->allocations());
+  }
 
   if constexpr (champsim::debug_print) {
     fmt::print("[{}] {} cycle completed: {} tags checked: {} remaining: {} stash consumed: {} remaining: {} channel consumed: {} pq consumed {} unused consume bw {}\n", NAME, __func__, current_cycle,
@@ -416,6 +697,8 @@ long CACHE::operate()
         channels_bandwidth_consumed, pq_bandwidth_consumed, tag_bw);
   }
 
+  sim_stats.dependency_list_allocations += champsim::pooled_list_allocations - dependency_allocations_before;
+
   return progress;
 }
 
@@ -423,53 +706,316 @@ long CACHE::operate()
 uint64_t CACHE::get_set(uint64_t address) const { return get_set_index(address); }
 // LCOV_EXCL_STOP
 
-std::size_t CACHE::get_set_index(uint64_t address) const { return (address >> OFFSET_BITS) & champsim::bitmask(champsim::lg2(NUM_SET)); }
+std::size_t CACHE::get_set_index(uint64_t address) const { return get_set_index(geometry<champsim::dynamic_geometry>(), address); }
+
+std::size_t CACHE::get_set_index(uint64_t address, uint32_t way) const { return get_set_index(runtime_geometry, address, way); }
 
-template <typename It>
-std::pair<It, It> get_span(It anchor, typename std::iterator_traits<It>::difference_type set_idx, typename std::iterator_traits<It>::difference_type num_way)
+template <typename G>
+std::size_t CACHE::get_set_index(const G& geom, uint64_t address) const
 {
-  auto begin = std::next(anchor, set_idx * num_way);
-  return {std::move(begin), std::next(begin, num_way)};
+  const auto set_idx = geom.set_index(address);
+  assert(set_idx < geom.sets());
+  return set_idx;
 }
 
-auto CACHE::get_set_span(uint64_t address) -> std::pair<std::vector<BLOCK>::iterator, std::vector<BLOCK>::iterator>
+template <typename G>
+std::size_t CACHE::get_set_index(const G& geom, uint64_t address, std::size_t way) const
 {
-  const auto set_idx = get_set_index(address);
-  assert(set_idx < NUM_SET);
-  return get_span(std::begin(block), static_cast<std::vector<BLOCK>::difference_type>(set_idx), NUM_WAY); // safe cast because of prior assert
+  const auto set_idx = geom.set_index(address, static_cast<uint32_t>(way));
+  assert(set_idx < geom.sets());
+  return set_idx;
 }
 
-auto CACHE::get_set_span(uint64_t address) const -> std::pair<std::vector<BLOCK>::const_iterator, std::vector<BLOCK>::const_iterator>
+template <typename G>
+std::size_t CACHE::find_way(const G& geom, uint64_t address) const
 {
-  const auto set_idx = get_set_index(address);
-  assert(set_idx < NUM_SET);
-  return get_span(std::cbegin(block), static_cast<std::vector<BLOCK>::difference_type>(set_idx), NUM_WAY); // safe cast because of prior assert
+  const auto tag = address >> geom.offset_bits();
+  if (geom.skewed()) {
+    for (std::size_t way = 0; way < geom.ways(); ++way) {
+      if (block_tags[get_set_index(geom, address, way) * geom.ways() + way] == tag)
+        return way;
+    }
+    return geom.ways();
+  }
+
+  const auto set_begin = std::next(std::data(block_tags), static_cast<long>(get_set_index(geom, address) * geom.ways()));
+  const auto set_end = std::next(set_begin, geom.ways());
+  return static_cast<std::size_t>(std::distance(set_begin, champsim::find_tag(set_begin, set_end, tag)));
 }
 
-// LCOV_EXCL_START exclude deprecated function
-uint64_t CACHE::get_way(uint64_t address, uint64_t) const
+template <typename G>
+std::size_t CACHE::find_invalid_way(const G& geom, uint64_t address) const
+{
+  if (geom.skewed()) {
+    for (std::size_t way = 0; way < geom.ways(); ++way) {
+      if (!block_valid[get_set_index(geom, address, way) * geom.ways() + way])
+        return way;
+    }
+    return geom.ways();
+  }
+
+  const auto set_begin = std::next(std::cbegin(block_valid), static_cast<long>(get_set_index(geom, address) * geom.ways()));
+  const auto set_end = std::next(set_begin, geom.ways());
+  return static_cast<std::size_t>(std::distance(set_begin, std::find(set_begin, set_end, false)));
+}
+
+template <typename G>
+std::size_t CACHE::partition_victim(const G& geom, uint64_t address, uint32_t triggering_cpu, std::size_t way) const
+{
+  if (way >= geom.ways() || triggering_cpu >= NUM_CPUS)
+    return way;
+
+  auto index_of = [this, &geom, address](std::size_t w) { return this->get_set_index(geom, address, w) * geom.ways() + w; };
+
+  std::array<uint32_t, NUM_CPUS> occupancy{};
+  for (std::size_t w = 0; w < geom.ways(); ++w) {
+    if (block_valid[index_of(w)] && partitioner->owner(index_of(w)) < NUM_CPUS)
+      ++occupancy[partitioner->owner(index_of(w))];
+  }
+
+  // A core below its share takes a block from a core above its own. Otherwise, it replaces one of its own blocks.
+  const auto& allocation = partitioner->allocations();
+  const bool grow = (occupancy[triggering_cpu] < allocation[triggering_cpu]);
+  auto eligible = [&, this](std::size_t w) {
+    const auto index = index_of(w);
+    if (!block_valid[index])
+      return true;
+    const auto owner = partitioner->owner(index);
+    if (grow)
+      return owner != triggering_cpu && (owner >= NUM_CPUS || occupancy[owner] > allocation[owner]);
+    return owner == triggering_cpu;
+  };
+
+  if (eligible(way))
+    return way;
+
+  // The replacement policy's choice is not eligible, so the least recently used eligible block is replaced instead
+  std::size_t victim = geom.ways();
+  for (std::size_t w = 0; w < geom.ways(); ++w) {
+    if (eligible(w) && (victim == geom.ways() || partitioner->last_use(index_of(w)) < partitioner->last_use(index_of(victim))))
+      victim = w;
+  }
+  return (victim < geom.ways()) ? victim : way;
+}
+
+template <typename G, typename M>
+std::size_t CACHE::choose_victim(const G& geom, M& modules, uint32_t triggering_cpu, uint64_t instr_id, uint64_t ip, uint64_t address, access_type type)
+{
+  auto way_idx = find_invalid_way(geom, address);
+  if (way_idx == geom.ways()) {
+    way_idx = modules.impl_find_victim(triggering_cpu, instr_id, static_cast<uint32_t>(get_set_index(geom, address)), get_candidates(geom, address), ip, address,
+                                       champsim::to_underlying(type));
+
+    // A partitioned cache overrides a victim that the replacement policy chose outside the core's share of the ways
+    if (partitioner != nullptr)
+      way_idx = partition_victim(geom, address, triggering_cpu, way_idx);
+  }
+  return way_idx;
+}
+
+template <typename G, typename M>
+std::size_t CACHE::swap_victim(const G& geom, M& modules, const tag_lookup_type& handle_pkt)
+{
+  auto found = find_victim_entry(handle_pkt.address);
+  if (found == std::end(victim_buffer))
+    return geom.ways();
+
+  if ((found->valid_blocks & subblock_bit(handle_pkt.address)) != 0)
+    ++sim_stats.victim_hits;
+
+  // The block must leave the buffer, so a replacement policy that would bypass it is overruled
+  auto way_idx = choose_victim(geom, modules, handle_pkt.cpu, handle_pkt.instr_id, handle_pkt.ip, handle_pkt.address, handle_pkt.type);
+  if (way_idx == geom.ways())
+    way_idx = 0;
+
+  const auto set_idx = get_set_index(geom, handle_pkt.address, way_idx);
+  const auto index = set_idx * geom.ways() + way_idx;
+  const auto returning = *found;
+  const auto displaced = block[index];
+
+  victim_buffer.erase(found);
+  if (displaced.valid)
+    victim_buffer.push_back(displaced);
+  write_block(index, returning);
+  if (partitioner != nullptr)
+    partitioner->fill(index, handle_pkt.cpu, current_cycle);
+
+  const auto evicting_address = displaced.valid ? ((ever_seen_data ? displaced.address : displaced.v_address) & ~champsim::bitmask(match_offset_bits ? 0 : OFFSET_BITS)) : 0;
+  modules.impl_update_replacement_state(handle_pkt.cpu, static_cast<uint32_t>(set_idx), static_cast<uint32_t>(way_idx), returning.address, handle_pkt.ip,
+                                        evicting_address, champsim::to_underlying(handle_pkt.type), false);
+  ++sim_stats.victim_swaps;
+
+  return way_idx;
+}
+
+auto CACHE::find_victim_entry(uint64_t address) -> champsim::ring_buffer<BLOCK>::iterator
+{
+  const auto tag = address >> runtime_geometry.offset_bits();
+  return std::find_if(std::begin(victim_buffer), std::end(victim_buffer),
+                      [tag, shamt = runtime_geometry.offset_bits()](const BLOCK& entry) { return entry.valid && (entry.address >> shamt) == tag; });
+}
+
+template <typename G>
+auto CACHE::get_candidates(const G& geom, uint64_t address) -> const BLOCK*
+{
+  if (geom.skewed()) {
+    for (std::size_t way = 0; way < geom.ways(); ++way)
+      skewed_candidates[way] = block[get_set_index(geom, address, way) * geom.ways() + way];
+    return std::data(skewed_candidates);
+  }
+
+  return std::next(std::data(block), static_cast<long>(get_set_index(geom, address) * geom.ways()));
+}
+
+void CACHE::write_block(std::size_t index, BLOCK blk)
 {
-  auto [begin, end] = get_set_span(address);
-  return std::distance(
-      begin, std::find_if(begin, end, [match = address >> OFFSET_BITS, shamt = OFFSET_BITS](const auto& entry) { return (entry.address >> shamt) == match; }));
+  assert(index < std::size(block));
+  block_tags[index] = blk.address >> runtime_geometry.offset_bits();
+  block_valid[index] = blk.valid;
+  block[index] = blk;
 }
+
+// LCOV_EXCL_START exclude deprecated function
+uint64_t CACHE::get_way(uint64_t address, uint64_t) const { return find_way(geometry<champsim::dynamic_geometry>(), address); }
 // LCOV_EXCL_STOP
 
 uint64_t CACHE::invalidate_entry(uint64_t inval_addr)
 {
-  auto [begin, end] = get_set_span(inval_addr);
-  auto inv_way =
-      std::find_if(begin, end, [match = inval_addr >> OFFSET_BITS, shamt = OFFSET_BITS](const auto& entry) { return (entry.address >> shamt) == match; });
+  const auto geom = geometry<champsim::dynamic_geometry>();
+  const auto way_idx = find_way(geom, inval_addr);
+
+  if (way_idx < NUM_WAY)
+    invalidate_block(get_set_index(geom, inval_addr, way_idx) * NUM_WAY + way_idx, subblock_bit(inval_addr));
+  else if (auto found = find_victim_entry(inval_addr); found != std::end(victim_buffer))
+    invalidate_victim_entry(found, subblock_bit(inval_addr));
+
+  return way_idx;
+}
 
-  if (inv_way != end)
-    inv_way->valid = 0;
+void CACHE::invalidate_block(std::size_t index, uint64_t subblock)
+{
+  // In a sectored cache, the sector remains valid until its last block is invalidated
+  block[index].valid_blocks &= ~subblock;
+  block[index].dirty_blocks &= ~subblock;
+  block[index].prefetch_blocks &= ~subblock;
+  block[index].valid = (block[index].valid_blocks != 0);
+  block[index].dirty = (block[index].dirty_blocks != 0);
+  block[index].prefetch = (block[index].prefetch_blocks != 0);
+  block_valid[index] = block[index].valid;
+}
 
-  return std::distance(begin, inv_way);
+void CACHE::invalidate_victim_entry(champsim::ring_buffer<BLOCK>::iterator entry, uint64_t subblock)
+{
+  entry->valid_blocks &= ~subblock;
+  entry->dirty_blocks &= ~subblock;
+  entry->prefetch_blocks &= ~subblock;
+  entry->dirty = (entry->dirty_blocks != 0);
+  entry->prefetch = (entry->prefetch_blocks != 0);
+  if (entry->valid_blocks == 0)
+    victim_buffer.erase(entry);
+}
+
+bool CACHE::back_invalidate(uint64_t address)
+{
+  const auto geom = geometry<champsim::dynamic_geometry>();
+  const auto way_idx = find_way(geom, address);
+
+  if (way_idx < NUM_WAY) {
+    const auto index = get_set_index(geom, address, way_idx) * NUM_WAY + way_idx;
+    const auto subblock = subblock_bit(address);
+
+    // The lower level no longer holds the block, so modified data must be written back again
+    if ((block[index].dirty_blocks & subblock) != 0) {
+      request_type writeback_packet;
+
+      writeback_packet.cpu = cpu;
+      writeback_packet.address = subblock_address(block[index].address, subblock);
+      writeback_packet.data = block[index].data;
+      writeback_packet.ip = 0;
+      writeback_packet.type = access_type::WRITE;
+      writeback_packet.pf_metadata = block[index].pf_metadata;
+      writeback_packet.response_requested = false;
+
+      if (!lower_level->add_wq(writeback_packet))
+        return false;
+    }
+
+    invalidate_block(index, subblock);
+  } else if (auto found = find_victim_entry(address); found != std::end(victim_buffer)) {
+    const auto subblock = subblock_bit(address);
+
+    if ((found->dirty_blocks & subblock) != 0) {
+      request_type writeback_packet;
+
+      writeback_packet.cpu = cpu;
+      writeback_packet.address = subblock_address(found->address, subblock);
+      writeback_packet.data = found->data;
+      writeback_packet.ip = 0;
+      writeback_packet.type = access_type::WRITE;
+      writeback_packet.pf_metadata = found->pf_metadata;
+      writeback_packet.response_requested = false;
+
+      if (!lower_level->add_wq(writeback_packet))
+        return false;
+    }
+
+    invalidate_victim_entry(found, subblock);
+  }
+
+  send_invalidation(address);
+  return true;
+}
+
+void CACHE::send_invalidation(uint64_t address)
+{
+  for (auto ul : upper_levels) {
+    if (ul->accepts_invalidations)
+      ul->invalidations.push_back(address);
+  }
 }
 
 int CACHE::prefetch_line(uint64_t pf_addr, bool fill_this_level, uint32_t prefetch_metadata)
+{
+  return prefetch_line(pf_addr, fill_this_level, prefetch_metadata, 1.0);
+}
+
+int CACHE::prefetch_line(uint64_t pf_addr, bool fill_this_level, uint32_t prefetch_metadata, double confidence)
 {
   ++sim_stats.pf_requested;
+  if (active_prefetcher < std::size(sim_stats.prefetchers))
+    ++sim_stats.prefetchers[active_prefetcher].requested;
+
+  // With more than one prefetcher, each may nominate a full prefetch queue of candidates
+  if (std::size(prefetcher_names) > 1) {
+    if (std::size(pf_candidates) / std::size(prefetcher_names) >= PQ_SIZE)
+      return false;
+    pf_candidates.push_back({pf_addr, fill_this_level, prefetch_metadata, active_prefetcher, confidence});
+    return champsim::prefetch_queued;
+  }
+
+  return issue_prefetch(pf_addr, fill_this_level, prefetch_metadata, active_prefetcher, confidence) ? champsim::prefetch_issued : champsim::prefetch_refused;
+}
+
+std::vector<uint64_t> CACHE::take_dropped_prefetches()
+{
+  if (active_prefetcher >= std::size(pf_dropped_candidates))
+    return {};
+  return std::exchange(pf_dropped_candidates[active_prefetcher], {});
+}
+
+bool CACHE::issue_prefetch(uint64_t pf_addr, bool fill_this_level, uint32_t prefetch_metadata, unsigned source, double confidence)
+{
+  // Do not prefetch into a region that the replacement policy of the level it would fill expects not to be reused
+  auto* fill_hints = (fill_this_level || lower_hints() == nullptr) ? &hints : lower_hints();
+  if (fill_hints->region_reuse(pf_addr) == champsim::reuse_prediction::dead) {
+    ++sim_stats.pf_suppressed;
+    return false;
+  }
+
+  if (pf_budget == 0) {
+    ++sim_stats.pf_throttled;
+    return false;
+  }
 
   if (std::size(internal_PQ) >= PQ_SIZE)
     return false;
@@ -483,11 +1029,96 @@ int CACHE::prefetch_line(uint64_t pf_addr, bool fill_this_level, uint32_t prefet
   pf_packet.is_translated = !virtual_prefetch;
 
   internal_PQ.emplace_back(pf_packet, true, !fill_this_level);
+  internal_PQ.back().pf_source = source;
   ++sim_stats.pf_issued;
+  if (source < std::size(sim_stats.prefetchers))
+    ++sim_stats.prefetchers[source].issued;
+  if (throttle != nullptr)
+    --pf_budget;
+
+  hints.publish_confidence(pf_addr, confidence);
+  if (lower_hints() != nullptr)
+    lower_hints()->publish_confidence(pf_addr, confidence);
 
   return true;
 }
 
+void CACHE::arbitrate_prefetches()
+{
+  if (std::empty(pf_candidates))
+    return;
+
+  // Rank the candidates by the prefetcher's confidence in each, weighted by that prefetcher's accuracy
+  auto score = [this](const prefetch_candidate& x) { return x.confidence * prefetcher_accuracy(x.source); };
+  std::sort(std::begin(pf_candidates), std::end(pf_candidates), [score](const auto& x, const auto& y) {
+    return std::tuple{-score(x), x.source, x.address} < std::tuple{-score(y), y.source, y.address};
+  });
+
+  const auto block_of = [offset = OFFSET_BITS](uint64_t address) { return address >> offset; };
+  auto drop = [this](const prefetch_candidate& x) {
+    if (x.source < std::size(this->pf_dropped_candidates))
+      this->pf_dropped_candidates[x.source].push_back(x.address);
+  };
+  for (auto it = std::begin(pf_candidates); it != std::end(pf_candidates); ++it) {
+    auto same_block = [block = block_of(it->address), block_of](const prefetch_candidate& x) { return block_of(x.address) == block; };
+    auto queued = [block = block_of(it->address), block_of, this](const tag_lookup_type& x) {
+      return x.prefetch_from_this && block_of(this->virtual_prefetch ? x.v_address : x.address) == block;
+    };
+
+    // A block that a better-ranked candidate requested, or that is already queued, is not requested again. It is dropped only if the better-ranked
+    // candidate was.
+    auto better = std::find_if(std::begin(pf_candidates), it, same_block);
+    if (better != it || std::any_of(std::begin(internal_PQ), std::end(internal_PQ), queued)) {
+      ++sim_stats.pf_duplicates;
+      if (better != it && !better->issued)
+        drop(*it);
+      continue;
+    }
+
+    if (std::size(internal_PQ) >= PQ_SIZE) {
+      ++sim_stats.pf_outranked;
+      drop(*it);
+      continue;
+    }
+
+    // The block fills this level if any of the prefetchers that requested it wanted it to
+    const bool fill_this_level = std::any_of(it, std::end(pf_candidates), [same_block](const auto& x) { return same_block(x) && x.fill_this_level; });
+    it->issued = issue_prefetch(it->address, fill_this_level, it->metadata, it->source, it->confidence);
+    if (!it->issued)
+      drop(*it);
+  }
+
+  pf_candidates.clear();
+}
+
+double CACHE::prefetcher_accuracy(unsigned source) const
+{
+  if (source >= std::size(sim_stats.prefetchers))
+    return 0.5;
+  const auto& stats = sim_stats.prefetchers[source];
+  return (static_cast<double>(stats.useful) + 1) / (static_cast<double>(stats.useful + stats.useless) + 2);
+}
+
+unsigned CACHE::prefetch_throttle_level() const { return (throttle != nullptr) ? throttle->level() : champsim::prefetch_throttle::middle_level; }
+
+champsim::cache_hints* CACHE::lower_hints() const { return (lower_cache != nullptr) ? &lower_cache->hints : nullptr; }
+
+champsim::prefetch_feedback CACHE::throttle_feedback() const
+{
+  champsim::prefetch_feedback retval;
+  retval.issued = sim_stats.pf_issued;
+  retval.useful = sim_stats.pf_useful;
+  retval.late = sim_stats.pf_late;
+  retval.pollution = sim_stats.pf_pollution;
+  for (auto type : {access_type::LOAD, access_type::RFO, access_type::TRANSLATION}) {
+    const auto& misses = sim_stats.misses.at(champsim::to_underlying(type));
+    retval.demand_misses += std::accumulate(std::begin(misses), std::end(misses), uint64_t{0});
+  }
+  if (throttle_memory != nullptr)
+    std::tie(retval.bus_busy, retval.bus_cycles) = throttle_memory->bus_usage();
+  return retval;
+}
+
 // LCOV_EXCL_START exclude deprecated function
 int CACHE::prefetch_line(uint64_t, uint64_t, uint64_t pf_addr, bool fill_this_level, uint32_t prefetch_metadata)
 {
@@ -498,9 +1129,7 @@ int CACHE::prefetch_line(uint64_t, uint64_t, uint64_t pf_addr, bool fill_this_le
 void CACHE::finish_packet(const response_type& packet)
 {
   // check MSHR information
-  auto mshr_entry = std::find_if(std::begin(MSHR), std::end(MSHR),
-                                 [match = packet.address >> OFFSET_BITS, shamt = OFFSET_BITS](const auto& entry) { return (entry.address >> shamt) == match; });
-  auto first_unreturned = std::find_if(MSHR.begin(), MSHR.end(), [](auto x) { return x.event_cycle == std::numeric_limits<uint64_t>::max(); });
+  auto mshr_entry = find_mshr(packet.address);
 
   // sanity check
   if (mshr_entry == MSHR.end()) {
@@ -521,7 +1150,44 @@ void CACHE::finish_packet(const response_type& packet)
 
   // Order this entry after previously-returned entries, but before non-returned
   // entries
-  std::iter_swap(mshr_entry, first_unreturned);
+  auto first_unreturned = std::next(std::begin(MSHR), static_cast<long>(mshr_returned));
+  if (mshr_entry >= first_unreturned) {
+    swap_mshr(mshr_entry, first_unreturned);
+    ++mshr_returned;
+  }
+}
+
+auto CACHE::find_mshr(uint64_t address) -> champsim::ring_buffer<mshr_type>::iterator
+{
+  auto position = mshr_index.find(address >> OFFSET_BITS);
+  if (position == nullptr)
+    return std::end(MSHR);
+  return std::next(std::begin(MSHR), static_cast<long>(*position - mshr_base));
+}
+
+void CACHE::swap_mshr(champsim::ring_buffer<mshr_type>::iterator a, champsim::ring_buffer<mshr_type>::iterator b)
+{
+  if (a == b)
+    return;
+
+  std::iter_swap(a, b);
+  mshr_index.insert_or_assign(a->address >> OFFSET_BITS, mshr_base + static_cast<uint64_t>(std::distance(std::begin(MSHR), a)));
+  mshr_index.insert_or_assign(b->address >> OFFSET_BITS, mshr_base + static_cast<uint64_t>(std::distance(std::begin(MSHR), b)));
+}
+
+void CACHE::retire_mshr(champsim::ring_buffer<mshr_type>::const_iterator end)
+{
+  // Entries are only filled after they have returned, so the retired entries are a prefix of the returned ones
+  auto count = static_cast<std::size_t>(std::distance(std::cbegin(MSHR), end));
+  assert(count <= mshr_returned);
+
+  std::for_each(std::cbegin(MSHR), end, [this](const auto& entry) {
+    this->mshr_index.erase(entry.address >> this->OFFSET_BITS);
+    if (entry.prefetch_partition)
+      --this->pf_mshr_occupancy;
+  });
+  mshr_base += count;
+  mshr_returned -= count;
 }
 
 void CACHE::finish_translation(const response_type& packet)
@@ -662,7 +1328,8 @@ std::vector<double> occupancy_ratio_vec(std::vector<std::size_t> occ, std::vecto
 }
 } // namespace
 
-double CACHE::get_mshr_occupancy_ratio() const { return ::occupancy_ratio(get_mshr_occupancy(), get_mshr_size()); }
+// The MSHRs held apart for prefetches are not counted in the size, so the occupancy may exceed it
+double CACHE::get_mshr_occupancy_ratio() const { return std::min(1.0, ::occupancy_ratio(get_mshr_occupancy(), get_mshr_size())); }
 
 std::vector<double> CACHE::get_rq_occupancy_ratio() const { return ::occupancy_ratio_vec(get_rq_occupancy(), get_rq_size()); }
 
@@ -683,9 +1350,22 @@ void CACHE::begin_phase()
   new_roi_stats.name = NAME;
   new_sim_stats.name = NAME;
 
+  if (NUM_BANKS > 1) {
+    new_roi_stats.bank_accesses.resize(NUM_BANKS);
+    new_sim_stats.bank_accesses.resize(NUM_BANKS);
+  }
+
+  for (const auto& name : prefetcher_names) {
+    new_roi_stats.prefetchers.push_back({name});
+    new_sim_stats.prefetchers.push_back({name});
+  }
+
   roi_stats = new_roi_stats;
   sim_stats = new_sim_stats;
 
+  if (throttle != nullptr)
+    throttle->restart(throttle_feedback());
+
   for (auto ul : upper_levels) {
     channel_type::stats_type ul_new_roi_stats, ul_new_sim_stats;
     ul->roi_stats = ul_new_roi_stats;
@@ -715,6 +1395,34 @@ void CACHE::end_phase(unsigned finished_cpu)
   roi_stats.pf_useful = sim_stats.pf_useful;
   roi_stats.pf_useless = sim_stats.pf_useless;
   roi_stats.pf_fill = sim_stats.pf_fill;
+  roi_stats.pf_dropped = sim_stats.pf_dropped;
+  roi_stats.pf_late = sim_stats.pf_late;
+  roi_stats.pf_late_cycles = sim_stats.pf_late_cycles;
+  roi_stats.pf_early = sim_stats.pf_early;
+  roi_stats.pf_early_cycles = sim_stats.pf_early_cycles;
+  roi_stats.pf_useless_cycles = sim_stats.pf_useless_cycles;
+  roi_stats.pf_pollution = sim_stats.pf_pollution;
+  roi_stats.pf_throttled = sim_stats.pf_throttled;
+  roi_stats.pf_suppressed = sim_stats.pf_suppressed;
+  roi_stats.throttle_level_sum = sim_stats.throttle_level_sum;
+  roi_stats.throttle_intervals = sim_stats.throttle_intervals;
+  roi_stats.prefetchers = sim_stats.prefetchers;
+  roi_stats.pf_duplicates = sim_stats.pf_duplicates;
+  roi_stats.pf_outranked = sim_stats.pf_outranked;
+  roi_stats.dependency_list_allocations = sim_stats.dependency_list_allocations;
+  roi_stats.sector_miss = sim_stats.sector_miss;
+  roi_stats.subblock_miss = sim_stats.subblock_miss;
+  roi_stats.bank_accesses = sim_stats.bank_accesses;
+  roi_stats.bank_conflicts = sim_stats.bank_conflicts;
+  roi_stats.cycles = sim_stats.cycles;
+  roi_stats.back_invalidations = sim_stats.back_invalidations;
+  roi_stats.victim_inserts = sim_stats.victim_inserts;
+  roi_stats.way_allocations = sim_stats.way_allocations;
+  roi_stats.victim_hits = sim_stats.victim_hits;
+  roi_stats.victim_misses = sim_stats.victim_misses;
+  roi_stats.victim_swaps = sim_stats.victim_swaps;
+  roi_stats.bytes_written = sim_stats.bytes_written;
+  roi_stats.write_arounds = sim_stats.write_arounds;
 
   for (auto ul : upper_levels) {
     ul->roi_stats.RQ_ACCESS = ul->sim_stats.RQ_ACCESS;
@@ -771,3 +1479,8 @@ void CACHE::print_deadlock()
   }
 }
 // LCOV_EXCL_STOP
+
+template long CACHE::operate_with<champsim::dynamic_geometry, CACHE::module_concept>();
+
+// Specializations for the geometries and modules of the configured caches
+#include "cache_operate_inst.inc"
@@ -0,0 +1,57 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "cache_hints.h"
+
+#include <algorithm>
+
+void champsim::cache_hints::predict_ip(uint64_t ip, reuse_prediction prediction) { ip_predictions.fill({ip, prediction}); }
+
+void champsim::cache_hints::predict_region(uint64_t address, reuse_prediction prediction)
+{
+  region_predictions.fill({address >> LOG2_REGION_SIZE, prediction});
+}
+
+void champsim::cache_hints::publish_occupancy(double fraction) { published_occupancy = std::clamp(fraction, 0.0, 1.0); }
+
+champsim::reuse_prediction champsim::cache_hints::ip_reuse(uint64_t ip)
+{
+  auto found = ip_predictions.check_hit({ip});
+  return found.has_value() ? found->prediction : reuse_prediction::unknown;
+}
+
+champsim::reuse_prediction champsim::cache_hints::region_reuse(uint64_t address)
+{
+  auto found = region_predictions.check_hit({address >> LOG2_REGION_SIZE});
+  return found.has_value() ? found->prediction : reuse_prediction::unknown;
+}
+
+std::optional<double> champsim::cache_hints::occupancy() const { return published_occupancy; }
+
+void champsim::cache_hints::publish_confidence(uint64_t address, double confidence)
+{
+  prefetch_confidences.fill({address >> LOG2_BLOCK_SIZE, std::clamp(confidence, 0.0, 1.0)});
+}
+
+std::optional<double> champsim::cache_hints::prefetch_confidence(uint64_t address)
+{
+  auto found = prefetch_confidences.check_hit({address >> LOG2_BLOCK_SIZE});
+  if (!found.has_value())
+    return std::nullopt;
+  return found->confidence;
+}
+
+bool champsim::cache_hints::low_confidence_prefetch(uint64_t address) { return prefetch_confidence(address).value_or(1.0) < low_confidence; }
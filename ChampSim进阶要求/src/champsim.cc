@@ -123,6 +123,12 @@ phase_stats do_phase(phase_info phase, environment& env, std::vector<tracereader
   std::transform(std::begin(caches), std::end(caches), std::back_inserter(stats.sim_cache_stats), [](const CACHE& cache) { return cache.sim_stats; });
   std::transform(std::begin(caches), std::end(caches), std::back_inserter(stats.roi_cache_stats), [](const CACHE& cache) { return cache.roi_stats; });
 
+  auto dram_caches = env.dram_cache_view();
+  std::transform(std::begin(dram_caches), std::end(dram_caches), std::back_inserter(stats.sim_dram_cache_stats),
+                 [](const DRAM_CACHE& cache) { return cache.sim_stats; });
+  std::transform(std::begin(dram_caches), std::end(dram_caches), std::back_inserter(stats.roi_dram_cache_stats),
+                 [](const DRAM_CACHE& cache) { return cache.roi_stats; });
+
   auto dram = env.dram_view();
   std::transform(std::begin(dram.channels), std::end(dram.channels), std::back_inserter(stats.sim_dram_stats),
                  [](const DRAM_CHANNEL& chan) { return chan.sim_stats; });
@@ -16,6 +16,7 @@
 
 #include "channel.h"
 
+#include <algorithm>
 #include <cassert>
 
 #include "cache.h"
@@ -26,89 +27,126 @@
 champsim::channel::channel(std::size_t rq_size, std::size_t pq_size, std::size_t wq_size, unsigned offset_bits, bool match_offset)
     : RQ_SIZE(rq_size), PQ_SIZE(pq_size), WQ_SIZE(wq_size), OFFSET_BITS(offset_bits), match_offset_bits(match_offset)
 {
+  // Unbounded queues start empty and grow to their high-water mark
+  auto bounded = [](std::size_t size) { return size < std::numeric_limits<std::size_t>::max() ? size : 0; };
+  RQ.reserve(bounded(RQ_SIZE));
+  PQ.reserve(bounded(PQ_SIZE));
+  WQ.reserve(bounded(WQ_SIZE));
+  rq_index = open_address_map<std::size_t>{bounded(RQ_SIZE)};
+  pq_index = open_address_map<std::size_t>{bounded(PQ_SIZE)};
+  wq_index = open_address_map<std::size_t>{bounded(WQ_SIZE)};
 }
 
-template <typename Iter, typename F>
-bool do_collision_for(Iter begin, Iter end, champsim::channel::request_type& packet, unsigned shamt, F&& func)
+namespace
 {
-  // We make sure that both merge packet address have been translated. If
-  // not this can happen: package with address virtual and physical X
-  // (not translated) is inserted, package with physical address
-  // (already translated) X.
-  if (auto found = std::find_if(begin, end, [addr = packet.address, shamt](const auto& x) { return (x.address >> shamt) == (addr >> shamt); });
-      found != end && packet.is_translated == found->is_translated) {
-    func(packet, *found);
-    return true;
+template <typename R>
+bool has_unchecked(const R& queue)
+{
+  return std::any_of(std::begin(queue), std::end(queue), [](const auto& x) { return !x.forward_checked; });
+}
+
+/**
+ * Offer each entry of the queue that has not yet been checked, along with the earliest surviving entry before it that has the same address
+ * (or nullptr), to the given function. Entries for which the function returns true are removed.
+ *
+ * Earlier entries are found through a map from shifted address to position, so each call is linear in the size of the queue. The queue is
+ * compacted in the same pass, so no entries are erased from the middle of it. On return, the map describes the compacted queue.
+ */
+template <typename R, typename F>
+void check_queue(R& queue, unsigned shamt, champsim::open_address_map<std::size_t>& index, F&& func)
+{
+  // Unbounded queues grow the map to their high-water mark
+  if (index.capacity() < std::size(queue))
+    index = champsim::open_address_map<std::size_t>{std::size(queue)};
+  index.clear();
+
+  bool checking = false;
+  auto write_it = std::begin(queue);
+  for (auto read_it = std::begin(queue); read_it != std::end(queue); ++read_it) {
+    const auto key = read_it->address >> shamt;
+    auto* found = index.find(key);
+
+    checking = checking || !read_it->forward_checked;
+    if (checking) {
+      if (func(*read_it, (found == nullptr) ? nullptr : &queue[*found]))
+        continue;
+      read_it->forward_checked = true;
+    }
+
+    if (found == nullptr)
+      index.insert_or_assign(key, static_cast<std::size_t>(std::distance(std::begin(queue), write_it)));
+    if (write_it != read_it)
+      *write_it = std::move(*read_it);
+    ++write_it;
   }
 
-  return false;
+  queue.erase(write_it, std::end(queue));
 }
 
-template <typename Iter>
-bool do_collision_for_merge(Iter begin, Iter end, champsim::channel::request_type& packet, unsigned shamt)
+// We make sure that both merge packet address have been translated. If
+// not this can happen: package with address virtual and physical X
+// (not translated) is inserted, package with physical address
+// (already translated) X.
+bool can_collide(const champsim::channel::request_type& packet, const champsim::channel::request_type* found)
 {
-  return do_collision_for(begin, end, packet, shamt, [](champsim::channel::request_type& source, champsim::channel::request_type& destination) {
-    destination.response_requested |= source.response_requested;
-    auto instr_copy = std::move(destination.instr_depend_on_me);
-
-    std::set_union(std::begin(instr_copy), std::end(instr_copy), std::begin(source.instr_depend_on_me), std::end(source.instr_depend_on_me),
-                   std::back_inserter(destination.instr_depend_on_me), ooo_model_instr::program_order);
-  });
+  return found != nullptr && packet.is_translated == found->is_translated;
 }
 
-template <typename Iter>
-bool do_collision_for_return(Iter begin, Iter end, champsim::channel::request_type& packet, unsigned shamt,
-                             std::deque<champsim::channel::response_type>& returned)
+void merge_packets(champsim::channel::request_type& source, champsim::channel::request_type& destination)
 {
-  return do_collision_for(begin, end, packet, shamt, [&](champsim::channel::request_type& source, champsim::channel::request_type& destination) {
-    if (source.response_requested)
-      returned.emplace_back(source.address, source.v_address, destination.data, destination.pf_metadata, source.instr_depend_on_me);
-  });
+  destination.response_requested |= source.response_requested;
+  destination.instr_depend_on_me = champsim::merge_sorted(destination.instr_depend_on_me, source.instr_depend_on_me, ooo_model_instr::program_order);
 }
+} // namespace
 
 void champsim::channel::check_collision()
 {
   auto write_shamt = match_offset_bits ? 0 : OFFSET_BITS;
   auto read_shamt = OFFSET_BITS;
 
-  // Check WQ for duplicates, merging if they are found
-  for (auto wq_it = std::find_if(std::begin(WQ), std::end(WQ), std::not_fn(&request_type::forward_checked)); wq_it != std::end(WQ);) {
-    if (do_collision_for_merge(std::begin(WQ), wq_it, *wq_it, write_shamt)) {
-      sim_stats.WQ_MERGED++;
-      wq_it = WQ.erase(wq_it);
-    } else {
-      wq_it->forward_checked = true;
-      ++wq_it;
-    }
-  }
+  // Entries stay checked until they leave their queue, so most cycles have nothing to do
+  const bool check_rq = has_unchecked(RQ);
+  const bool check_pq = has_unchecked(PQ);
+  if (!check_rq && !check_pq && !has_unchecked(WQ))
+    return;
 
-  // Check RQ for forwarding from WQ (return if found), then for duplicates (merge if found)
-  for (auto rq_it = std::find_if(std::begin(RQ), std::end(RQ), std::not_fn(&request_type::forward_checked)); rq_it != std::end(RQ);) {
-    if (do_collision_for_return(std::begin(WQ), std::end(WQ), *rq_it, write_shamt, returned)) {
-      sim_stats.WQ_FORWARD++;
-      rq_it = RQ.erase(rq_it);
-    } else if (do_collision_for_merge(std::begin(RQ), rq_it, *rq_it, read_shamt)) {
-      sim_stats.RQ_MERGED++;
-      rq_it = RQ.erase(rq_it);
-    } else {
-      rq_it->forward_checked = true;
-      ++rq_it;
-    }
-  }
+  // Check WQ for duplicates, merging if they are found. Its map is rebuilt even if it has nothing to check, since reads are forwarded from it.
+  check_queue(WQ, write_shamt, wq_index, [this](request_type& packet, request_type* found) {
+    if (!can_collide(packet, found))
+      return false;
 
-  // Check PQ for forwarding from WQ (return if found), then for duplicates (merge if found)
-  for (auto pq_it = std::find_if(std::begin(PQ), std::end(PQ), std::not_fn(&request_type::forward_checked)); pq_it != std::end(PQ);) {
-    if (do_collision_for_return(std::begin(WQ), std::end(WQ), *pq_it, write_shamt, returned)) {
-      sim_stats.WQ_FORWARD++;
-      pq_it = PQ.erase(pq_it);
-    } else if (do_collision_for_merge(std::begin(PQ), pq_it, *pq_it, read_shamt)) {
-      sim_stats.PQ_MERGED++;
-      pq_it = PQ.erase(pq_it);
-    } else {
-      pq_it->forward_checked = true;
-      ++pq_it;
-    }
-  }
+    merge_packets(packet, *found);
+    this->sim_stats.WQ_MERGED++;
+    return true;
+  });
+
+  // Check RQ and PQ for forwarding from WQ (return if found), then for duplicates (merge if found)
+  auto forward_or_merge = [this, write_shamt](uint64_t& merged_stat) {
+    return [this, write_shamt, &merged_stat](request_type& packet, request_type* found) {
+      auto* wq_found = this->wq_index.find(packet.address >> write_shamt);
+      if (wq_found != nullptr && can_collide(packet, &this->WQ[*wq_found])) {
+        if (packet.response_requested) {
+          const auto& wq_entry = this->WQ[*wq_found];
+          this->returned.emplace_back(packet.address, packet.v_address, wq_entry.data, wq_entry.pf_metadata, packet.instr_depend_on_me);
+        }
+        this->sim_stats.WQ_FORWARD++;
+        return true;
+      }
+
+      if (can_collide(packet, found)) {
+        merge_packets(packet, *found);
+        merged_stat++;
+        return true;
+      }
+
+      return false;
+    };
+  };
+
+  if (check_rq)
+    check_queue(RQ, read_shamt, rq_index, forward_or_merge(sim_stats.RQ_MERGED));
+  if (check_pq)
+    check_queue(PQ, read_shamt, pq_index, forward_or_merge(sim_stats.PQ_MERGED));
 }
 
 template <typename R>
@@ -180,6 +218,14 @@ bool champsim::channel::add_pq(const request_type& packet)
   return result;
 }
 
+auto champsim::channel::return_to_this() -> const pooled_list<ring_buffer<response_type>*>&
+{
+  // Rebuilt if this channel has been copied, so that it never directs responses to the original
+  if (std::empty(return_list) || return_list.front() != &returned)
+    return_list = {&returned};
+  return return_list;
+}
+
 std::size_t champsim::channel::rq_occupancy() const { return std::size(RQ); }
 
 std::size_t champsim::channel::wq_occupancy() const { return std::size(WQ); }
@@ -0,0 +1,337 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "dram_cache.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <stdexcept>
+
+#include "champsim_constants.h"
+#include "deadlock.h"
+#include "dram_controller.h"
+#include "util/bits.h"
+#include <fmt/core.h>
+
+DRAM_CACHE::DRAM_CACHE(Builder b)
+    : champsim::operable(b.m_freq_scale), upper_levels(std::move(b.m_uls)), lower_level(b.m_ll), block_tags(std::size_t{b.m_sets} * b.m_ways),
+      block_valid(std::size_t{b.m_sets} * b.m_ways), block_dirty(std::size_t{b.m_sets} * b.m_ways), block_last_use(std::size_t{b.m_sets} * b.m_ways),
+      block_data(std::size_t{b.m_sets} * b.m_ways), tag_cache(b.m_tag_cache_sets, std::numeric_limits<uint64_t>::max()), banks(b.m_banks), NAME(b.m_name),
+      NUM_SET(b.m_sets), NUM_WAY(b.m_ways), NUM_BANK(b.m_banks), NUM_COLUMN(b.m_columns), QUEUE_SIZE(b.m_queue_size), MSHR_SIZE(b.m_mshr_size),
+      TAGS(b.m_tags), TAG_LATENCY(b.m_tag_latency), tRP(cycles(b.m_t_rp / 1000, b.m_io_freq)), tRCD(cycles(b.m_t_rcd / 1000, b.m_io_freq)),
+      tCAS(cycles(b.m_t_cas / 1000, b.m_io_freq)), DBUS_RETURN_TIME(cycles(std::ceil(BLOCK_SIZE) / std::ceil(b.m_channel_width), 1))
+{
+  if (NUM_SET == 0 || (NUM_SET & (NUM_SET - 1)) != 0)
+    throw std::invalid_argument{"The number of sets in " + NAME + " must be a power of two"};
+  if (NUM_WAY == 0 || NUM_BANK == 0 || NUM_COLUMN % NUM_WAY != 0)
+    throw std::invalid_argument{"Each row of " + NAME + " must hold a whole number of sets"};
+  if (TAGS == champsim::dram_cache_tags::tag_cache && std::empty(tag_cache))
+    throw std::invalid_argument{"The tag cache of " + NAME + " must hold at least one set"};
+
+  inflight.reserve(QUEUE_SIZE);
+  writebacks.reserve(MSHR_SIZE);
+}
+
+std::size_t DRAM_CACHE::get_set(uint64_t address) const { return static_cast<std::size_t>((address >> LOG2_BLOCK_SIZE) & champsim::bitmask(champsim::lg2(NUM_SET))); }
+
+std::size_t DRAM_CACHE::find_way(std::size_t set, uint64_t address) const
+{
+  for (std::size_t way = 0; way < NUM_WAY; ++way) {
+    const auto index = set * NUM_WAY + way;
+    if (block_valid[index] && block_tags[index] == (address >> LOG2_BLOCK_SIZE))
+      return way;
+  }
+  return NUM_WAY;
+}
+
+uint64_t DRAM_CACHE::access_dram(std::size_t set)
+{
+  if (warmup)
+    return current_cycle;
+
+  // The sets are laid out across the columns of a row, then across the banks, then down the rows
+  const auto first_block = set * NUM_WAY;
+  auto& bank = banks[(first_block / NUM_COLUMN) % NUM_BANK];
+  const auto row = first_block / (std::size_t{NUM_COLUMN} * NUM_BANK);
+
+  const bool row_buffer_hit = (bank.open_row == row);
+  if (row_buffer_hit)
+    ++sim_stats.row_buffer_hits;
+  else
+    ++sim_stats.row_buffer_misses;
+
+  bank.open_row = row;
+  bank.ready_cycle = std::max(current_cycle, bank.ready_cycle) + tCAS + (row_buffer_hit ? 0 : tRP + tRCD);
+  dbus_cycle_available = std::max(bank.ready_cycle, dbus_cycle_available) + DBUS_RETURN_TIME;
+
+  return dbus_cycle_available;
+}
+
+bool DRAM_CACHE::lookup_tag_cache(std::size_t set)
+{
+  if (TAGS != champsim::dram_cache_tags::tag_cache)
+    return false;
+
+  auto& entry = tag_cache[set % std::size(tag_cache)];
+  if (entry == set) {
+    ++sim_stats.tag_cache_hits;
+    return true;
+  }
+
+  ++sim_stats.tag_cache_misses;
+  entry = set;
+  return false;
+}
+
+bool DRAM_CACHE::can_install() const { return std::size(writebacks) < MSHR_SIZE; }
+
+void DRAM_CACHE::install(uint64_t address, uint64_t data, bool dirty)
+{
+  assert(can_install());
+
+  const auto set = get_set(address);
+  auto way = find_way(set, address);
+  if (way == NUM_WAY) {
+    const auto set_begin = std::next(std::begin(block_valid), static_cast<long>(set * NUM_WAY));
+    way = static_cast<std::size_t>(std::distance(set_begin, std::find(set_begin, std::next(set_begin, NUM_WAY), false)));
+  }
+  if (way == NUM_WAY) {
+    const auto set_begin = std::next(std::begin(block_last_use), static_cast<long>(set * NUM_WAY));
+    way = static_cast<std::size_t>(std::distance(set_begin, std::min_element(set_begin, std::next(set_begin, NUM_WAY))));
+  }
+
+  const auto index = set * NUM_WAY + way;
+  if (block_valid[index] && block_dirty[index] && block_tags[index] != (address >> LOG2_BLOCK_SIZE)) {
+    request_type writeback_packet;
+    writeback_packet.address = block_tags[index] << LOG2_BLOCK_SIZE;
+    writeback_packet.v_address = 0;
+    writeback_packet.data = block_data[index];
+    writeback_packet.type = access_type::WRITE;
+    writeback_packet.response_requested = false;
+    writebacks.push_back(writeback_packet);
+    ++sim_stats.writebacks;
+  }
+
+  block_dirty[index] = (block_valid[index] && block_dirty[index] && block_tags[index] == (address >> LOG2_BLOCK_SIZE)) || dirty;
+  block_tags[index] = address >> LOG2_BLOCK_SIZE;
+  block_valid[index] = true;
+  block_last_use[index] = current_cycle;
+  block_data[index] = data;
+}
+
+void DRAM_CACHE::respond(const request_entry& entry, uint64_t data)
+{
+  if (entry.pkt.response_requested) {
+    response_type response{entry.pkt.address, entry.pkt.v_address, data, entry.pkt.pf_metadata, entry.pkt.instr_depend_on_me};
+    entry.ul->returned.push_back(response);
+  }
+}
+
+long DRAM_CACHE::receive_requests()
+{
+  long received = 0;
+  for (auto ul : upper_levels) {
+    ul->check_collision();
+
+    for (auto queue : {&ul->WQ, &ul->RQ, &ul->PQ}) {
+      auto taken = std::begin(*queue);
+      for (; taken != std::end(*queue) && std::size(inflight) < QUEUE_SIZE; ++taken) {
+        const auto set = get_set(taken->address);
+        request_entry entry{*taken, ul, stage::tag_check, false, 0, current_cycle};
+
+        if (lookup_tag_cache(set)) {
+          entry.event_cycle = current_cycle + (warmup ? 0 : TAG_LATENCY);
+        } else {
+          // With one way, the tag is stored with its block, so the data is read along with it
+          entry.event_cycle = access_dram(set);
+          entry.data_ready = (NUM_WAY == 1);
+        }
+
+        inflight.push_back(entry);
+      }
+
+      received += std::distance(std::begin(*queue), taken);
+      queue->erase(std::begin(*queue), taken);
+    }
+  }
+
+  return received;
+}
+
+long DRAM_CACHE::check_tags()
+{
+  long checked = 0;
+  auto outstanding_misses = static_cast<std::size_t>(std::count_if(std::begin(inflight), std::end(inflight), [](const auto& x) { return x.step == stage::miss; }));
+
+  for (auto& entry : inflight) {
+    if (entry.step != stage::tag_check || entry.event_cycle > current_cycle)
+      continue;
+
+    const auto set = get_set(entry.pkt.address);
+    const auto way = find_way(set, entry.pkt.address);
+    const auto index = set * NUM_WAY + way;
+
+    if (entry.pkt.type == access_type::WRITE) {
+      // A write that cannot be installed is checked again on the next cycle
+      if (!can_install())
+        continue;
+
+      // Writes carry whole blocks, so a missing block is allocated without reading it from the lower level
+      if (way < NUM_WAY)
+        ++sim_stats.write_hits;
+      else
+        ++sim_stats.write_misses;
+      install(entry.pkt.address, entry.pkt.data, true);
+      access_dram(set);
+      entry.step = stage::complete;
+    } else if (way < NUM_WAY) {
+      ++sim_stats.read_hits;
+      block_last_use[index] = current_cycle;
+      if (entry.data_ready) {
+        respond(entry, block_data[index]);
+        entry.step = stage::complete;
+      } else {
+        entry.step = stage::data_read;
+        entry.event_cycle = access_dram(set);
+      }
+    } else {
+      auto same_block = [block = entry.pkt.address >> LOG2_BLOCK_SIZE](const auto& other) {
+        return other.step == stage::miss && (other.pkt.address >> LOG2_BLOCK_SIZE) == block;
+      };
+      bool sent = std::any_of(std::begin(inflight), std::end(inflight), same_block);
+      if (!sent && outstanding_misses < MSHR_SIZE) {
+        request_type fwd_pkt = entry.pkt;
+        fwd_pkt.response_requested = true;
+        sent = (entry.pkt.type == access_type::PREFETCH) ? lower_level->add_pq(fwd_pkt) : lower_level->add_rq(fwd_pkt);
+        if (sent)
+          ++outstanding_misses;
+      }
+
+      // A miss that cannot be sent is checked again on the next cycle
+      if (!sent)
+        continue;
+
+      ++sim_stats.read_misses;
+      entry.step = stage::miss;
+    }
+
+    ++checked;
+  }
+
+  return checked;
+}
+
+long DRAM_CACHE::finish_reads()
+{
+  long finished = 0;
+  for (auto& entry : inflight) {
+    if (entry.step == stage::data_read && entry.event_cycle <= current_cycle) {
+      const auto set = get_set(entry.pkt.address);
+      const auto way = find_way(set, entry.pkt.address);
+      respond(entry, (way < NUM_WAY) ? block_data[set * NUM_WAY + way] : entry.pkt.data);
+      entry.step = stage::complete;
+      ++finished;
+    }
+  }
+
+  return finished;
+}
+
+long DRAM_CACHE::finish_misses()
+{
+  // Responses that cannot be installed wait in the lower level's queue
+  auto finished_end = std::begin(lower_level->returned);
+  for (; finished_end != std::end(lower_level->returned) && can_install(); ++finished_end) {
+    const auto& response = *finished_end;
+    const auto set = get_set(response.address);
+    const auto way = find_way(set, response.address);
+
+    // A write installed while the miss was outstanding is newer than the lower level's copy, so the fill is dropped
+    auto data = response.data;
+    if (way < NUM_WAY && block_dirty[set * NUM_WAY + way]) {
+      data = block_data[set * NUM_WAY + way];
+    } else {
+      install(response.address, response.data, false);
+      access_dram(set);
+    }
+
+    for (auto& entry : inflight) {
+      if (entry.step == stage::miss && (entry.pkt.address >> LOG2_BLOCK_SIZE) == (response.address >> LOG2_BLOCK_SIZE)) {
+        respond(entry, data);
+        sim_stats.total_miss_latency += current_cycle - entry.cycle_enqueued;
+        entry.step = stage::complete;
+      }
+    }
+  }
+
+  const auto finished = std::distance(std::begin(lower_level->returned), finished_end);
+  lower_level->returned.erase(std::begin(lower_level->returned), finished_end);
+  return finished;
+}
+
+long DRAM_CACHE::send_writebacks()
+{
+  auto sent_end = std::find_if_not(std::begin(writebacks), std::end(writebacks), [this](const auto& pkt) { return this->lower_level->add_wq(pkt); });
+  const auto sent = std::distance(std::begin(writebacks), sent_end);
+  writebacks.erase(std::begin(writebacks), sent_end);
+  return sent;
+}
+
+long DRAM_CACHE::operate()
+{
+  long progress{0};
+
+  progress += send_writebacks();
+  progress += finish_misses();
+  progress += finish_reads();
+  progress += check_tags();
+  progress += receive_requests();
+
+  inflight.erase(std::remove_if(std::begin(inflight), std::end(inflight), [](const auto& x) { return x.step == stage::complete; }), std::end(inflight));
+
+  return progress;
+}
+
+void DRAM_CACHE::begin_phase()
+{
+  stats_type new_roi_stats, new_sim_stats;
+
+  new_roi_stats.name = NAME;
+  new_sim_stats.name = NAME;
+
+  roi_stats = new_roi_stats;
+  sim_stats = new_sim_stats;
+
+  for (auto ul : upper_levels) {
+    channel_type::stats_type ul_new_roi_stats, ul_new_sim_stats;
+    ul->roi_stats = ul_new_roi_stats;
+    ul->sim_stats = ul_new_sim_stats;
+  }
+}
+
+void DRAM_CACHE::end_phase(unsigned) { roi_stats = sim_stats; }
+
+// LCOV_EXCL_START exclude deadlock printing
+void DRAM_CACHE::print_deadlock()
+{
+  champsim::range_print_deadlock(inflight, NAME + "_inflight", "address: {:#x} v_addr: {:#x} stage: {} event_cycle: {}", [](const auto& entry) {
+    return std::tuple{entry.pkt.address, entry.pkt.v_address, champsim::to_underlying(entry.step), entry.event_cycle};
+  });
+  champsim::range_print_deadlock(writebacks, NAME + "_writebacks", "address: {:#x} v_addr: {:#x}",
+                                 [](const auto& pkt) { return std::tuple{pkt.address, pkt.v_address}; });
+}
+// LCOV_EXCL_STOP
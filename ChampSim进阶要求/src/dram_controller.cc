@@ -19,6 +19,7 @@
 #include <algorithm>
 #include <cfenv>
 #include <cmath>
+#include <numeric>
 
 #include "champsim_constants.h"
 #include "deadlock.h"
@@ -127,6 +128,7 @@ long MEMORY_CONTROLLER::operate()
         // Put this request on the data bus
         channel.active_request = iter_next_process;
         channel.active_request->event_cycle = current_cycle + DRAM_DBUS_RETURN_TIME;
+        channel.dbus_busy_cycles += DRAM_DBUS_RETURN_TIME;
 
         if (iter_next_process->row_buffer_hit)
           if (channel.write_mode)
@@ -248,23 +250,15 @@ void DRAM_CHANNEL::check_collision()
 
         rq_it->reset();
       } else if (auto found = std::find_if(std::begin(RQ), rq_it, checker); found != rq_it) {
-        auto instr_copy = std::move(found->value().instr_depend_on_me);
-        auto ret_copy = std::move(found->value().to_return);
-
-        std::set_union(std::begin(instr_copy), std::end(instr_copy), std::begin(rq_it->value().instr_depend_on_me), std::end(rq_it->value().instr_depend_on_me),
-                       std::back_inserter(found->value().instr_depend_on_me), ooo_model_instr::program_order);
-        std::set_union(std::begin(ret_copy), std::end(ret_copy), std::begin(rq_it->value().to_return), std::end(rq_it->value().to_return),
-                       std::back_inserter(found->value().to_return));
+        found->value().instr_depend_on_me =
+            champsim::merge_sorted(found->value().instr_depend_on_me, rq_it->value().instr_depend_on_me, ooo_model_instr::program_order);
+        found->value().to_return = champsim::merge_sorted(found->value().to_return, rq_it->value().to_return);
 
         rq_it->reset();
       } else if (found = std::find_if(std::next(rq_it), std::end(RQ), checker); found != std::end(RQ)) {
-        auto instr_copy = std::move(found->value().instr_depend_on_me);
-        auto ret_copy = std::move(found->value().to_return);
-
-        std::set_union(std::begin(instr_copy), std::end(instr_copy), std::begin(rq_it->value().instr_depend_on_me), std::end(rq_it->value().instr_depend_on_me),
-                       std::back_inserter(found->value().instr_depend_on_me), ooo_model_instr::program_order);
-        std::set_union(std::begin(ret_copy), std::end(ret_copy), std::begin(rq_it->value().to_return), std::end(rq_it->value().to_return),
-                       std::back_inserter(found->value().to_return));
+        found->value().instr_depend_on_me =
+            champsim::merge_sorted(found->value().instr_depend_on_me, rq_it->value().instr_depend_on_me, ooo_model_instr::program_order);
+        found->value().to_return = champsim::merge_sorted(found->value().to_return, rq_it->value().to_return);
 
         rq_it->reset();
       } else {
@@ -307,7 +301,7 @@ bool MEMORY_CONTROLLER::add_rq(const request_type& packet, champsim::channel* ul
     rq_it->value().forward_checked = false;
     rq_it->value().event_cycle = current_cycle;
     if (packet.response_requested)
-      rq_it->value().to_return = {&ul->returned};
+      rq_it->value().to_return = ul->return_to_this();
 
     return true;
   }
@@ -370,6 +364,12 @@ uint32_t MEMORY_CONTROLLER::dram_get_row(uint64_t address)
 
 std::size_t MEMORY_CONTROLLER::size() const { return DRAM_CHANNELS * DRAM_RANKS * DRAM_BANKS * DRAM_ROWS * DRAM_COLUMNS * BLOCK_SIZE; }
 
+std::pair<uint64_t, uint64_t> MEMORY_CONTROLLER::bus_usage() const
+{
+  auto busy = std::accumulate(std::begin(channels), std::end(channels), uint64_t{0}, [](auto acc, const auto& chan) { return acc + chan.dbus_busy_cycles; });
+  return {busy, current_cycle * std::size(channels)};
+}
+
 // LCOV_EXCL_START Exclude the following function from LCOV
 void MEMORY_CONTROLLER::print_deadlock()
 {
@@ -15,7 +15,11 @@
  */
 
 #include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <numeric>
 #include <utility>
+#include <vector>
 
 #include "stats_printer.h"
 #include <nlohmann/json.hpp>
@@ -38,6 +42,8 @@ void to_json(nlohmann::json& j, const O3_CPU::stats_type stats)
                      {"cycles", stats.cycles()},
                      {"Avg ROB occupancy at mispredict", std::ceil(stats.total_rob_occupancy_at_branch_mispredict) / std::ceil(total_mispredictions)},
                      {"mispredict", mpki}};
+  if (stats.wc_stores > 0)
+    j.emplace("write-combining", nlohmann::json{{"stores", stats.wc_stores}, {"merged", stats.wc_merges}, {"writes", stats.wc_writes}});
 }
 
 void to_json(nlohmann::json& j, const CACHE::stats_type stats)
@@ -50,13 +56,86 @@ void to_json(nlohmann::json& j, const CACHE::stats_type stats)
   std::map<std::string, nlohmann::json> statsmap;
   statsmap.emplace("prefetch requested", stats.pf_requested);
   statsmap.emplace("prefetch issued", stats.pf_issued);
+  if (stats.pf_dropped > 0)
+    statsmap.emplace("prefetch dropped", stats.pf_dropped);
+  if (stats.pf_suppressed > 0)
+    statsmap.emplace("prefetch suppressed", stats.pf_suppressed);
+  if (stats.throttle_intervals > 0) {
+    statsmap.emplace("prefetch throttled", stats.pf_throttled);
+    statsmap.emplace("average throttle level", std::ceil(stats.throttle_level_sum) / std::ceil(stats.throttle_intervals));
+  }
+  if (std::size(stats.prefetchers) > 1) {
+    std::map<std::string, nlohmann::json> prefetchers{};
+    for (const auto& pref : stats.prefetchers)
+      prefetchers.emplace(pref.name, nlohmann::json{{"requested", pref.requested}, {"issued", pref.issued}, {"useful", pref.useful}, {"useless", pref.useless}});
+    statsmap.emplace("prefetchers", prefetchers);
+    statsmap.emplace("prefetch duplicates", stats.pf_duplicates);
+    statsmap.emplace("prefetch outranked", stats.pf_outranked);
+  }
+  if (stats.pf_late + stats.pf_early + stats.pf_useless + stats.pf_pollution > 0) {
+    statsmap.emplace("late prefetch", stats.pf_late);
+    statsmap.emplace("late prefetch remaining latency", std::ceil(stats.pf_late_cycles) / std::ceil(stats.pf_late));
+    statsmap.emplace("early prefetch", stats.pf_early);
+    statsmap.emplace("early prefetch distance", std::ceil(stats.pf_early_cycles) / std::ceil(stats.pf_early));
+    statsmap.emplace("useless prefetch lifetime", std::ceil(stats.pf_useless_cycles) / std::ceil(stats.pf_useless));
+    statsmap.emplace("prefetch pollution", stats.pf_pollution);
+  }
   statsmap.emplace("useful prefetch", stats.pf_useful);
   statsmap.emplace("useless prefetch", stats.pf_useless);
   statsmap.emplace("miss latency", stats.avg_miss_latency);
+  if (stats.sector_miss + stats.subblock_miss > 0) {
+    statsmap.emplace("sector miss", stats.sector_miss);
+    statsmap.emplace("sub-block miss", stats.subblock_miss);
+  }
+  if (stats.back_invalidations + stats.victim_inserts > 0) {
+    statsmap.emplace("back-invalidations", stats.back_invalidations);
+    statsmap.emplace("victim inserts", stats.victim_inserts);
+  }
+  if (stats.bytes_written > 0) {
+    statsmap.emplace("bytes written", stats.bytes_written);
+    statsmap.emplace("write-arounds", stats.write_arounds);
+  }
+  if (stats.victim_hits + stats.victim_misses > 0) {
+    statsmap.emplace("victim buffer hits", stats.victim_hits);
+    statsmap.emplace("victim buffer misses", stats.victim_misses);
+    statsmap.emplace("victim buffer swaps", stats.victim_swaps);
+  }
+  if (!std::empty(stats.bank_accesses)) {
+    std::vector<double> utilization{};
+    std::transform(std::begin(stats.bank_accesses), std::end(stats.bank_accesses), std::back_inserter(utilization),
+                   [cycles = stats.cycles](auto accesses) { return std::ceil(accesses) / std::ceil(cycles); });
+    statsmap.emplace("bank accesses", stats.bank_accesses);
+    statsmap.emplace("bank utilization", utilization);
+    statsmap.emplace("bank conflicts", stats.bank_conflicts);
+  }
+  if (!std::empty(stats.way_allocations)) {
+    std::vector<nlohmann::json> allocations{};
+    std::transform(std::begin(stats.way_allocations), std::end(stats.way_allocations), std::back_inserter(allocations),
+                   [](const auto& allocation) { return nlohmann::json{{"cycle", allocation.first}, {"ways", allocation.second}}; });
+    statsmap.emplace("way allocations", allocations);
+  }
+  uint64_t total_access = 0;
   for (const auto& type : types) {
     statsmap.emplace(type.first, nlohmann::json{{"hit", stats.hits[type.second]}, {"miss", stats.misses[type.second]}});
+    total_access = std::accumulate(std::begin(stats.hits[type.second]), std::end(stats.hits[type.second]), total_access);
+    total_access = std::accumulate(std::begin(stats.misses[type.second]), std::end(stats.misses[type.second]), total_access);
   }
+  statsmap.emplace("dependency list allocations per access", std::ceil(stats.dependency_list_allocations) / std::ceil(total_access));
+
+  j = statsmap;
+}
 
+void to_json(nlohmann::json& j, const DRAM_CACHE::stats_type stats)
+{
+  std::map<std::string, nlohmann::json> statsmap;
+  statsmap.emplace("READ", nlohmann::json{{"hit", stats.read_hits}, {"miss", stats.read_misses}});
+  statsmap.emplace("WRITE", nlohmann::json{{"hit", stats.write_hits}, {"miss", stats.write_misses}});
+  if (stats.tag_cache_hits + stats.tag_cache_misses > 0)
+    statsmap.emplace("tag cache", nlohmann::json{{"hit", stats.tag_cache_hits}, {"miss", stats.tag_cache_misses}});
+  statsmap.emplace("ROW_BUFFER_HIT", stats.row_buffer_hits);
+  statsmap.emplace("ROW_BUFFER_MISS", stats.row_buffer_misses);
+  statsmap.emplace("writebacks", stats.writebacks);
+  statsmap.emplace("miss latency", std::ceil(stats.total_miss_latency) / std::ceil(stats.read_misses));
   j = statsmap;
 }
 
@@ -78,12 +157,16 @@ void to_json(nlohmann::json& j, const champsim::phase_stats stats)
   roi_stats.emplace("DRAM", stats.roi_dram_stats);
   for (auto x : stats.roi_cache_stats)
     roi_stats.emplace(x.name, x);
+  for (auto x : stats.roi_dram_cache_stats)
+    roi_stats.emplace(x.name, x);
 
   std::map<std::string, nlohmann::json> sim_stats;
   sim_stats.emplace("cores", stats.sim_cpu_stats);
   sim_stats.emplace("DRAM", stats.sim_dram_stats);
   for (auto x : stats.sim_cache_stats)
     sim_stats.emplace(x.name, x);
+  for (auto x : stats.sim_dram_cache_stats)
+    sim_stats.emplace(x.name, x);
 
   std::map<std::string, nlohmann::json> statsmap{{"name", stats.name}, {"traces", stats.trace_names}};
   statsmap.emplace("roi", roi_stats);
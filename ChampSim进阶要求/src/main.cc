@@ -20,6 +20,7 @@
 #include <string>
 #include <vector>
 
+#include "access_replay.h"
 #include "champsim.h"
 #include "champsim_constants.h"
 #include "core_inst.inc"
@@ -46,6 +47,9 @@ int main(int argc, char** argv)
   uint64_t simulation_instructions = std::numeric_limits<uint64_t>::max();
   std::string json_file_name;
   std::vector<std::string> trace_names;
+  std::string replay_file_name;
+  std::string replay_cache_name{"LLC"};
+  bool knob_replay_recorded_fills{false};
 
   auto set_heartbeat_callback = [&](auto) {
     for (O3_CPU& cpu : gen_environment.cpu_view())
@@ -65,10 +69,51 @@ int main(int argc, char** argv)
   auto json_option =
       app.add_option("--json", json_file_name, "The name of the file to receive JSON output. If no name is specified, stdout will be used")->expected(0, 1);
 
-  app.add_option("traces", trace_names, "The paths to the traces")->required()->expected(NUM_CPUS)->check(CLI::ExistingFile);
+  auto replay_option = app.add_option("--replay-access-trace", replay_file_name,
+                                      "Replay a recorded cache access trace through the replacement policy of one cache, and compare it to the optimal policy")
+                           ->check(CLI::ExistingFile);
+  app.add_option("--replay-cache", replay_cache_name, "The name of the cache whose replacement policy is replayed")->needs(replay_option);
+  app.add_flag("--replay-recorded-fills", knob_replay_recorded_fills, "Allocate blocks only where the recorded cache filled them")->needs(replay_option);
+
+  auto traces_option = app.add_option("traces", trace_names, "The paths to the traces")->expected(NUM_CPUS)->check(CLI::ExistingFile)->excludes(replay_option);
 
   CLI11_PARSE(app, argc, argv);
 
+  if (replay_option->count() > 0) {
+    auto caches = gen_environment.cache_view();
+    auto replay_cache = std::find_if(std::begin(caches), std::end(caches), [&](const CACHE& c) { return c.NAME == replay_cache_name; });
+    if (replay_cache == std::end(caches)) {
+      fmt::print(stderr, "No cache named {} in this configuration\n", replay_cache_name);
+      return 1;
+    }
+
+    CACHE& cache = *replay_cache;
+    auto policy = knob_replay_recorded_fills ? champsim::replay_fill_policy::recorded_fills : champsim::replay_fill_policy::fill_on_miss;
+    auto recorded = champsim::read_access_trace(replay_file_name);
+    if (recorded.header.sets != cache.NUM_SET || recorded.header.ways != cache.NUM_WAY)
+      fmt::print("WARNING: {} was recorded from a cache with {} sets and {} ways, but {} has {} sets and {} ways.\n", replay_file_name, recorded.header.sets,
+                 recorded.header.ways, cache.NAME, cache.NUM_SET, cache.NUM_WAY);
+
+    for (const auto& stats : {champsim::replay_access_trace(cache, recorded.records, policy),
+                              champsim::replay_optimal(cache.NUM_SET, cache.NUM_WAY, cache.OFFSET_BITS, recorded.records, policy)}) {
+      for (std::size_t cpu = 0; cpu < NUM_CPUS; ++cpu) {
+        uint64_t total_hit = 0, total_miss = 0;
+        for (std::size_t type = 0; type < champsim::to_underlying(access_type::NUM_TYPES); ++type) {
+          total_hit += stats.hits[type][cpu];
+          total_miss += stats.misses[type][cpu];
+        }
+        fmt::print("{} cpu{} REPLAY ACCESS: {:10d} HIT: {:10d} MISS: {:10d} HIT RATE: {:.4g}%\n", stats.name, cpu, total_hit + total_miss, total_hit,
+                   total_miss, 100.0 * static_cast<double>(total_hit) / static_cast<double>(total_hit + total_miss));
+      }
+    }
+
+    cache.impl_replacement_final_stats();
+    return 0;
+  }
+
+  if (traces_option->count() == 0)
+    return app.exit(CLI::RequiredError{"traces"});
+
   const bool warmup_given = (warmup_instr_option->count() > 0) || (deprec_warmup_instr_option->count() > 0);
   const bool simulation_given = (sim_instr_option->count() > 0) || (deprec_sim_instr_option->count() > 0);
 
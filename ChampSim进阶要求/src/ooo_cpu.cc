@@ -32,8 +32,12 @@
 
 std::chrono::seconds elapsed_time();
 
-long O3_CPU::operate()
+long O3_CPU::operate() { return (this->*operate_impl)(); }
+
+template <typename M>
+long O3_CPU::operate_with()
 {
+  auto& modules = static_cast<M&>(*module_pimpl);
   long progress{0};
 
   progress += retire_rob();                    // retire
@@ -49,7 +53,7 @@ long O3_CPU::operate()
 
   progress += fetch_instruction(); // fetch
   progress += check_dib();
-  initialize_instruction();
+  initialize_instruction(modules);
 
   // heartbeat
   if (show_heartbeat && (num_retired >= next_print_instruction)) {
@@ -104,19 +108,22 @@ void O3_CPU::end_phase(unsigned finished_cpu)
   }
 }
 
-void O3_CPU::initialize_instruction()
+void O3_CPU::initialize_instruction() { initialize_instruction(*module_pimpl); }
+
+template <typename M>
+void O3_CPU::initialize_instruction(M& modules)
 {
   auto instrs_to_read_this_cycle = std::min(FETCH_WIDTH, static_cast<long>(IFETCH_BUFFER_SIZE - std::size(IFETCH_BUFFER)));
 
   while (current_cycle >= fetch_resume_cycle && instrs_to_read_this_cycle > 0 && !std::empty(input_queue)) {
     instrs_to_read_this_cycle--;
 
-    auto stop_fetch = do_init_instruction(input_queue.front());
+    auto stop_fetch = do_init_instruction(modules, input_queue.front());
     if (stop_fetch)
       instrs_to_read_this_cycle = 0;
 
     // Add to IFETCH_BUFFER
-    IFETCH_BUFFER.push_back(input_queue.front());
+    IFETCH_BUFFER.push_back(std::move(input_queue.front()));
     input_queue.pop_front();
 
     IFETCH_BUFFER.back().event_cycle = current_cycle;
@@ -145,14 +152,17 @@ void do_stack_pointer_folding(ooo_model_instr& arch_instr)
 }
 } // namespace
 
-bool O3_CPU::do_predict_branch(ooo_model_instr& arch_instr)
+bool O3_CPU::do_predict_branch(ooo_model_instr& arch_instr) { return do_predict_branch(*module_pimpl, arch_instr); }
+
+template <typename M>
+bool O3_CPU::do_predict_branch(M& modules, ooo_model_instr& arch_instr)
 {
   bool stop_fetch = false;
 
   // handle branch prediction for all instructions as at this point we do not know if the instruction is a branch
   sim_stats.total_branch_types[arch_instr.branch_type]++;
-  auto [predicted_branch_target, always_taken] = impl_btb_prediction(arch_instr.ip);
-  arch_instr.branch_prediction = impl_predict_branch(arch_instr.ip) || always_taken;
+  auto [predicted_branch_target, always_taken] = modules.impl_btb_prediction(arch_instr.ip);
+  arch_instr.branch_prediction = modules.impl_predict_branch(arch_instr.ip) || always_taken;
   if (arch_instr.branch_prediction == 0)
     predicted_branch_target = 0;
 
@@ -178,14 +188,17 @@ bool O3_CPU::do_predict_branch(ooo_model_instr& arch_instr)
       stop_fetch = arch_instr.branch_taken; // if correctly predicted taken, then we can't fetch anymore instructions this cycle
     }
 
-    impl_update_btb(arch_instr.ip, arch_instr.branch_target, arch_instr.branch_taken, arch_instr.branch_type);
-    impl_last_branch_result(arch_instr.ip, arch_instr.branch_target, arch_instr.branch_taken, arch_instr.branch_type);
+    modules.impl_update_btb(arch_instr.ip, arch_instr.branch_target, arch_instr.branch_taken, arch_instr.branch_type);
+    modules.impl_last_branch_result(arch_instr.ip, arch_instr.branch_target, arch_instr.branch_taken, arch_instr.branch_type);
   }
 
   return stop_fetch;
 }
 
-bool O3_CPU::do_init_instruction(ooo_model_instr& arch_instr)
+bool O3_CPU::do_init_instruction(ooo_model_instr& arch_instr) { return do_init_instruction(*module_pimpl, arch_instr); }
+
+template <typename M>
+bool O3_CPU::do_init_instruction(M& modules, ooo_model_instr& arch_instr)
 {
   // fast warmup eliminates register dependencies between instructions branch predictor, cache contents, and prefetchers are still warmed up
   if (warmup) {
@@ -194,7 +207,7 @@ bool O3_CPU::do_init_instruction(ooo_model_instr& arch_instr)
   }
 
   ::do_stack_pointer_folding(arch_instr);
-  return do_predict_branch(arch_instr);
+  return do_predict_branch(modules, arch_instr);
 }
 
 long O3_CPU::check_dib()
@@ -256,7 +269,7 @@ long O3_CPU::fetch_instruction()
   return progress;
 }
 
-bool O3_CPU::do_fetch_instruction(std::deque<ooo_model_instr>::iterator begin, std::deque<ooo_model_instr>::iterator end)
+bool O3_CPU::do_fetch_instruction(champsim::instruction_window::iterator begin, champsim::instruction_window::iterator end)
 {
   CacheBus::request_type fetch_packet;
   fetch_packet.v_address = begin->ip;
@@ -281,8 +294,7 @@ long O3_CPU::promote_to_decode()
 
   std::for_each(window_begin, window_end,
                 [cycle = current_cycle, lat = DECODE_LATENCY, warmup = warmup](auto& x) { return x.event_cycle = cycle + ((warmup || x.decoded) ? 0 : lat); });
-  std::move(window_begin, window_end, std::back_inserter(DECODE_BUFFER));
-  IFETCH_BUFFER.erase(window_begin, window_end);
+  IFETCH_BUFFER.advance(static_cast<std::size_t>(progress));
 
   return progress;
 }
@@ -314,8 +326,7 @@ long O3_CPU::decode_instruction()
     db_entry.event_cycle = this->current_cycle + (this->warmup ? 0 : this->DISPATCH_LATENCY);
   });
 
-  std::move(window_begin, window_end, std::back_inserter(DISPATCH_BUFFER));
-  DECODE_BUFFER.erase(window_begin, window_end);
+  DECODE_BUFFER.advance(static_cast<std::size_t>(progress));
 
   return progress;
 }
@@ -331,8 +342,7 @@ long O3_CPU::dispatch_instruction()
          && ((std::size_t)std::count_if(std::begin(LQ), std::end(LQ), [](const auto& lq_entry) { return !lq_entry.has_value(); })
              >= std::size(DISPATCH_BUFFER.front().source_memory))
          && ((std::size(DISPATCH_BUFFER.front().destination_memory) + std::size(SQ)) <= SQ_SIZE)) {
-    ROB.push_back(std::move(DISPATCH_BUFFER.front()));
-    DISPATCH_BUFFER.pop_front();
+    DISPATCH_BUFFER.advance(1);
     do_memory_scheduling(ROB.back());
 
     available_dispatch_bandwidth--;
@@ -341,18 +351,43 @@ long O3_CPU::dispatch_instruction()
   return DISPATCH_WIDTH - available_dispatch_bandwidth;
 }
 
+namespace
+{
+// Heaps of instructions whose top is the oldest
+bool younger(const ooo_model_instr* lhs, const ooo_model_instr* rhs) { return lhs->instr_id > rhs->instr_id; }
+
+void push_ready(std::vector<ooo_model_instr*>& heap, ooo_model_instr& instr)
+{
+  heap.push_back(&instr);
+  std::push_heap(std::begin(heap), std::end(heap), younger);
+}
+
+ooo_model_instr& pop_oldest(std::vector<ooo_model_instr*>& heap)
+{
+  std::pop_heap(std::begin(heap), std::end(heap), younger);
+  auto* retval = heap.back();
+  heap.pop_back();
+  return *retval;
+}
+} // namespace
+
 long O3_CPU::schedule_instruction()
 {
-  auto search_bw = SCHEDULER_SIZE;
+  // The scheduler holds the oldest instructions that have not executed. Since instructions are scheduled in program order, those that it has room
+  // for are the ones after the scheduled instructions at the head of the ROB.
+  auto search_bw = SCHEDULER_SIZE - scheduler_occupancy;
   int progress{0};
-  for (auto rob_it = std::begin(ROB); rob_it != std::end(ROB) && search_bw > 0; ++rob_it) {
+  for (auto rob_it = std::next(std::begin(ROB), static_cast<long>(num_scheduled)); rob_it != std::end(ROB) && search_bw > 0; ++rob_it) {
     if (rob_it->scheduled == 0) {
       do_scheduling(*rob_it);
       ++progress;
     }
+    ++num_scheduled;
 
-    if (rob_it->executed == 0)
+    if (rob_it->executed == 0) {
       --search_bw;
+      ++scheduler_occupancy;
+    }
   }
 
   return progress;
@@ -380,17 +415,26 @@ void O3_CPU::do_scheduling(ooo_model_instr& instr)
 
   instr.scheduled = COMPLETED;
   instr.event_cycle = current_cycle + (warmup ? 0 : SCHEDULING_LATENCY);
+
+  if (instr.num_reg_dependent == 0)
+    wake_execution(instr);
+}
+
+void O3_CPU::wake_execution(ooo_model_instr& instr)
+{
+  if (instr.event_cycle <= current_cycle)
+    push_ready(ready_to_execute, instr);
+  else
+    execute_wakeups.schedule(instr.event_cycle, &instr);
 }
 
 long O3_CPU::execute_instruction()
 {
+  execute_wakeups.advance(current_cycle, [this](ooo_model_instr* instr) { push_ready(this->ready_to_execute, *instr); });
+
   auto exec_bw = EXEC_WIDTH;
-  for (auto rob_it = std::begin(ROB); rob_it != std::end(ROB) && exec_bw > 0; ++rob_it) {
-    if (rob_it->scheduled == COMPLETED && rob_it->executed == 0 && rob_it->num_reg_dependent == 0 && rob_it->event_cycle <= current_cycle) {
-      do_execution(*rob_it);
-      --exec_bw;
-    }
-  }
+  for (; exec_bw > 0 && !std::empty(ready_to_execute); --exec_bw)
+    do_execution(pop_oldest(ready_to_execute));
 
   return EXEC_WIDTH - exec_bw;
 }
@@ -399,6 +443,8 @@ void O3_CPU::do_execution(ooo_model_instr& rob_entry)
 {
   rob_entry.executed = INFLIGHT;
   rob_entry.event_cycle = current_cycle + (warmup ? 0 : EXEC_LATENCY);
+  --scheduler_occupancy;
+  wake_completion(rob_entry);
 
   // Mark LQ entries as ready to translate
   for (auto& lq_entry : LQ)
@@ -474,6 +520,8 @@ long O3_CPU::operate_lsq()
     sq_entry.event_cycle = cycle;
   });
 
+  auto wc_progress = drain_wc_buffer();
+
   auto [complete_begin, complete_end] = champsim::get_span_p(std::cbegin(SQ), std::cend(SQ), store_bw, do_complete);
   store_bw -= std::distance(complete_begin, complete_end);
   SQ.erase(complete_begin, complete_end);
@@ -491,25 +539,55 @@ long O3_CPU::operate_lsq()
     }
   }
 
-  return (SQ_WIDTH - store_bw) + (LQ_WIDTH - load_bw);
+  return (SQ_WIDTH - store_bw) + (LQ_WIDTH - load_bw) + wc_progress;
+}
+
+long O3_CPU::drain_wc_buffer()
+{
+  long drained = 0;
+
+  // The oldest block is written once it times out, or once the buffer is full so that a store to another block can open one
+  while (drained < SQ_WIDTH && !std::empty(WC_BUFFER)
+         && (WC_BUFFER.front().event_cycle + WC_BUFFER_TIMEOUT <= current_cycle || std::size(WC_BUFFER) == WC_BUFFER_SIZE)) {
+    CacheBus::request_type data_packet;
+    data_packet.v_address = WC_BUFFER.front().virtual_address;
+    data_packet.instr_id = WC_BUFFER.front().instr_id;
+    data_packet.ip = WC_BUFFER.front().ip;
+
+    if constexpr (champsim::debug_print) {
+      fmt::print("[WC] {} instr_id: {} vaddr: {:x}\n", __func__, data_packet.instr_id, data_packet.v_address);
+    }
+
+    if (!L1D_bus.issue_write(data_packet))
+      break;
+
+    WC_BUFFER.pop_front();
+    ++sim_stats.wc_writes;
+    ++drained;
+  }
+
+  return drained;
 }
 
 void O3_CPU::do_finish_store(const LSQ_ENTRY& sq_entry)
 {
-  sq_entry.finish(std::begin(ROB), std::end(ROB));
+  wake_completion(sq_entry.finish(std::begin(ROB), std::end(ROB)));
 
   // Release dependent loads
   for (std::optional<LSQ_ENTRY>& dependent : sq_entry.lq_depend_on_me) {
     assert(dependent.has_value()); // LQ entry is still allocated
     assert(dependent->producer_id == sq_entry.instr_id);
 
-    dependent->finish(std::begin(ROB), std::end(ROB));
+    wake_completion(dependent->finish(std::begin(ROB), std::end(ROB)));
     dependent.reset();
   }
 }
 
 bool O3_CPU::do_complete_store(const LSQ_ENTRY& sq_entry)
 {
+  if (WC_BUFFER_SIZE > 0)
+    return do_combine_store(sq_entry);
+
   CacheBus::request_type data_packet;
   data_packet.v_address = sq_entry.virtual_address;
   data_packet.instr_id = sq_entry.instr_id;
@@ -522,6 +600,24 @@ bool O3_CPU::do_complete_store(const LSQ_ENTRY& sq_entry)
   return L1D_bus.issue_write(data_packet);
 }
 
+bool O3_CPU::do_combine_store(const LSQ_ENTRY& sq_entry)
+{
+  auto wc_entry = std::find_if(std::begin(WC_BUFFER), std::end(WC_BUFFER), [block = sq_entry.virtual_address >> LOG2_BLOCK_SIZE](const auto& x) {
+    return (x.virtual_address >> LOG2_BLOCK_SIZE) == block;
+  });
+
+  if (wc_entry != std::end(WC_BUFFER)) {
+    ++sim_stats.wc_merges;
+  } else {
+    if (std::size(WC_BUFFER) == WC_BUFFER_SIZE)
+      return false;
+    WC_BUFFER.push_back({sq_entry.instr_id, sq_entry.virtual_address, sq_entry.ip, current_cycle});
+  }
+
+  ++sim_stats.wc_stores;
+  return true;
+}
+
 bool O3_CPU::execute_load(const LSQ_ENTRY& lq_entry)
 {
   CacheBus::request_type data_packet;
@@ -552,24 +648,31 @@ void O3_CPU::do_complete_execution(ooo_model_instr& instr)
     dependent.num_reg_dependent--;
     assert(dependent.num_reg_dependent >= 0);
 
-    if (dependent.num_reg_dependent == 0)
+    if (dependent.num_reg_dependent == 0) {
       dependent.scheduled = COMPLETED;
+      wake_execution(dependent);
+    }
   }
 
   if (instr.branch_mispredicted)
     fetch_resume_cycle = current_cycle + BRANCH_MISPREDICT_PENALTY;
 }
 
+void O3_CPU::wake_completion(ooo_model_instr& instr)
+{
+  // This is called when the instruction executes and when each of its memory operations finishes, so it wakes once, when the last of these happens
+  if (instr.executed == INFLIGHT && instr.completed_mem_ops == instr.num_mem_ops())
+    complete_wakeups.schedule(instr.event_cycle, &instr);
+}
+
 long O3_CPU::complete_inflight_instruction()
 {
+  complete_wakeups.advance(current_cycle, [this](ooo_model_instr* instr) { push_ready(this->ready_to_complete, *instr); });
+
   // update ROB entries with completed executions
   auto complete_bw = EXEC_WIDTH;
-  for (auto rob_it = std::begin(ROB); rob_it != std::end(ROB) && complete_bw > 0; ++rob_it) {
-    if ((rob_it->executed == INFLIGHT) && (rob_it->event_cycle <= current_cycle) && rob_it->completed_mem_ops == rob_it->num_mem_ops()) {
-      do_complete_execution(*rob_it);
-      --complete_bw;
-    }
-  }
+  for (; complete_bw > 0 && !std::empty(ready_to_complete); --complete_bw)
+    do_complete_execution(pop_oldest(ready_to_complete));
 
   return EXEC_WIDTH - complete_bw;
 }
@@ -607,7 +710,7 @@ long O3_CPU::handle_memory_return()
   for (auto l1d_bw = L1D_BANDWIDTH; l1d_bw > 0 && l1d_it != std::end(L1D_bus.lower_level->returned); --l1d_bw, ++l1d_it) {
     for (auto& lq_entry : LQ) {
       if (lq_entry.has_value() && lq_entry->fetch_issued && lq_entry->virtual_address >> LOG2_BLOCK_SIZE == l1d_it->v_address >> LOG2_BLOCK_SIZE) {
-        lq_entry->finish(std::begin(ROB), std::end(ROB));
+        wake_completion(lq_entry->finish(std::begin(ROB), std::end(ROB)));
         lq_entry.reset();
         ++progress;
       }
@@ -627,7 +730,8 @@ long O3_CPU::retire_rob()
   }
   auto retire_count = std::distance(retire_begin, retire_end);
   num_retired += retire_count;
-  ROB.erase(retire_begin, retire_end);
+  num_scheduled -= std::min(num_scheduled, static_cast<std::size_t>(retire_count));
+  ROB.advance(static_cast<std::size_t>(retire_count));
 
   return retire_count;
 }
@@ -673,9 +777,9 @@ LSQ_ENTRY::LSQ_ENTRY(uint64_t id, uint64_t addr, uint64_t local_ip, std::array<u
 {
 }
 
-void LSQ_ENTRY::finish(std::deque<ooo_model_instr>::iterator begin, std::deque<ooo_model_instr>::iterator end) const
+ooo_model_instr& LSQ_ENTRY::finish(champsim::instruction_window::iterator begin, champsim::instruction_window::iterator end) const
 {
-  auto rob_entry = std::partition_point(begin, end, [id = this->instr_id](auto x) { return x.instr_id < id; });
+  auto rob_entry = std::partition_point(begin, end, [id = this->instr_id](const auto& x) { return x.instr_id < id; });
   assert(rob_entry != end);
   assert(rob_entry->instr_id == this->instr_id);
 
@@ -686,6 +790,8 @@ void LSQ_ENTRY::finish(std::deque<ooo_model_instr>::iterator begin, std::deque<o
     fmt::print("[LSQ] {} instr_id: {} full_address: {:#x} remain_mem_ops: {} event_cycle: {}\n", __func__, instr_id, virtual_address,
                rob_entry->num_mem_ops() - rob_entry->completed_mem_ops, event_cycle);
   }
+
+  return *rob_entry;
 }
 
 bool CacheBus::issue_read(request_type data_packet)
@@ -708,3 +814,8 @@ bool CacheBus::issue_write(request_type data_packet)
 
   return lower_level->add_wq(data_packet);
 }
+
+template long O3_CPU::operate_with<O3_CPU::module_concept>();
+
+// Specializations for the modules of the configured cores
+#include "ooo_cpu_operate_inst.inc"
@@ -14,6 +14,9 @@
  * limitations under the License.
  */
 
+#include <algorithm>
+#include <cmath>
+#include <iterator>
 #include <numeric>
 #include <sstream>
 #include <utility>
@@ -22,6 +25,7 @@
 #include "stats_printer.h"
 #include <fmt/core.h>
 #include <fmt/ostream.h>
+#include <fmt/ranges.h>
 
 void champsim::plain_printer::print(O3_CPU::stats_type stats)
 {
@@ -40,6 +44,10 @@ void champsim::plain_printer::print(O3_CPU::stats_type stats)
   fmt::print(stream, "{} Branch Prediction Accuracy: {:.4g}% MPKI: {:.4g} Average ROB Occupancy at Mispredict: {:.4g}\n", stats.name,
              (100.0 * std::ceil(total_branch - total_mispredictions)) / total_branch, (1000.0 * total_mispredictions) / std::ceil(stats.instrs()),
              std::ceil(stats.total_rob_occupancy_at_branch_mispredict) / total_mispredictions);
+  if (stats.wc_stores > 0) {
+    fmt::print(stream, "{} WRITE-COMBINING STORES: {:10} MERGED: {:10} WRITES: {:10}\n", stats.name, stats.wc_stores, stats.wc_merges,
+               stats.wc_writes);
+  }
 
   std::vector<double> mpkis;
   std::transform(std::begin(stats.branch_type_misses), std::end(stats.branch_type_misses), std::back_inserter(mpkis),
@@ -73,11 +81,74 @@ void champsim::plain_printer::print(CACHE::stats_type stats)
 
     fmt::print(stream, "{} PREFETCH REQUESTED: {:10} ISSUED: {:10} USEFUL: {:10} USELESS: {:10}\n", stats.name, stats.pf_requested, stats.pf_issued,
                stats.pf_useful, stats.pf_useless);
+    if (stats.pf_dropped > 0)
+      fmt::print(stream, "{} PREFETCH DROPPED: {:10}\n", stats.name, stats.pf_dropped);
+    if (stats.pf_suppressed > 0)
+      fmt::print(stream, "{} PREFETCH SUPPRESSED: {:10}\n", stats.name, stats.pf_suppressed);
+    if (stats.throttle_intervals > 0)
+      fmt::print(stream, "{} PREFETCH THROTTLED: {:10} AVERAGE THROTTLE LEVEL: {:.4g}\n", stats.name, stats.pf_throttled,
+                 std::ceil(stats.throttle_level_sum) / std::ceil(stats.throttle_intervals));
+    if (std::size(stats.prefetchers) > 1) {
+      for (const auto& pref : stats.prefetchers)
+        fmt::print(stream, "{} PREFETCHER {} REQUESTED: {:10} ISSUED: {:10} USEFUL: {:10} USELESS: {:10}\n", stats.name, pref.name, pref.requested, pref.issued,
+                   pref.useful, pref.useless);
+      fmt::print(stream, "{} PREFETCH DUPLICATES: {:10} OUTRANKED: {:10}\n", stats.name, stats.pf_duplicates, stats.pf_outranked);
+    }
+
+    if (stats.pf_late + stats.pf_early + stats.pf_useless + stats.pf_pollution > 0) {
+      fmt::print(stream, "{} PREFETCH LATE: {:10} AVERAGE REMAINING LATENCY: {:.4g} EARLY: {:10} AVERAGE DISTANCE: {:.4g}\n", stats.name, stats.pf_late,
+                 std::ceil(stats.pf_late_cycles) / std::ceil(stats.pf_late), stats.pf_early, std::ceil(stats.pf_early_cycles) / std::ceil(stats.pf_early));
+      fmt::print(stream, "{} PREFETCH USELESS AVERAGE LIFETIME: {:.4g} POLLUTION: {:10}\n", stats.name,
+                 std::ceil(stats.pf_useless_cycles) / std::ceil(stats.pf_useless), stats.pf_pollution);
+    }
+
+    if (stats.sector_miss + stats.subblock_miss > 0)
+      fmt::print(stream, "{} SECTOR MISS: {:10} SUB-BLOCK MISS: {:10}\n", stats.name, stats.sector_miss, stats.subblock_miss);
+
+    if (stats.back_invalidations + stats.victim_inserts > 0)
+      fmt::print(stream, "{} BACK-INVALIDATIONS: {:10} VICTIM INSERTS: {:10}\n", stats.name, stats.back_invalidations, stats.victim_inserts);
+
+    if (stats.bytes_written > 0)
+      fmt::print(stream, "{} BYTES WRITTEN: {:10} WRITE-AROUNDS: {:10}\n", stats.name, stats.bytes_written, stats.write_arounds);
+
+    if (stats.victim_hits + stats.victim_misses > 0) {
+      fmt::print(stream, "{} VICTIM BUFFER HIT: {:10} MISS: {:10} SWAP: {:10}\n", stats.name, stats.victim_hits, stats.victim_misses,
+                 stats.victim_swaps);
+    }
+
+    if (!std::empty(stats.bank_accesses)) {
+      fmt::print(stream, "{} BANK CONFLICTS: {:10}\n", stats.name, stats.bank_conflicts);
+      for (std::size_t bank = 0; bank < std::size(stats.bank_accesses); ++bank) {
+        fmt::print(stream, "{} BANK {:<3} ACCESS: {:10} UTILIZATION: {:.4g}\n", stats.name, bank, stats.bank_accesses[bank],
+                   std::ceil(stats.bank_accesses[bank]) / std::ceil(stats.cycles));
+      }
+    }
+
+    if (!std::empty(stats.way_allocations)) {
+      std::vector<uint32_t> ways{};
+      std::transform(std::begin(stats.way_allocations), std::end(stats.way_allocations), std::back_inserter(ways),
+                     [cpu](const auto& allocation) { return allocation.second.at(cpu); });
+      fmt::print(stream, "{} WAY ALLOCATION AVERAGE: {:.4g} OVER TIME: {}\n", stats.name,
+                 std::ceil(std::accumulate(std::begin(ways), std::end(ways), 0.0)) / std::ceil(std::size(ways)), fmt::join(ways, " "));
+    }
 
     fmt::print(stream, "{} AVERAGE MISS LATENCY: {:.4g} cycles\n", stats.name, stats.avg_miss_latency);
   }
 }
 
+void champsim::plain_printer::print(DRAM_CACHE::stats_type stats)
+{
+  fmt::print(stream, "{} READ         ACCESS: {:10d} HIT: {:10d} MISS: {:10d}\n", stats.name, stats.read_hits + stats.read_misses, stats.read_hits,
+             stats.read_misses);
+  fmt::print(stream, "{} WRITE        ACCESS: {:10d} HIT: {:10d} MISS: {:10d}\n", stats.name, stats.write_hits + stats.write_misses, stats.write_hits,
+             stats.write_misses);
+  if (stats.tag_cache_hits + stats.tag_cache_misses > 0)
+    fmt::print(stream, "{} TAG CACHE HIT: {:10} MISS: {:10}\n", stats.name, stats.tag_cache_hits, stats.tag_cache_misses);
+  fmt::print(stream, "{} ROW_BUFFER_HIT: {:10} ROW_BUFFER_MISS: {:10} WRITEBACKS: {:10}\n", stats.name, stats.row_buffer_hits, stats.row_buffer_misses,
+             stats.writebacks);
+  fmt::print(stream, "{} AVERAGE MISS LATENCY: {:.4g} cycles\n", stats.name, std::ceil(stats.total_miss_latency) / std::ceil(stats.read_misses));
+}
+
 void champsim::plain_printer::print(DRAM_CHANNEL::stats_type stats)
 {
   fmt::print(stream, "\n{} RQ ROW_BUFFER_HIT: {:10}\n  ROW_BUFFER_MISS: {:10}\n", stats.name, stats.RQ_ROW_BUFFER_HIT, stats.RQ_ROW_BUFFER_MISS);
@@ -105,6 +176,9 @@ void champsim::plain_printer::print(champsim::phase_stats& stats)
 
     for (const auto& stat : stats.sim_cache_stats)
       print(stat);
+
+    for (const auto& stat : stats.sim_dram_cache_stats)
+      print(stat);
   }
 
   fmt::print(stream, "\nRegion of Interest Statistics\n");
@@ -115,6 +189,9 @@ void champsim::plain_printer::print(champsim::phase_stats& stats)
   for (const auto& stat : stats.roi_cache_stats)
     print(stat);
 
+  for (const auto& stat : stats.roi_dram_cache_stats)
+    print(stat);
+
   fmt::print(stream, "\nDRAM Statistics\n");
   for (const auto& stat : stats.roi_dram_stats)
     print(stat);
@@ -0,0 +1,76 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "prefetch_throttle.h"
+
+#include <algorithm>
+#include <array>
+
+namespace
+{
+double ratio(uint64_t num, uint64_t den) { return den == 0 ? 0.0 : static_cast<double>(num) / static_cast<double>(den); }
+
+// The prefetches that each trigger may issue at each level. The most aggressive level does not limit them.
+constexpr std::array<uint64_t, champsim::prefetch_throttle::max_level> level_budget{1, 2, 4, 8, std::numeric_limits<uint64_t>::max()};
+} // namespace
+
+void champsim::prefetch_throttle::update(const prefetch_feedback& totals)
+{
+  const auto issued = totals.issued - last.issued;
+  const auto accuracy = ratio(totals.useful - last.useful, issued);
+  const auto lateness = ratio(totals.late - last.late, issued);
+  const auto pollution = ratio(totals.pollution - last.pollution, totals.demand_misses - last.demand_misses);
+  const auto utilization = ratio(totals.bus_busy - last.bus_busy, totals.bus_cycles - last.bus_cycles);
+  last = totals;
+
+  // An interval without prefetches says nothing about them
+  if (issued == 0)
+    return;
+
+  const bool late = lateness > lateness_threshold;
+  const bool polluting = pollution > pollution_threshold;
+  const bool saturated = utilization > bandwidth_threshold;
+
+  int step = 0;
+  if (accuracy >= accuracy_high) {
+    if (late)
+      step = 1;
+    else if (polluting)
+      step = -1;
+  } else if (accuracy >= accuracy_low) {
+    if (polluting)
+      step = -1;
+    else if (late)
+      step = 1;
+  } else if (late || polluting) {
+    step = -1;
+  }
+
+  // When the memory is near its bandwidth, only an accurate prefetcher keeps its share of it
+  if (saturated)
+    step = (accuracy >= accuracy_high) ? std::min(step, 0) : -1;
+
+  if (step > 0 && current_level < max_level)
+    ++current_level;
+  else if (step < 0 && current_level > 1)
+    --current_level;
+}
+
+void champsim::prefetch_throttle::restart(const prefetch_feedback& totals) { last = totals; }
+
+unsigned champsim::prefetch_throttle::level() const { return current_level; }
+
+uint64_t champsim::prefetch_throttle::budget() const { return level_budget.at(current_level - 1); }
@@ -36,6 +36,10 @@ PageTableWalker::PageTableWalker(Builder b)
 
   for (auto [level, sets, ways] : local_pscl_dims)
     pscl.emplace_back(sets, ways, pscl_indexer{b.m_vmem->shamt(level)}, pscl_indexer{b.m_vmem->shamt(level)});
+
+  MSHR.reserve(MSHR_SIZE);
+  finished.reserve(MSHR_SIZE);
+  completed.reserve(MSHR_SIZE);
 }
 
 PageTableWalker::mshr_type::mshr_type(request_type req, std::size_t level)
@@ -60,7 +64,7 @@ auto PageTableWalker::handle_read(const request_type& handle_pkt, channel_type*
   fwd_mshr.address = champsim::splice_bits(walk_init.ptw_addr, walk_offset, LOG2_PAGE_SIZE);
   fwd_mshr.v_address = handle_pkt.address;
   if (handle_pkt.response_requested)
-    fwd_mshr.to_return = {&ul->returned};
+    fwd_mshr.to_return = ul->return_to_this();
 
   if constexpr (champsim::debug_print) {
     fmt::print("[{}] {} address: {:#x} v_address: {:#x} pt_page_offset: {} translation_level: {}\n", NAME, __func__, fwd_mshr.address, fwd_mshr.v_address,
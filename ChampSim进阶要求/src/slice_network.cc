@@ -0,0 +1,197 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "slice_network.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <stdexcept>
+
+#include "cache_geometry.h"
+#include "champsim.h"
+#include "deadlock.h"
+#include "util/bits.h"
+#include <fmt/core.h>
+
+SliceNetwork::SliceNetwork(Builder b)
+    : champsim::operable(b.m_freq_scale), upper_levels(std::move(b.m_uls)), slices(std::move(b.m_slices)), NAME(b.m_name), OFFSET_BITS(b.m_offset_bits),
+      TOPOLOGY(b.m_topology), HOP_LATENCY(b.m_hop_latency), LINK_BANDWIDTH(b.m_link_bandwidth), LINK_BUFFER_SIZE(b.m_link_buffer)
+{
+  if (std::empty(slices) || (std::size(slices) & (std::size(slices) - 1)) != 0)
+    throw std::invalid_argument{"The number of slices of " + NAME + " must be a power of two"};
+  if (std::any_of(std::begin(slices), std::end(slices), [this](const auto& channels) { return std::size(channels) != std::size(upper_levels); }))
+    throw std::invalid_argument{"Each slice of " + NAME + " must have a channel for each upper level"};
+
+  upper_in_flight.resize(std::size(upper_levels));
+  upper_link_use.resize(std::size(upper_levels));
+  slice_link_use.resize(std::size(slices));
+  requests.reserve(std::size(upper_levels) * LINK_BUFFER_SIZE);
+
+  // The slices' invalidations are passed on to the upper levels that accept them
+  for (auto& channels : slices) {
+    for (auto slice_channel : channels)
+      slice_channel->accepts_invalidations = true;
+  }
+}
+
+void SliceNetwork::initialize()
+{
+  // An exclusive slice asks for victims after this network is built, so the upper levels are told here
+  const bool accepts_victims = std::any_of(std::begin(slices), std::end(slices), [](const auto& channels) {
+    return std::any_of(std::begin(channels), std::end(channels), [](const auto slice_channel) { return slice_channel->accepts_victims; });
+  });
+  for (auto ul : upper_levels)
+    ul->accepts_victims = accepts_victims;
+}
+
+std::size_t SliceNetwork::get_slice(uint64_t address) const
+{
+  return static_cast<std::size_t>(champsim::detail::xor_fold(address >> OFFSET_BITS, static_cast<unsigned>(champsim::lg2(std::size(slices)))));
+}
+
+uint64_t SliceNetwork::hops(std::size_t upper, std::size_t slice) const
+{
+  // The upper levels and the slices are each spread evenly over the stops
+  const auto stops = std::max(std::size(upper_levels), std::size(slices));
+  const auto upper_stop = upper * stops / std::size(upper_levels);
+  const auto slice_stop = slice * stops / std::size(slices);
+
+  if (TOPOLOGY == champsim::slice_topology::mesh) {
+    const auto width = static_cast<std::size_t>(std::ceil(std::sqrt(static_cast<double>(stops))));
+    auto distance = [](std::size_t x, std::size_t y) { return (x > y) ? x - y : y - x; };
+    return distance(upper_stop % width, slice_stop % width) + distance(upper_stop / width, slice_stop / width);
+  }
+
+  const auto distance = (upper_stop > slice_stop) ? upper_stop - slice_stop : slice_stop - upper_stop;
+  return std::min(distance, stops - distance);
+}
+
+long SliceNetwork::receive_requests()
+{
+  long received = 0;
+  for (std::size_t upper = 0; upper < std::size(upper_levels); ++upper) {
+    auto ul = upper_levels[upper];
+    ul->check_collision();
+
+    for (auto [queue, kind] : {std::pair{&ul->WQ, queue_kind::WQ}, std::pair{&ul->RQ, queue_kind::RQ}, std::pair{&ul->PQ, queue_kind::PQ}}) {
+      auto taken = std::find_if_not(std::begin(*queue), std::end(*queue), [this, upper](const auto&) {
+        return this->upper_link_use[upper] < this->LINK_BANDWIDTH && this->upper_in_flight[upper] < this->LINK_BUFFER_SIZE
+               && (++this->upper_link_use[upper], ++this->upper_in_flight[upper], true);
+      });
+
+      for (auto it = std::begin(*queue); it != taken; ++it) {
+        const auto slice = get_slice(it->address);
+        requests.push_back({*it, kind, upper, slice, current_cycle + 1 + hops(upper, slice) * HOP_LATENCY});
+      }
+
+      received += std::distance(std::begin(*queue), taken);
+      queue->erase(std::begin(*queue), taken);
+    }
+  }
+
+  return received;
+}
+
+long SliceNetwork::deliver_requests()
+{
+  // A request that cannot enter its slice waits, but does not hold back requests to other slices
+  auto kept_end = std::remove_if(std::begin(requests), std::end(requests), [this](const auto& entry) {
+    if (entry.event_cycle > this->current_cycle || this->slice_link_use[entry.slice] >= this->LINK_BANDWIDTH)
+      return false;
+
+    auto slice = this->slices[entry.slice][entry.upper];
+    bool success = false;
+    if (entry.kind == queue_kind::WQ)
+      success = slice->add_wq(entry.pkt);
+    else if (entry.kind == queue_kind::RQ)
+      success = slice->add_rq(entry.pkt);
+    else
+      success = slice->add_pq(entry.pkt);
+
+    if (!success)
+      return false;
+
+    ++this->slice_link_use[entry.slice];
+    --this->upper_in_flight[entry.upper];
+    return true;
+  });
+
+  const auto delivered = std::distance(kept_end, std::end(requests));
+  requests.erase(kept_end, std::end(requests));
+  return delivered;
+}
+
+long SliceNetwork::receive_responses()
+{
+  long received = 0;
+  for (std::size_t slice = 0; slice < std::size(slices); ++slice) {
+    for (std::size_t upper = 0; upper < std::size(upper_levels); ++upper) {
+      auto slice_channel = slices[slice][upper];
+      for (const auto& response : slice_channel->returned)
+        responses.push_back({response, upper, current_cycle + 1 + hops(upper, slice) * HOP_LATENCY});
+      received += std::distance(std::begin(slice_channel->returned), std::end(slice_channel->returned));
+      slice_channel->returned.clear();
+
+      if (upper_levels[upper]->accepts_invalidations)
+        std::copy(std::begin(slice_channel->invalidations), std::end(slice_channel->invalidations), std::back_inserter(upper_levels[upper]->invalidations));
+      slice_channel->invalidations.clear();
+    }
+  }
+
+  return received;
+}
+
+long SliceNetwork::deliver_responses()
+{
+  auto kept_end = std::remove_if(std::begin(responses), std::end(responses), [this](const auto& entry) {
+    if (entry.event_cycle > this->current_cycle || this->upper_link_use[entry.upper] >= this->LINK_BANDWIDTH)
+      return false;
+
+    this->upper_levels[entry.upper]->returned.push_back(entry.pkt);
+    ++this->upper_link_use[entry.upper];
+    return true;
+  });
+
+  const auto delivered = std::distance(kept_end, std::end(responses));
+  responses.erase(kept_end, std::end(responses));
+  return delivered;
+}
+
+long SliceNetwork::operate()
+{
+  long progress{0};
+  std::fill(std::begin(upper_link_use), std::end(upper_link_use), 0);
+  std::fill(std::begin(slice_link_use), std::end(slice_link_use), 0);
+
+  // The links at each stop are shared by requests and responses, and responses are given priority
+  progress += receive_responses();
+  progress += deliver_responses();
+  progress += deliver_requests();
+  progress += receive_requests();
+
+  return progress;
+}
+
+// LCOV_EXCL_START exclude deadlock printing
+void SliceNetwork::print_deadlock()
+{
+  champsim::range_print_deadlock(requests, NAME + "_requests", "address: {:#x} v_addr: {:#x} slice: {} event_cycle: {}",
+                                 [](const auto& entry) { return std::tuple{entry.pkt.address, entry.pkt.v_address, entry.slice, entry.event_cycle}; });
+  champsim::range_print_deadlock(responses, NAME + "_responses", "address: {:#x} v_addr: {:#x} upper: {} event_cycle: {}",
+                                 [](const auto& entry) { return std::tuple{entry.pkt.address, entry.pkt.v_address, entry.upper, entry.event_cycle}; });
+}
+// LCOV_EXCL_STOP
@@ -0,0 +1,115 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "way_partitioner.h"
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+
+namespace
+{
+// The number of sets monitored by each core's shadow tags, if the cache has at least this many
+constexpr std::size_t monitored_sets = 32;
+constexpr uint64_t no_tag = std::numeric_limits<uint64_t>::max();
+} // namespace
+
+champsim::way_partitioner::way_partitioner(std::size_t cpus, std::size_t sets, std::size_t ways)
+    : NUM_CPUS(cpus), NUM_SET(sets), NUM_WAY(ways), SAMPLE_STRIDE(std::max<std::size_t>(1, sets / monitored_sets)),
+      shadow_tags(cpus, std::vector<uint64_t>(((sets + SAMPLE_STRIDE - 1) / SAMPLE_STRIDE) * ways, no_tag)), way_hits(cpus, std::vector<uint64_t>(ways)),
+      allocation(cpus), block_owner(sets * ways), block_last_use(sets * ways)
+{
+  if (NUM_WAY < NUM_CPUS)
+    throw std::invalid_argument{"A partitioned cache must have at least one way for each core"};
+
+  // Until the monitors have seen any accesses, the ways are divided evenly
+  for (std::size_t cpu = 0; cpu < NUM_CPUS; ++cpu)
+    allocation[cpu] = static_cast<uint32_t>(NUM_WAY / NUM_CPUS + ((cpu < NUM_WAY % NUM_CPUS) ? 1 : 0));
+}
+
+bool champsim::way_partitioner::sampled(std::size_t set) const { return set % SAMPLE_STRIDE == 0; }
+
+void champsim::way_partitioner::monitor(uint32_t cpu, std::size_t set, uint64_t block)
+{
+  if (!sampled(set) || cpu >= NUM_CPUS)
+    return;
+
+  auto set_begin = std::next(std::begin(shadow_tags[cpu]), static_cast<long>((set / SAMPLE_STRIDE) * NUM_WAY));
+  auto set_end = std::next(set_begin, static_cast<long>(NUM_WAY));
+  auto found = std::find(set_begin, set_end, block);
+
+  if (found != set_end)
+    ++way_hits[cpu][static_cast<std::size_t>(std::distance(set_begin, found))];
+  else
+    found = std::prev(set_end); // the least recently used tag is replaced
+
+  // Move the block to the most recently used position
+  std::rotate(set_begin, found, std::next(found));
+  *set_begin = block;
+}
+
+void champsim::way_partitioner::fill(std::size_t index, uint32_t cpu, uint64_t cycle)
+{
+  block_owner.at(index) = cpu;
+  block_last_use.at(index) = cycle;
+}
+
+void champsim::way_partitioner::touch(std::size_t index, uint64_t cycle) { block_last_use.at(index) = cycle; }
+
+uint32_t champsim::way_partitioner::owner(std::size_t index) const { return block_owner.at(index); }
+
+uint64_t champsim::way_partitioner::last_use(std::size_t index) const { return block_last_use.at(index); }
+
+uint64_t champsim::way_partitioner::utility(std::size_t cpu, std::size_t ways) const
+{
+  return std::accumulate(std::begin(way_hits[cpu]), std::next(std::begin(way_hits[cpu]), static_cast<long>(ways)), uint64_t{0});
+}
+
+void champsim::way_partitioner::repartition()
+{
+  // Every core keeps at least one way
+  std::fill(std::begin(allocation), std::end(allocation), 1);
+  auto balance = NUM_WAY - NUM_CPUS;
+
+  while (balance > 0) {
+    // Find the core, and the number of ways, that give the most hits per way
+    double best_utility = -1;
+    std::size_t best_cpu = 0;
+    std::size_t best_ways = 1;
+    for (std::size_t cpu = 0; cpu < NUM_CPUS; ++cpu) {
+      const auto base = utility(cpu, allocation[cpu]);
+      for (std::size_t extra = 1; extra <= balance; ++extra) {
+        const auto marginal = static_cast<double>(utility(cpu, allocation[cpu] + extra) - base) / static_cast<double>(extra);
+        if (marginal > best_utility) {
+          best_utility = marginal;
+          best_cpu = cpu;
+          best_ways = extra;
+        }
+      }
+    }
+
+    allocation[best_cpu] += static_cast<uint32_t>(best_ways);
+    balance -= best_ways;
+  }
+
+  for (auto& core_hits : way_hits)
+    std::for_each(std::begin(core_hits), std::end(core_hits), [](auto& count) { count /= 2; });
+}
+
+const std::vector<uint32_t>& champsim::way_partitioner::allocations() const { return allocation; }
+
+const std::vector<uint64_t>& champsim::way_partitioner::hits(uint32_t cpu) const { return way_hits.at(cpu); }
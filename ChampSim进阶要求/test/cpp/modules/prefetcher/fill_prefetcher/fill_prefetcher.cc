@@ -0,0 +1,29 @@
+#include "cache.h"
+
+#include <map>
+#include <vector>
+
+namespace test
+{
+  // The prefetches to request from each fill, and what prefetch_line() returned for each
+  std::map<CACHE*, uint64_t> fill_prefetch_count;
+  std::map<CACHE*, std::vector<int>> fill_prefetch_status;
+}
+
+void CACHE::prefetcher_initialize() {}
+
+uint32_t CACHE::prefetcher_cache_operate(uint64_t addr, uint64_t ip, uint8_t cache_hit, bool useful_prefetch, uint8_t type, uint32_t metadata_in)
+{
+  return metadata_in;
+}
+
+uint32_t CACHE::prefetcher_cache_fill(uint64_t addr, uint32_t set, uint32_t way, uint8_t prefetch, uint64_t evicted_addr, uint32_t metadata_in)
+{
+  for (uint64_t i = 1; i <= test::fill_prefetch_count[this]; ++i)
+    test::fill_prefetch_status[this].push_back(prefetch_line(((addr >> LOG2_BLOCK_SIZE) + i) << LOG2_BLOCK_SIZE, true, 0));
+  return metadata_in;
+}
+
+void CACHE::prefetcher_cycle_operate() {}
+
+void CACHE::prefetcher_final_stats() {}
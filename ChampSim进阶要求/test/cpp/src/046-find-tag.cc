@@ -0,0 +1,40 @@
+#include <catch.hpp>
+#include "util/simd.h"
+
+#include <vector>
+
+TEST_CASE("find_tag() returns the end of an empty range") {
+  std::vector<uint64_t> tags{};
+  CHECK(champsim::find_tag(std::data(tags), std::data(tags), 0) == std::data(tags));
+}
+
+TEST_CASE("find_tag() returns the end of a range without a match") {
+  std::vector<uint64_t> tags{1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11};
+  auto end = std::next(std::data(tags), std::size(tags));
+  CHECK(champsim::find_tag(std::data(tags), end, 12) == end);
+}
+
+TEST_CASE("find_tag() finds a match in any position") {
+  auto size = GENERATE(as<std::size_t>{}, 1, 2, 3, 4, 5, 7, 8, 11, 16, 17);
+  std::vector<uint64_t> tags(size);
+  for (std::size_t i = 0; i < size; ++i)
+    tags[i] = 0xdeadbeef00000000 + i;
+  auto end = std::next(std::data(tags), static_cast<long>(size));
+
+  for (std::size_t i = 0; i < size; ++i)
+    CHECK(champsim::find_tag(std::data(tags), end, tags[i]) == std::next(std::data(tags), static_cast<long>(i)));
+}
+
+TEST_CASE("find_tag() does not match on only half of a tag") {
+  std::vector<uint64_t> tags{0xdeadbeef'00000001, 0x00000001'cafebabe, 0xffffffff'ffffffff, 0x00000001'00000001};
+  auto end = std::next(std::data(tags), std::size(tags));
+  CHECK(champsim::find_tag(std::data(tags), end, 0x00000001'00000001) == std::next(std::data(tags), 3));
+  CHECK(champsim::find_tag(std::data(tags), end, 0xdeadbeef'cafebabe) == end);
+}
+
+TEST_CASE("find_tag() returns the first of several matches") {
+  std::vector<uint64_t> tags{3, 1, 4, 1, 5, 9, 2, 6, 5, 3, 5};
+  auto end = std::next(std::data(tags), std::size(tags));
+  CHECK(champsim::find_tag(std::data(tags), end, 5) == std::next(std::data(tags), 4));
+  CHECK(champsim::find_tag(std::data(tags), end, 1) == std::next(std::data(tags), 1));
+}
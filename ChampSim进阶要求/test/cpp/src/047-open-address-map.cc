@@ -0,0 +1,69 @@
+#include <catch.hpp>
+#include "util/open_address_map.h"
+
+#include <map>
+#include <random>
+
+TEST_CASE("An empty open_address_map finds nothing") {
+  champsim::open_address_map<int> uut{8};
+  CHECK(uut.empty());
+  CHECK(uut.find(0) == nullptr);
+  CHECK(uut.find(0xdeadbeef) == nullptr);
+  CHECK_FALSE(uut.erase(0xdeadbeef));
+}
+
+TEST_CASE("An open_address_map finds inserted keys") {
+  champsim::open_address_map<int> uut{8};
+  uut.insert_or_assign(0xdeadbeef, 1);
+  uut.insert_or_assign(0xcafebabe, 2);
+
+  CHECK(uut.size() == 2);
+  REQUIRE(uut.find(0xdeadbeef) != nullptr);
+  CHECK(*uut.find(0xdeadbeef) == 1);
+  REQUIRE(uut.find(0xcafebabe) != nullptr);
+  CHECK(*uut.find(0xcafebabe) == 2);
+  CHECK(uut.find(0xfeedface) == nullptr);
+}
+
+TEST_CASE("An open_address_map overwrites the value of a key that is already present") {
+  champsim::open_address_map<int> uut{8};
+  uut.insert_or_assign(0xdeadbeef, 1);
+  uut.insert_or_assign(0xdeadbeef, 2);
+
+  CHECK(uut.size() == 1);
+  REQUIRE(uut.find(0xdeadbeef) != nullptr);
+  CHECK(*uut.find(0xdeadbeef) == 2);
+}
+
+TEST_CASE("An open_address_map agrees with std::map under random insertion and erasure") {
+  constexpr std::size_t capacity = 64;
+  champsim::open_address_map<uint64_t> uut{capacity};
+  std::map<uint64_t, uint64_t> reference{};
+
+  std::mt19937_64 rng{0x408};
+  std::uniform_int_distribution<uint64_t> key_dist{0, 3 * capacity}; // small key space, so that keys collide and are reused
+
+  for (uint64_t i = 0; i < 10000; ++i) {
+    auto key = key_dist(rng);
+    if (reference.count(key) > 0 || std::size(reference) == capacity) {
+      auto victim = reference.count(key) > 0 ? key : std::begin(reference)->first;
+      CHECK(uut.erase(victim));
+      reference.erase(victim);
+    } else {
+      uut.insert_or_assign(key, i);
+      reference[key] = i;
+    }
+
+    REQUIRE(uut.size() == std::size(reference));
+  }
+
+  for (uint64_t key = 0; key <= 3 * capacity; ++key) {
+    auto found = uut.find(key);
+    if (reference.count(key) > 0) {
+      REQUIRE(found != nullptr);
+      CHECK(*found == reference.at(key));
+    } else {
+      CHECK(found == nullptr);
+    }
+  }
+}
@@ -0,0 +1,76 @@
+#include <catch.hpp>
+#include "util/pooled_list.h"
+
+#include <vector>
+
+TEST_CASE("An empty pooled_list holds no storage") {
+  auto before = champsim::pooled_list_allocations;
+  champsim::pooled_list<int> uut{};
+  champsim::pooled_list<int> copy{uut};
+
+  CHECK(std::empty(uut));
+  CHECK(std::size(copy) == 0);
+  CHECK(std::begin(uut) == std::end(uut));
+  CHECK(champsim::pooled_list_allocations == before);
+}
+
+TEST_CASE("Copies of a pooled_list share storage until one is written") {
+  champsim::pooled_list<int> uut{1, 2, 3};
+  auto before = champsim::pooled_list_allocations;
+
+  auto copy = uut;
+  CHECK(copy.shares_storage_with(uut));
+  CHECK(champsim::pooled_list_allocations == before);
+
+  copy.push_back(4);
+  CHECK_FALSE(copy.shares_storage_with(uut));
+  CHECK(champsim::pooled_list_allocations == before + 1);
+  CHECK(std::vector<int>(std::begin(uut), std::end(uut)) == std::vector<int>{1, 2, 3});
+  CHECK(std::vector<int>(std::begin(copy), std::end(copy)) == std::vector<int>{1, 2, 3, 4});
+}
+
+TEST_CASE("Erasing from a shared pooled_list does not affect the other copies") {
+  champsim::pooled_list<int> uut{1, 2, 3};
+  auto copy = uut;
+
+  copy.erase(std::begin(copy));
+  CHECK(copy.front() == 2);
+  CHECK(uut.front() == 1);
+
+  copy.erase(std::begin(copy));
+  copy.erase(std::begin(copy));
+  CHECK(std::empty(copy));
+  CHECK(std::size(uut) == 3);
+}
+
+TEST_CASE("A pooled_list can be constructed from an iterator range") {
+  std::vector<int> source{5, 6, 7};
+  champsim::pooled_list<int> uut{std::begin(source), std::end(source)};
+  CHECK(std::vector<int>(std::begin(uut), std::end(uut)) == source);
+}
+
+TEST_CASE("Merging pooled_lists shares storage where possible") {
+  champsim::pooled_list<int> lhs{1, 3, 5};
+  champsim::pooled_list<int> rhs{2, 3, 4};
+  champsim::pooled_list<int> empty{};
+
+  auto before = champsim::pooled_list_allocations;
+  CHECK(champsim::merge_sorted(lhs, empty).shares_storage_with(lhs));
+  CHECK(champsim::merge_sorted(empty, rhs).shares_storage_with(rhs));
+  CHECK(champsim::merge_sorted(lhs, lhs).shares_storage_with(lhs));
+  CHECK(champsim::pooled_list_allocations == before);
+
+  auto merged = champsim::merge_sorted(lhs, rhs);
+  CHECK(std::vector<int>(std::begin(merged), std::end(merged)) == std::vector<int>{1, 2, 3, 4, 5});
+}
+
+TEST_CASE("Released pooled_list storage is reused") {
+  const long* first_storage = nullptr;
+  {
+    champsim::pooled_list<long> uut{1, 2, 3};
+    first_storage = &uut.front();
+  }
+
+  champsim::pooled_list<long> reuse{4};
+  CHECK(&reuse.front() == first_storage);
+}
@@ -0,0 +1,113 @@
+#include <catch.hpp>
+#include "util/ring_buffer.h"
+#include "util/algorithm.h"
+
+#include <deque>
+#include <memory>
+#include <random>
+#include <vector>
+
+TEST_CASE("A ring_buffer reserves its capacity at construction") {
+  champsim::ring_buffer<int> uut{12};
+  CHECK(uut.empty());
+  CHECK(uut.capacity() == 16);
+  CHECK(std::begin(uut) == std::end(uut));
+}
+
+TEST_CASE("A ring_buffer wraps around without growing") {
+  champsim::ring_buffer<int> uut{4};
+  for (int i = 0; i < 100; ++i) {
+    uut.push_back(i);
+    if (std::size(uut) > 3)
+      uut.pop_front();
+  }
+
+  CHECK(uut.capacity() == 4);
+  CHECK(std::vector<int>(std::begin(uut), std::end(uut)) == std::vector<int>{97, 98, 99});
+  CHECK(uut.front() == 97);
+  CHECK(uut.back() == 99);
+  CHECK(uut[1] == 98);
+  CHECK_THROWS(uut.at(3));
+}
+
+TEST_CASE("A ring_buffer grows when it is full") {
+  champsim::ring_buffer<int> uut{2};
+  uut.push_back(1);
+  uut.push_back(2);
+  uut.push_back(uut.front());
+
+  CHECK(uut.capacity() == 4);
+  CHECK(std::vector<int>(std::begin(uut), std::end(uut)) == std::vector<int>{1, 2, 1});
+}
+
+TEST_CASE("A ring_buffer holds types without a default constructor") {
+  champsim::ring_buffer<std::unique_ptr<int>> uut{2};
+  uut.emplace_back(std::make_unique<int>(1));
+  uut.emplace_back(std::make_unique<int>(2));
+  uut.emplace_back(std::make_unique<int>(3));
+  uut.erase(std::next(std::begin(uut)));
+
+  REQUIRE(std::size(uut) == 2);
+  CHECK(*uut.front() == 1);
+  CHECK(*uut.back() == 3);
+}
+
+TEST_CASE("Erasing from a ring_buffer matches erasing from a deque") {
+  auto size = GENERATE(1, 5, 16);
+  auto offset = GENERATE(0, 3, 13);
+
+  std::mt19937 rng{static_cast<std::mt19937::result_type>(size * 17 + offset)};
+  for (int trial = 0; trial < 50; ++trial) {
+    champsim::ring_buffer<int> uut{16};
+    std::deque<int> reference{};
+
+    // Start the contents at an arbitrary point in the array
+    for (int i = 0; i < offset; ++i) {
+      uut.push_back(-1);
+      uut.pop_front();
+    }
+    for (int i = 0; i < size; ++i) {
+      uut.push_back(i);
+      reference.push_back(i);
+    }
+
+    std::uniform_int_distribution<long> first_dist{0, size};
+    auto first = first_dist(rng);
+    std::uniform_int_distribution<long> last_dist{first, size};
+    auto last = last_dist(rng);
+
+    auto uut_it = uut.erase(std::next(std::cbegin(uut), first), std::next(std::cbegin(uut), last));
+    reference.erase(std::next(std::cbegin(reference), first), std::next(std::cbegin(reference), last));
+
+    CHECK(std::distance(std::begin(uut), uut_it) == first);
+    CHECK(std::vector<int>(std::begin(uut), std::end(uut)) == std::vector<int>(std::begin(reference), std::end(reference)));
+  }
+}
+
+TEST_CASE("Inserting into a ring_buffer places the elements at the position") {
+  champsim::ring_buffer<int> uut{8};
+  uut.push_back(1);
+  uut.push_back(4);
+
+  std::vector<int> source{2, 3};
+  uut.insert(std::next(std::cbegin(uut)), std::begin(source), std::end(source));
+  CHECK(std::vector<int>(std::begin(uut), std::end(uut)) == std::vector<int>{1, 2, 3, 4});
+}
+
+TEST_CASE("The queue algorithms operate on a ring_buffer") {
+  champsim::ring_buffer<int> uut{8};
+  for (int i = 0; i < 6; ++i)
+    uut.push_back(i);
+
+  std::vector<int> odd{};
+  auto [last, out] = champsim::extract_if(std::begin(uut), std::end(uut), std::back_inserter(odd), [](int x) { return x % 2 == 1; });
+  uut.erase(last, std::end(uut));
+  CHECK(odd == std::vector<int>{1, 3, 5});
+  CHECK(std::vector<int>(std::begin(uut), std::end(uut)) == std::vector<int>{0, 2, 4});
+
+  std::vector<int> doubled{};
+  auto consumed = champsim::transform_while_n(uut, std::back_inserter(doubled), 2, [](int) { return true; }, [](int x) { return 2 * x; });
+  CHECK(consumed == 2);
+  CHECK(doubled == std::vector<int>{0, 4});
+  CHECK(std::vector<int>(std::begin(uut), std::end(uut)) == std::vector<int>{4});
+}
@@ -0,0 +1,70 @@
+#include <catch.hpp>
+#include "util/timing_wheel.h"
+
+#include <vector>
+
+TEST_CASE("A timing_wheel visits a value on the cycle it is due") {
+  champsim::timing_wheel<int> uut{4};
+  std::vector<int> visited{};
+  auto visit = [&visited](int x) { visited.push_back(x); };
+
+  uut.schedule(3, 30);
+  uut.schedule(1, 10);
+  uut.schedule(3, 31);
+  CHECK(uut.size() == 3);
+
+  uut.advance(0, visit);
+  CHECK(std::empty(visited));
+
+  uut.advance(1, visit);
+  CHECK(visited == std::vector<int>{10});
+
+  uut.advance(3, visit);
+  CHECK(visited == std::vector<int>{10, 30, 31});
+  CHECK(uut.empty());
+}
+
+TEST_CASE("A timing_wheel holds a value beyond its horizon until it is due") {
+  champsim::timing_wheel<int> uut{2};
+  std::vector<int> visited{};
+  auto visit = [&visited](int x) { visited.push_back(x); };
+
+  uut.schedule(9, 90);
+  for (uint64_t cycle = 0; cycle < 9; ++cycle)
+    uut.advance(cycle, visit);
+  CHECK(std::empty(visited));
+
+  uut.advance(9, visit);
+  CHECK(visited == std::vector<int>{90});
+}
+
+TEST_CASE("A timing_wheel visits a value scheduled in the past on the next cycle") {
+  champsim::timing_wheel<int> uut{4};
+  std::vector<int> visited{};
+  auto visit = [&visited](int x) { visited.push_back(x); };
+
+  uut.advance(5, visit);
+  uut.schedule(2, 20);
+  uut.advance(5, visit);
+  CHECK(std::empty(visited));
+
+  uut.advance(6, visit);
+  CHECK(visited == std::vector<int>{20});
+}
+
+TEST_CASE("A timing_wheel visits the values scheduled while it advances") {
+  champsim::timing_wheel<int> uut{4};
+  std::vector<int> visited{};
+  auto visit = [&](int x) {
+    visited.push_back(x);
+    if (x < 3)
+      uut.schedule(x + 1, x + 1);
+  };
+
+  uut.schedule(1, 1);
+  uut.advance(10, visit);
+  CHECK(visited == std::vector<int>{1});
+
+  uut.advance(11, visit);
+  CHECK(visited == std::vector<int>{1, 2});
+}
@@ -0,0 +1,59 @@
+#include <catch.hpp>
+#include "instruction_window.h"
+#include "instr.h"
+
+#include <vector>
+
+TEST_CASE("An instruction_window reserves its capacity at construction") {
+  champsim::instruction_window uut{12, 2};
+  champsim::instruction_window::stage first{&uut, 0}, second{&uut, 1};
+
+  CHECK(uut.capacity() == 16);
+  CHECK(uut.empty());
+  CHECK(first.empty());
+  CHECK(second.empty());
+  CHECK(std::begin(second) == std::end(second));
+}
+
+TEST_CASE("Instructions advance through the stages of an instruction_window without moving") {
+  champsim::instruction_window uut{4, 2};
+  champsim::instruction_window::stage older{&uut, 0}, younger{&uut, 1};
+
+  for (uint64_t ip = 1; ip <= 3; ++ip)
+    younger.push_back(champsim::test::instruction_with_ip(ip));
+  auto* second = &younger[1];
+
+  REQUIRE(std::size(younger) == 3);
+  REQUIRE(older.empty());
+
+  younger.advance(2);
+  CHECK(std::size(older) == 2);
+  CHECK(std::size(younger) == 1);
+  CHECK(older.front().ip == 1);
+  CHECK(older.back().ip == 2);
+  CHECK(younger.front().ip == 3);
+  CHECK(&older[1] == second);
+  CHECK_THROWS(older.at(2));
+
+  older.advance(1);
+  CHECK(std::size(uut) == 2);
+  CHECK(older.front().ip == 2);
+  CHECK(&older.front() == second);
+}
+
+TEST_CASE("An instruction_window reuses the slots of retired instructions") {
+  champsim::instruction_window uut{4, 2};
+  champsim::instruction_window::stage older{&uut, 0}, younger{&uut, 1};
+
+  for (uint64_t ip = 1; ip <= 20; ++ip) {
+    younger.push_back(champsim::test::instruction_with_ip(ip));
+    younger.advance(1);
+    if (std::size(older) > 3)
+      older.advance(1);
+  }
+
+  std::vector<uint64_t> ips{};
+  std::transform(std::begin(older), std::end(older), std::back_inserter(ips), [](const auto& x) { return x.ip; });
+  CHECK(uut.capacity() == 4);
+  CHECK(ips == std::vector<uint64_t>{18, 19, 20});
+}
@@ -0,0 +1,89 @@
+#include <catch.hpp>
+#include "mocks.hpp"
+#include "defaults.hpp"
+#include "ooo_cpu.h"
+#include "instr.h"
+
+SCENARIO("The core selects the oldest ready instructions to execute") {
+  GIVEN("A ROB with more independent instructions than the execution width") {
+    constexpr unsigned execute_width = 2;
+
+    do_nothing_MRC mock_L1I, mock_L1D;
+    O3_CPU uut{O3_CPU::Builder{champsim::defaults::default_core}
+      .execute_width(execute_width)
+      .fetch_queues(&mock_L1I.queues)
+      .data_queues(&mock_L1D.queues)
+    };
+
+    std::vector test_instructions( 8, champsim::test::instruction_with_ip(1) );
+    std::copy(std::begin(test_instructions), std::end(test_instructions), std::back_inserter(uut.ROB));
+    uint64_t id = 0;
+    for (auto &instr : uut.ROB) {
+      instr.instr_id = id++;
+      instr.event_cycle = uut.current_cycle;
+      instr.scheduled = 0;
+      instr.executed = 0;
+    }
+
+    WHEN("The instructions are scheduled and the core executes") {
+      for (auto i = 0; i < 2; ++i) {
+        for (auto op : std::array<champsim::operable*,3>{{&uut, &mock_L1I, &mock_L1D}})
+          op->_operate();
+      }
+
+      THEN("Only the oldest instructions execute") {
+        REQUIRE(uut.ROB.at(0).executed != 0);
+        REQUIRE(uut.ROB.at(1).executed != 0);
+        REQUIRE(std::all_of(std::next(std::begin(uut.ROB), execute_width), std::end(uut.ROB), [](const auto& x){ return x.executed == 0; }));
+      }
+    }
+  }
+
+  GIVEN("A ROB with a dependent instruction older than an independent one") {
+    constexpr unsigned execute_width = 1;
+
+    do_nothing_MRC mock_L1I, mock_L1D;
+    O3_CPU uut{O3_CPU::Builder{champsim::defaults::default_core}
+      .execute_width(execute_width)
+      .fetch_queues(&mock_L1I.queues)
+      .data_queues(&mock_L1D.queues)
+    };
+
+    uut.ROB.push_back(champsim::test::instruction_with_registers(42));
+    uut.ROB.push_back(champsim::test::instruction_with_registers(42));
+    uut.ROB.push_back(champsim::test::instruction_with_ip(1));
+    uint64_t id = 0;
+    for (auto &instr : uut.ROB) {
+      instr.instr_id = id++;
+      instr.event_cycle = uut.current_cycle;
+      instr.scheduled = 0;
+      instr.executed = 0;
+    }
+
+    WHEN("The producer executes") {
+      for (auto i = 0; i < 2; ++i) {
+        for (auto op : std::array<champsim::operable*,3>{{&uut, &mock_L1I, &mock_L1D}})
+          op->_operate();
+      }
+
+      THEN("The dependent waits for it to complete") {
+        REQUIRE(uut.ROB.at(0).executed != 0);
+        REQUIRE(uut.ROB.at(1).num_reg_dependent == 1);
+        REQUIRE(uut.ROB.at(1).executed == 0);
+        REQUIRE(uut.ROB.at(2).executed == 0);
+      }
+
+      AND_WHEN("The producer completes") {
+        for (auto op : std::array<champsim::operable*,3>{{&uut, &mock_L1I, &mock_L1D}})
+          op->_operate();
+
+        THEN("The dependent is selected before the younger independent instruction") {
+          REQUIRE(uut.ROB.at(0).executed == COMPLETED);
+          REQUIRE(uut.ROB.at(1).num_reg_dependent == 0);
+          REQUIRE(uut.ROB.at(1).executed != 0);
+          REQUIRE(uut.ROB.at(2).executed == 0);
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,79 @@
+#include <catch.hpp>
+#include "mocks.hpp"
+#include "defaults.hpp"
+#include "ooo_cpu.h"
+
+SCENARIO("The write-combining buffer gathers the stores to a block") {
+  GIVEN("A core with a write-combining buffer of two blocks") {
+    do_nothing_MRC mock_L1I, mock_L1D;
+    constexpr uint64_t timeout = 10;
+    O3_CPU uut{O3_CPU::Builder{champsim::defaults::default_core}
+      .wc_buffer_size(2)
+      .wc_buffer_timeout(timeout)
+      .fetch_queues(&mock_L1I.queues)
+      .data_queues(&mock_L1D.queues)
+    };
+
+    std::array<champsim::operable*, 3> elements{{&uut, &mock_L1I, &mock_L1D}};
+
+    WHEN("Two stores to one block and a store to another complete") {
+      for (uint64_t address : {0xdeadbe00, 0xdeadbe08, 0xcafeba00}) {
+        uut.SQ.emplace_back(1, address, 0, std::array<uint8_t, 2>{});
+        uut.SQ.back().fetch_issued = true;
+      }
+
+      for (auto i = 0; i < 2; ++i)
+        for (auto elem : elements)
+          elem->_operate();
+
+      THEN("The stores to the same block are merged, and nothing is written yet") {
+        REQUIRE(std::empty(uut.SQ));
+        REQUIRE(uut.sim_stats.wc_stores == 3);
+        REQUIRE(uut.sim_stats.wc_merges == 1);
+        REQUIRE(mock_L1D.packet_count() == 0);
+      }
+
+      AND_WHEN("The blocks time out") {
+        for (uint64_t i = 0; i < 2 * timeout; ++i)
+          for (auto elem : elements)
+            elem->_operate();
+
+        THEN("Each block is written to the L1D once") {
+          REQUIRE(uut.sim_stats.wc_writes == 2);
+          REQUIRE(mock_L1D.packet_count() == 2);
+          REQUIRE(mock_L1D.addresses.at(0) == 0xdeadbe00);
+          REQUIRE(mock_L1D.addresses.at(1) == 0xcafeba00);
+        }
+      }
+    }
+  }
+
+  GIVEN("A core with a write-combining buffer of one block") {
+    do_nothing_MRC mock_L1I, mock_L1D;
+    O3_CPU uut{O3_CPU::Builder{champsim::defaults::default_core}
+      .wc_buffer_size(1)
+      .wc_buffer_timeout(1000)
+      .fetch_queues(&mock_L1I.queues)
+      .data_queues(&mock_L1D.queues)
+    };
+
+    std::array<champsim::operable*, 3> elements{{&uut, &mock_L1I, &mock_L1D}};
+
+    WHEN("Stores to two blocks complete") {
+      for (uint64_t address : {0xdeadbe00, 0xcafeba00}) {
+        uut.SQ.emplace_back(1, address, 0, std::array<uint8_t, 2>{});
+        uut.SQ.back().fetch_issued = true;
+      }
+
+      for (auto i = 0; i < 5; ++i)
+        for (auto elem : elements)
+          elem->_operate();
+
+      THEN("The first block is written to make room for the second before it times out") {
+        REQUIRE(std::empty(uut.SQ));
+        REQUIRE(mock_L1D.packet_count() >= 1);
+        REQUIRE(mock_L1D.addresses.at(0) == 0xdeadbe00);
+      }
+    }
+  }
+}
@@ -0,0 +1,119 @@
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+#include <catch.hpp>
+#include "mocks.hpp"
+#include "defaults.hpp"
+#include "cache.h"
+#include "champsim_constants.h"
+
+namespace
+{
+  struct mshr_testbed
+  {
+    release_MRC mock_ll;
+    to_rq_MRP mock_ul;
+    CACHE uut;
+    std::array<champsim::operable*, 3> elements{{&mock_ll, &uut, &mock_ul}};
+    uint64_t next_address = 0;
+
+    explicit mshr_testbed(uint32_t mshr_size) : uut(CACHE::Builder{champsim::defaults::default_llc}
+        .name("408-uut-" + std::to_string(mshr_size))
+        .upper_levels({&mock_ul.queues})
+        .lower_level(&mock_ll.queues)
+        .mshr_size(mshr_size)
+        .tag_bandwidth(8)
+        .fill_bandwidth(8)
+      )
+    {
+      for (auto elem : elements) {
+        elem->initialize();
+        elem->warmup = false;
+        elem->begin_phase();
+      }
+    }
+
+    void operate(int cycles)
+    {
+      for (auto i = 0; i < cycles; ++i)
+        for (auto elem : elements)
+          elem->_operate();
+    }
+
+    // Fill the MSHR with misses to distinct blocks, then return them to the cache in the opposite order
+    std::vector<uint64_t> round_trip()
+    {
+      std::vector<uint64_t> addresses{};
+      auto sent = mock_ll.packet_count();
+      while (std::size(addresses) < uut.MSHR_SIZE) {
+        decltype(mock_ul)::request_type pkt;
+        pkt.address = (++next_address) << LOG2_BLOCK_SIZE;
+        pkt.cpu = 0;
+        pkt.type = access_type::LOAD;
+        pkt.instr_id = next_address;
+        mock_ul.issue(pkt);
+        addresses.push_back(pkt.address);
+      }
+
+      while (mock_ll.packet_count() < sent + std::size(addresses))
+        operate(1);
+
+      for (auto it = std::rbegin(addresses); it != std::rend(addresses); ++it) {
+        mock_ll.release(*it);
+        operate(1);
+      }
+
+      while (uut.get_mshr_occupancy() > 0)
+        operate(1);
+
+      return addresses;
+    }
+  };
+}
+
+SCENARIO("A cache with many outstanding misses accepts returns in any order") {
+  GIVEN("A cache whose MSHR is full") {
+    mshr_testbed testbed{64};
+
+    WHEN("The lower level returns the misses in the opposite order they were sent") {
+      auto addresses = testbed.round_trip();
+
+      THEN("Every miss was forwarded once") {
+        REQUIRE(testbed.mock_ll.packet_count() == std::size(addresses));
+      }
+
+      THEN("Every request was returned to the upper level") {
+        REQUIRE(std::size(testbed.mock_ul.packets) == std::size(addresses));
+        for (const auto& pkt : testbed.mock_ul.packets)
+          CHECK(pkt.return_time > 0);
+      }
+
+      THEN("The MSHR is empty") {
+        REQUIRE(std::empty(testbed.uut.MSHR));
+      }
+
+      AND_WHEN("The same blocks are accessed again") {
+        auto hits_before = testbed.uut.sim_stats.hits.at(champsim::to_underlying(access_type::LOAD)).at(0);
+        for (auto addr : addresses) {
+          decltype(testbed.mock_ul)::request_type pkt;
+          pkt.address = addr;
+          pkt.cpu = 0;
+          pkt.type = access_type::LOAD;
+          testbed.mock_ul.issue(pkt);
+        }
+        testbed.operate(200);
+
+        THEN("Every block was filled") {
+          REQUIRE(testbed.uut.sim_stats.hits.at(champsim::to_underlying(access_type::LOAD)).at(0) == hits_before + std::size(addresses));
+        }
+      }
+    }
+  }
+}
+
+TEST_CASE("MSHR round trip", "[.][benchmark]") {
+  auto mshr_size = GENERATE(as<uint32_t>{}, 8, 16, 32, 64, 128, 256, 512);
+  mshr_testbed testbed{mshr_size};
+
+  BENCHMARK("MSHR size " + std::to_string(mshr_size)) {
+    return testbed.round_trip();
+  };
+}
@@ -230,6 +230,18 @@ SCENARIO("Cache queues forward WQ to RQ") {
           }
         }
       }
+
+      AND_WHEN("The write queue is checked before a packet with the same address is sent to the read queue") {
+        uut.check_collision();
+        issue(uut, address, true, issue_rq<champsim::channel>);
+        uut.check_collision();
+
+        THEN("The read is still forwarded from the write") {
+          CHECK(uut.wq_occupancy() == 1);
+          CHECK(uut.rq_occupancy() == 0);
+          CHECK(uut.sim_stats.WQ_FORWARD == 1);
+        }
+      }
     }
   }
 }
@@ -286,3 +298,66 @@ SCENARIO("Translating cache queues forward RQ virtual to physical RQ") {
     }
   }
 }
+
+SCENARIO("Cache queues keep the order of the packets that are not merged") {
+  GIVEN("A read queue with interleaved duplicates") {
+    champsim::channel uut{32, 32, 32, LOG2_BLOCK_SIZE, false};
+    const std::array<uint64_t, 7> addresses{{0xa000, 0xb000, 0xa008, 0xc000, 0xb010, 0xd000, 0xc000}};
+    for (auto addr : addresses)
+      issue(uut, addr, issue_rq<decltype(uut)>);
+
+    WHEN("A packet to one of the blocks is also in the write queue") {
+      issue(uut, 0xd000, issue_wq<decltype(uut)>);
+      uut.check_collision();
+
+      THEN("The first packet to each remaining block is kept, in order") {
+        REQUIRE(uut.rq_occupancy() == 3);
+        CHECK(uut.RQ.at(0).address == 0xa000);
+        CHECK(uut.RQ.at(1).address == 0xb000);
+        CHECK(uut.RQ.at(2).address == 0xc000);
+        CHECK(std::all_of(std::begin(uut.RQ), std::end(uut.RQ), [](const auto& x) { return x.forward_checked; }));
+      }
+
+      THEN("The statistics reflect the merges and the forward") {
+        CHECK(uut.sim_stats.RQ_MERGED == 3);
+        CHECK(uut.sim_stats.WQ_FORWARD == 1);
+        CHECK(std::size(uut.returned) == 1);
+      }
+
+      AND_WHEN("The head of the queue is consumed and a duplicate of it arrives") {
+        uut.RQ.pop_front();
+        issue(uut, 0xa000, issue_rq<decltype(uut)>);
+        issue(uut, 0xc000, issue_rq<decltype(uut)>);
+        uut.check_collision();
+
+        THEN("Only packets to blocks still in the queue are merged") {
+          REQUIRE(uut.rq_occupancy() == 3);
+          CHECK(uut.RQ.at(0).address == 0xb000);
+          CHECK(uut.RQ.at(1).address == 0xc000);
+          CHECK(uut.RQ.at(2).address == 0xa000);
+          CHECK(uut.sim_stats.RQ_MERGED == 4);
+        }
+      }
+    }
+  }
+}
+
+SCENARIO("Unbounded cache queues detect collisions however long they grow") {
+  GIVEN("A read queue without a bound") {
+    champsim::channel uut{};
+
+    WHEN("Many blocks are read twice") {
+      for (uint64_t i = 0; i < 200; ++i)
+        issue(uut, 0x10000 + (i << LOG2_BLOCK_SIZE), issue_rq<decltype(uut)>);
+      uut.check_collision();
+      for (uint64_t i = 0; i < 200; ++i)
+        issue(uut, 0x10000 + (i << LOG2_BLOCK_SIZE), issue_rq<decltype(uut)>);
+      uut.check_collision();
+
+      THEN("Each second read is merged into the first") {
+        CHECK(uut.rq_occupancy() == 200);
+        CHECK(uut.sim_stats.RQ_MERGED == 200);
+      }
+    }
+  }
+}
@@ -0,0 +1,18 @@
+#include <catch.hpp>
+#include "cache_geometry.h"
+
+static_assert(champsim::is_static_geometry_v<champsim::static_geometry<64, 12, 6>>);
+static_assert(!champsim::is_static_geometry_v<champsim::dynamic_geometry>);
+static_assert(champsim::static_geometry<64, 12, 6>::set_index(0xdeadbeef) == ((0xdeadbeef >> 6) & 63));
+
+TEST_CASE("A static geometry indexes sets like the equivalent dynamic geometry") {
+  auto address = GENERATE(as<uint64_t>{}, 0, 0x40, 0xfff, 0xdeadbeef, 0xffffffffffffffff);
+
+  champsim::dynamic_geometry dynamic{2048, 16, 6};
+  champsim::static_geometry<2048, 16, 6> fixed{};
+
+  CHECK(fixed.sets() == dynamic.sets());
+  CHECK(fixed.ways() == dynamic.ways());
+  CHECK(fixed.offset_bits() == dynamic.offset_bits());
+  CHECK(fixed.set_index(address) == dynamic.set_index(address));
+}
@@ -0,0 +1,110 @@
+#include <catch.hpp>
+#include "mocks.hpp"
+#include "defaults.hpp"
+#include "cache.h"
+#include "cache_geometry.h"
+#include "champsim_constants.h"
+
+#include <set>
+
+static_assert(champsim::detail::largest_prime_not_above(2048) == 2039);
+static_assert(champsim::detail::largest_prime_not_above(8) == 7);
+static_assert(champsim::detail::xor_fold(0b101'011, 3) == 0b110);
+
+TEST_CASE("Every set index function stays within the sets of the cache") {
+  auto function = GENERATE(champsim::set_index_function::modulo, champsim::set_index_function::xor_fold, champsim::set_index_function::prime_modulo,
+                           champsim::set_index_function::skewed);
+  auto address = GENERATE(as<uint64_t>{}, 0, 0x40, 0xfff, 0xdeadbeef, 0xffffffffffffffff);
+
+  champsim::dynamic_geometry geom{2048, 16, 6, function};
+  for (uint32_t way = 0; way < geom.ways(); ++way)
+    CHECK(geom.set_index(address, way) < geom.sets());
+  CHECK(geom.set_index(address) == geom.set_index(address, 0));
+}
+
+TEST_CASE("Only a skewed index differs between ways") {
+  champsim::dynamic_geometry xor_geom{2048, 16, 6, champsim::set_index_function::xor_fold};
+  champsim::dynamic_geometry skewed_geom{2048, 16, 6, champsim::set_index_function::skewed};
+
+  std::set<std::size_t> xor_sets;
+  std::set<std::size_t> skewed_sets;
+  for (uint32_t way = 0; way < 16; ++way) {
+    xor_sets.insert(xor_geom.set_index(0xdeadbeef, way));
+    skewed_sets.insert(skewed_geom.set_index(0xdeadbeef, way));
+  }
+
+  CHECK(std::size(xor_sets) == 1);
+  CHECK(std::size(skewed_sets) > 1);
+}
+
+TEST_CASE("Hashed set indices spread a power-of-two stride across the sets") {
+  auto function = GENERATE(champsim::set_index_function::xor_fold, champsim::set_index_function::prime_modulo, champsim::set_index_function::skewed);
+
+  champsim::dynamic_geometry modulo_geom{2048, 16, 6};
+  champsim::dynamic_geometry hashed_geom{2048, 16, 6, function};
+
+  std::set<std::size_t> modulo_sets;
+  std::set<std::size_t> hashed_sets;
+  for (uint64_t i = 0; i < 64; ++i) {
+    modulo_sets.insert(modulo_geom.set_index(i << 17));
+    hashed_sets.insert(hashed_geom.set_index(i << 17));
+  }
+
+  CHECK(std::size(modulo_sets) == 1);
+  CHECK(std::size(hashed_sets) > 32);
+}
+
+SCENARIO("A cache with a hashed set index holds a strided stream that would thrash a modulo-indexed cache") {
+  using namespace std::literals;
+  auto [function, str] = GENERATE(table<champsim::set_index_function, std::string_view>({
+        std::pair{champsim::set_index_function::xor_fold, "xor"sv},
+        std::pair{champsim::set_index_function::prime_modulo, "prime"sv},
+        std::pair{champsim::set_index_function::skewed, "skewed"sv}
+      }));
+
+  GIVEN("An empty cache with 8 sets and 4 ways") {
+    constexpr uint64_t hit_latency = 2;
+    do_nothing_MRC mock_ll;
+    to_rq_MRP mock_ul;
+    CACHE uut{CACHE::Builder{champsim::defaults::default_l1d}
+      .name("434-uut-"+std::string{str})
+      .sets(8)
+      .ways(4)
+      .set_index(function)
+      .upper_levels({&mock_ul.queues})
+      .lower_level(&mock_ll.queues)
+      .hit_latency(hit_latency)
+      .offset_bits(6)
+    };
+
+    std::array<champsim::operable*, 3> elements{{&uut, &mock_ll, &mock_ul}};
+
+    for (auto elem : elements) {
+      elem->initialize();
+      elem->warmup = false;
+      elem->begin_phase();
+    }
+
+    WHEN("Twelve blocks that share a set under modulo indexing are loaded twice") {
+      for (int pass = 0; pass < 2; ++pass) {
+        for (uint64_t i = 0; i < 12; ++i) {
+          decltype(mock_ul)::request_type test;
+          test.address = (i + 1) << 9;
+          test.is_translated = true;
+          test.cpu = 0;
+          test.type = access_type::LOAD;
+          mock_ul.issue(test);
+
+          for (auto j = 0; j < 100; ++j)
+            for (auto elem : elements)
+              elem->_operate();
+        }
+      }
+
+      THEN("Every load in the second pass hits") {
+        REQUIRE(uut.sim_stats.misses.at(champsim::to_underlying(access_type::LOAD)).at(0) == 12);
+        REQUIRE(uut.sim_stats.hits.at(champsim::to_underlying(access_type::LOAD)).at(0) == 12);
+      }
+    }
+  }
+}
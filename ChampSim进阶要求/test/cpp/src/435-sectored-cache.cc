@@ -0,0 +1,71 @@
+#include <catch.hpp>
+#include "mocks.hpp"
+#include "defaults.hpp"
+#include "cache.h"
+#include "champsim_constants.h"
+
+SCENARIO("A sectored cache fills its blocks individually") {
+  GIVEN("An empty cache with four blocks in each sector") {
+    constexpr uint64_t hit_latency = 2;
+    do_nothing_MRC mock_ll;
+    to_rq_MRP mock_ul;
+    CACHE uut{CACHE::Builder{champsim::defaults::default_l1d}
+      .name("435-uut")
+      .sets(8)
+      .ways(4)
+      .sector_size(4)
+      .upper_levels({&mock_ul.queues})
+      .lower_level(&mock_ll.queues)
+      .hit_latency(hit_latency)
+      .offset_bits(6)
+    };
+
+    std::array<champsim::operable*, 3> elements{{&uut, &mock_ll, &mock_ul}};
+
+    for (auto elem : elements) {
+      elem->initialize();
+      elem->warmup = false;
+      elem->begin_phase();
+    }
+
+    auto issue_load = [&](uint64_t address) {
+      decltype(mock_ul)::request_type test;
+      test.address = address;
+      test.is_translated = true;
+      test.cpu = 0;
+      test.type = access_type::LOAD;
+      mock_ul.issue(test);
+
+      for (auto j = 0; j < 100; ++j)
+        for (auto elem : elements)
+          elem->_operate();
+    };
+
+    WHEN("One block of a sector is loaded") {
+      issue_load(0xdeadbe00);
+
+      THEN("The miss finds its sector absent") {
+        REQUIRE(uut.sim_stats.sector_miss == 1);
+        REQUIRE(uut.sim_stats.subblock_miss == 0);
+      }
+
+      AND_WHEN("A neighbouring block in the same sector is loaded twice") {
+        issue_load(0xdeadbe40);
+        issue_load(0xdeadbe40);
+
+        THEN("The first load misses on the block and the second hits") {
+          REQUIRE(uut.sim_stats.sector_miss == 1);
+          REQUIRE(uut.sim_stats.subblock_miss == 1);
+          REQUIRE(uut.sim_stats.misses.at(champsim::to_underlying(access_type::LOAD)).at(0) == 2);
+          REQUIRE(uut.sim_stats.hits.at(champsim::to_underlying(access_type::LOAD)).at(0) == 1);
+        }
+
+        THEN("Both blocks share a single way") {
+          auto set_begin = std::next(std::begin(uut.block), uut.get_set_index(0xdeadbe00) * uut.NUM_WAY);
+          auto set_end = std::next(set_begin, uut.NUM_WAY);
+          REQUIRE(std::count_if(set_begin, set_end, [](const auto& blk) { return blk.valid; }) == 1);
+        }
+      }
+    }
+  }
+}
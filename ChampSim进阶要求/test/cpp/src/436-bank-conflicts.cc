@@ -0,0 +1,65 @@
+#include <catch.hpp>
+#include "mocks.hpp"
+#include "defaults.hpp"
+#include "cache.h"
+#include "champsim_constants.h"
+
+#include <numeric>
+
+SCENARIO("A banked cache serializes tag checks in the same bank") {
+  using namespace std::literals;
+  auto [second_address, expected_conflicts, str] = GENERATE(table<uint64_t, uint64_t, std::string_view>({
+        std::tuple{0xdeadbe40, 0, "different"sv},
+        std::tuple{0xdeadbe80, 1, "same"sv}
+      }));
+
+  GIVEN("An empty cache with two banks that can check two tags per cycle") {
+    constexpr uint64_t hit_latency = 2;
+    do_nothing_MRC mock_ll;
+    to_rq_MRP mock_ul;
+    CACHE uut{CACHE::Builder{champsim::defaults::default_l1d}
+      .name("436-uut-"+std::string{str})
+      .sets(8)
+      .ways(4)
+      .tag_bandwidth(2)
+      .banks(2)
+      .upper_levels({&mock_ul.queues})
+      .lower_level(&mock_ll.queues)
+      .hit_latency(hit_latency)
+      .offset_bits(6)
+    };
+
+    std::array<champsim::operable*, 3> elements{{&uut, &mock_ll, &mock_ul}};
+
+    for (auto elem : elements) {
+      elem->initialize();
+      elem->warmup = false;
+      elem->begin_phase();
+    }
+
+    WHEN("Two loads to the " + std::string{str} + " bank arrive together") {
+      for (auto address : {uint64_t{0xdeadbe00}, second_address}) {
+        decltype(mock_ul)::request_type test;
+        test.address = address;
+        test.is_translated = true;
+        test.cpu = 0;
+        test.type = access_type::LOAD;
+        mock_ul.issue(test);
+      }
+
+      for (auto i = 0; i < 100; ++i)
+        for (auto elem : elements)
+          elem->_operate();
+
+      THEN("Both tag checks complete") {
+        REQUIRE(std::size(uut.sim_stats.bank_accesses) == 2);
+        REQUIRE(std::accumulate(std::begin(uut.sim_stats.bank_accesses), std::end(uut.sim_stats.bank_accesses), uint64_t{0}) == 2);
+        REQUIRE(uut.sim_stats.misses.at(champsim::to_underlying(access_type::LOAD)).at(0) == 2);
+      }
+
+      THEN("Only the loads to the same bank conflict") {
+        REQUIRE(uut.sim_stats.bank_conflicts == expected_conflicts);
+      }
+    }
+  }
+}
@@ -0,0 +1,126 @@
+#include <catch.hpp>
+#include "mocks.hpp"
+#include "defaults.hpp"
+#include "cache.h"
+#include "champsim_constants.h"
+
+namespace
+{
+template <std::size_t N>
+void load(to_rq_MRP& mock_ul, std::array<champsim::operable*, N>& elements, uint64_t address)
+{
+  to_rq_MRP::request_type test;
+  test.address = address;
+  test.is_translated = true;
+  test.cpu = 0;
+  test.type = access_type::LOAD;
+  mock_ul.issue(test);
+
+  for (auto i = 0; i < 100; ++i)
+    for (auto elem : elements)
+      elem->_operate();
+}
+} // namespace
+
+SCENARIO("An inclusive cache invalidates the blocks it evicts in its upper levels") {
+  GIVEN("An inclusive cache with a single block below a larger cache") {
+    do_nothing_MRC mock_ll;
+    to_rq_MRP mock_ul;
+    champsim::channel between{32, 32, 32, LOG2_BLOCK_SIZE, false};
+    CACHE lower{CACHE::Builder{champsim::defaults::default_llc}
+      .name("437a-lower")
+      .sets(1)
+      .ways(1)
+      .inclusion(champsim::inclusion_policy::inclusive)
+      .upper_levels({&between})
+      .lower_level(&mock_ll.queues)
+      .offset_bits(6)
+    };
+    CACHE upper{CACHE::Builder{champsim::defaults::default_l2c}
+      .name("437a-upper")
+      .sets(8)
+      .ways(4)
+      .upper_levels({&mock_ul.queues})
+      .lower_level(&between)
+      .offset_bits(6)
+    };
+
+    std::array<champsim::operable*, 4> elements{{&upper, &lower, &mock_ll, &mock_ul}};
+
+    for (auto elem : elements) {
+      elem->initialize();
+      elem->warmup = false;
+      elem->begin_phase();
+    }
+
+    WHEN("A second block evicts the first from the inclusive cache") {
+      load(mock_ul, elements, 0xdeadbe00);
+      load(mock_ul, elements, 0xcafeba00);
+
+      THEN("The first block is invalidated in the upper cache") {
+        REQUIRE(lower.sim_stats.back_invalidations == 1);
+
+        load(mock_ul, elements, 0xdeadbe00);
+        REQUIRE(upper.sim_stats.hits.at(champsim::to_underlying(access_type::LOAD)).at(0) == 0);
+        REQUIRE(upper.sim_stats.misses.at(champsim::to_underlying(access_type::LOAD)).at(0) == 3);
+      }
+    }
+  }
+}
+
+SCENARIO("An exclusive cache holds the victims of its upper levels") {
+  GIVEN("An exclusive cache below a cache with a single block") {
+    do_nothing_MRC mock_ll;
+    to_rq_MRP mock_ul;
+    champsim::channel between{32, 32, 32, LOG2_BLOCK_SIZE, false};
+    CACHE lower{CACHE::Builder{champsim::defaults::default_llc}
+      .name("437b-lower")
+      .sets(8)
+      .ways(4)
+      .inclusion(champsim::inclusion_policy::exclusive)
+      .upper_levels({&between})
+      .lower_level(&mock_ll.queues)
+      .offset_bits(6)
+    };
+    CACHE upper{CACHE::Builder{champsim::defaults::default_l2c}
+      .name("437b-upper")
+      .sets(1)
+      .ways(1)
+      .upper_levels({&mock_ul.queues})
+      .lower_level(&between)
+      .offset_bits(6)
+    };
+
+    std::array<champsim::operable*, 4> elements{{&upper, &lower, &mock_ll, &mock_ul}};
+
+    for (auto elem : elements) {
+      elem->initialize();
+      elem->warmup = false;
+      elem->begin_phase();
+    }
+
+    WHEN("A block is loaded") {
+      load(mock_ul, elements, 0xdeadbe00);
+
+      THEN("The exclusive cache does not keep it") {
+        REQUIRE(lower.invalidate_entry(0xdeadbe00) == lower.NUM_WAY);
+      }
+
+      AND_WHEN("A second block evicts it from the upper cache, and it is loaded again") {
+        load(mock_ul, elements, 0xcafeba00);
+        load(mock_ul, elements, 0xdeadbe00);
+
+        THEN("The clean victim is found in the exclusive cache") {
+          REQUIRE(lower.sim_stats.victim_inserts == 2);
+          REQUIRE(lower.sim_stats.hits.at(champsim::to_underlying(access_type::LOAD)).at(0) == 1);
+          REQUIRE(mock_ll.packet_count() == 2);
+        }
+
+        THEN("The block moved back to the upper cache") {
+          REQUIRE(lower.invalidate_entry(0xdeadbe00) == lower.NUM_WAY);
+          REQUIRE(lower.invalidate_entry(0xcafeba00) < lower.NUM_WAY);
+        }
+      }
+    }
+  }
+}
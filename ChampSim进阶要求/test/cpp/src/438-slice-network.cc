@@ -0,0 +1,183 @@
+#include <catch.hpp>
+#include "mocks.hpp"
+#include "slice_network.h"
+#include "champsim_constants.h"
+
+TEST_CASE("The hops between stops follow the topology") {
+  std::array<champsim::channel, 4> uppers{};
+  std::array<std::array<champsim::channel, 4>, 4> slices{};
+
+  auto build = [&](champsim::slice_topology topology) {
+    std::vector<std::vector<champsim::channel*>> slice_channels{};
+    for (auto& channels : slices)
+      slice_channels.push_back({&channels[0], &channels[1], &channels[2], &channels[3]});
+
+    return SliceNetwork{SliceNetwork::Builder{}
+      .name("438a-uut")
+      .offset_bits(LOG2_BLOCK_SIZE)
+      .topology(topology)
+      .upper_levels({&uppers[0], &uppers[1], &uppers[2], &uppers[3]})
+      .slices(std::move(slice_channels))
+    };
+  };
+
+  SECTION("A ring wraps around") {
+    auto uut = build(champsim::slice_topology::ring);
+    CHECK(uut.hops(0, 0) == 0);
+    CHECK(uut.hops(0, 1) == 1);
+    CHECK(uut.hops(0, 2) == 2);
+    CHECK(uut.hops(0, 3) == 1);
+  }
+
+  SECTION("A mesh counts the rows and columns between stops") {
+    auto uut = build(champsim::slice_topology::mesh);
+    CHECK(uut.hops(0, 0) == 0);
+    CHECK(uut.hops(0, 1) == 1);
+    CHECK(uut.hops(0, 2) == 1);
+    CHECK(uut.hops(0, 3) == 2);
+  }
+}
+
+TEST_CASE("Every slice receives some addresses") {
+  std::array<champsim::channel, 8> slices{};
+  champsim::channel upper{};
+  SliceNetwork uut{SliceNetwork::Builder{}
+    .name("438b-uut")
+    .offset_bits(LOG2_BLOCK_SIZE)
+    .upper_levels({&upper})
+    .slices({{&slices[0]}, {&slices[1]}, {&slices[2]}, {&slices[3]}, {&slices[4]}, {&slices[5]}, {&slices[6]}, {&slices[7]}})
+  };
+
+  std::array<int, 8> counts{};
+  for (uint64_t block = 0; block < 1024; ++block) {
+    auto slice = uut.get_slice(block << LOG2_BLOCK_SIZE);
+    REQUIRE(slice < std::size(counts));
+    ++counts[slice];
+  }
+
+  for (auto count : counts)
+    CHECK(count > 0);
+}
+
+SCENARIO("A request to a distant slice takes longer to return") {
+  GIVEN("A ring with an upper level and four slices") {
+    constexpr uint64_t hop_latency = 10;
+    to_rq_MRP mock_ul;
+    std::array<do_nothing_MRC, 4> mock_slices{};
+    SliceNetwork uut{SliceNetwork::Builder{}
+      .name("438c-uut")
+      .offset_bits(LOG2_BLOCK_SIZE)
+      .hop_latency(hop_latency)
+      .link_bandwidth(2)
+      .upper_levels({&mock_ul.queues})
+      .slices({{&mock_slices[0].queues}, {&mock_slices[1].queues}, {&mock_slices[2].queues}, {&mock_slices[3].queues}})
+    };
+
+    std::vector<champsim::operable*> elements{{&mock_ul, &uut, &mock_slices[0], &mock_slices[1], &mock_slices[2], &mock_slices[3]}};
+
+    for (auto elem : elements) {
+      elem->initialize();
+      elem->warmup = false;
+      elem->begin_phase();
+    }
+
+    // Find a block in the nearest slice and one in the farthest
+    uint64_t near_address = 0, far_address = 0;
+    for (uint64_t block = 1; near_address == 0 || far_address == 0; ++block) {
+      auto slice = uut.get_slice(block << LOG2_BLOCK_SIZE);
+      if (slice == 0 && near_address == 0)
+        near_address = block << LOG2_BLOCK_SIZE;
+      if (uut.hops(0, slice) == 2 && far_address == 0)
+        far_address = block << LOG2_BLOCK_SIZE;
+    }
+
+    WHEN("A load is sent to each") {
+      for (auto address : {near_address, far_address}) {
+        decltype(mock_ul)::request_type test;
+        test.address = address;
+        test.is_translated = true;
+        test.cpu = 0;
+        test.type = access_type::LOAD;
+        mock_ul.issue(test);
+      }
+
+      for (auto i = 0; i < 200; ++i)
+        for (auto elem : elements)
+          elem->_operate();
+
+      THEN("Each slice receives only the load that maps to it") {
+        REQUIRE(mock_slices[0].packet_count() == 1);
+        REQUIRE(mock_slices[uut.get_slice(far_address)].packet_count() == 1);
+      }
+
+      THEN("The far load takes two hops longer in each direction") {
+        REQUIRE(mock_ul.packets.at(0).return_time > 0);
+        REQUIRE(mock_ul.packets.at(1).return_time > 0);
+        REQUIRE(mock_ul.packets.at(1).return_time - mock_ul.packets.at(0).return_time == 4 * hop_latency);
+      }
+    }
+  }
+}
+
+TEST_CASE("Each slice must have a channel for each upper level") {
+  std::array<champsim::channel, 2> uppers{};
+  std::array<champsim::channel, 2> slices{};
+  auto build = [&] {
+    return SliceNetwork{SliceNetwork::Builder{}
+      .name("438d-uut")
+      .offset_bits(LOG2_BLOCK_SIZE)
+      .upper_levels({&uppers[0], &uppers[1]})
+      .slices({{&slices[0]}, {&slices[1]}})
+    };
+  };
+  REQUIRE_THROWS_AS(build(), std::invalid_argument);
+}
+
+SCENARIO("Each upper level receives the response to its own request") {
+  GIVEN("Two upper levels that share a slice, which answers one of them later than the other") {
+    constexpr uint64_t slow_latency = 100;
+    std::array<to_rq_MRP, 2> mock_uls{};
+    do_nothing_MRC slow_channel{slow_latency};
+    do_nothing_MRC fast_channel{};
+    SliceNetwork uut{SliceNetwork::Builder{}
+      .name("438e-uut")
+      .offset_bits(LOG2_BLOCK_SIZE)
+      .upper_levels({&mock_uls[0].queues, &mock_uls[1].queues})
+      .slices({{&slow_channel.queues, &fast_channel.queues}})
+    };
+
+    std::vector<champsim::operable*> elements{{&mock_uls[0], &mock_uls[1], &uut, &slow_channel, &fast_channel}};
+
+    for (auto elem : elements) {
+      elem->initialize();
+      elem->warmup = false;
+      elem->begin_phase();
+    }
+
+    WHEN("Both upper levels load the same block") {
+      for (auto& mock_ul : mock_uls) {
+        decltype(mock_uls)::value_type::request_type test;
+        test.address = 0xdeadbeef;
+        test.is_translated = true;
+        test.cpu = 0;
+        test.type = access_type::LOAD;
+        mock_ul.issue(test);
+      }
+
+      for (auto i = 0; i < 300; ++i)
+        for (auto elem : elements)
+          elem->_operate();
+
+      THEN("Each request reaches the slice through the channel of its upper level") {
+        REQUIRE(slow_channel.packet_count() == 1);
+        REQUIRE(fast_channel.packet_count() == 1);
+      }
+
+      THEN("Each upper level is answered when its own request returns") {
+        REQUIRE(mock_uls[1].packets.at(0).return_time > 0);
+        REQUIRE(mock_uls[1].packets.at(0).return_time < slow_latency);
+        REQUIRE(mock_uls[0].packets.at(0).return_time >= slow_latency);
+      }
+    }
+  }
+}
@@ -0,0 +1,92 @@
+#include <catch.hpp>
+#include "mocks.hpp"
+#include "defaults.hpp"
+#include "cache.h"
+#include "champsim_constants.h"
+#include "way_partitioner.h"
+
+#include <numeric>
+
+SCENARIO("The lookahead algorithm gives the ways to the core that gains the most hits") {
+  GIVEN("A partitioner for two cores sharing eight ways") {
+    champsim::way_partitioner uut{2, 64, 8};
+
+    THEN("The ways are divided evenly at first") {
+      REQUIRE(uut.allocations() == std::vector<uint32_t>{4, 4});
+    }
+
+    WHEN("One core reuses six blocks and the other streams") {
+      for (uint64_t i = 0; i < 600; ++i) {
+        uut.monitor(0, 0, 1 + (i % 6));
+        uut.monitor(1, 0, 0x1000 + i);
+      }
+
+      THEN("The monitors count the hits at each stack position") {
+        REQUIRE(uut.hits(0).at(5) == 594);
+        REQUIRE(std::accumulate(std::begin(uut.hits(1)), std::end(uut.hits(1)), uint64_t{0}) == 0);
+      }
+
+      AND_WHEN("The ways are divided") {
+        uut.repartition();
+
+        THEN("The reusing core receives the ways it needs, and the streaming core keeps one") {
+          REQUIRE(uut.allocations().at(0) >= 6);
+          REQUIRE(uut.allocations().at(1) >= 1);
+          REQUIRE(std::accumulate(std::begin(uut.allocations()), std::end(uut.allocations()), 0u) == 8);
+        }
+
+        THEN("The counts are halved") {
+          REQUIRE(uut.hits(0).at(5) == 297);
+        }
+      }
+    }
+
+    WHEN("A core accesses a set that is not sampled") {
+      REQUIRE_FALSE(uut.sampled(1));
+      for (uint64_t i = 0; i < 10; ++i)
+        uut.monitor(0, 1, 1);
+
+      THEN("Nothing is counted") {
+        REQUIRE(std::accumulate(std::begin(uut.hits(0)), std::end(uut.hits(0)), uint64_t{0}) == 0);
+      }
+    }
+  }
+}
+
+SCENARIO("A partitioned cache records its allocations at each interval") {
+  GIVEN("A cache that partitions its ways every 100 cycles") {
+    do_nothing_MRC mock_ll;
+    to_rq_MRP mock_ul;
+    CACHE uut{CACHE::Builder{champsim::defaults::default_llc}
+      .name("439-uut")
+      .sets(8)
+      .ways(4)
+      .partition_interval(100)
+      .upper_levels({&mock_ul.queues})
+      .lower_level(&mock_ll.queues)
+      .offset_bits(6)
+    };
+
+    std::array<champsim::operable*, 3> elements{{&uut, &mock_ll, &mock_ul}};
+
+    for (auto elem : elements) {
+      elem->initialize();
+      elem->warmup = false;
+      elem->begin_phase();
+    }
+
+    WHEN("The cache operates for 250 cycles") {
+      for (auto i = 0; i < 250; ++i)
+        for (auto elem : elements)
+          elem->_operate();
+
+      THEN("Two divisions of all the ways are recorded") {
+        REQUIRE(std::size(uut.sim_stats.way_allocations) == 2);
+        REQUIRE(uut.sim_stats.way_allocations.at(0).first == 100);
+        REQUIRE(uut.sim_stats.way_allocations.at(1).first == 200);
+        for (const auto& allocation : uut.sim_stats.way_allocations)
+          REQUIRE(std::accumulate(std::begin(allocation.second), std::end(allocation.second), 0u) == uut.NUM_WAY);
+      }
+    }
+  }
+}
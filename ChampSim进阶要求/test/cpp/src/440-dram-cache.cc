@@ -0,0 +1,264 @@
+#include <catch.hpp>
+#include "mocks.hpp"
+#include "dram_cache.h"
+#include "champsim_constants.h"
+
+namespace
+{
+template <typename MRP, std::size_t N>
+void issue(MRP& mock_ul, std::array<champsim::operable*, N>& elements, uint64_t address, access_type type)
+{
+  typename MRP::request_type test;
+  test.address = address;
+  test.is_translated = true;
+  test.cpu = 0;
+  test.type = type;
+  test.response_requested = (type != access_type::WRITE);
+  mock_ul.issue(test);
+
+  for (auto i = 0; i < 1000; ++i)
+    for (auto elem : elements)
+      elem->_operate();
+}
+} // namespace
+
+SCENARIO("A DRAM cache keeps the blocks it fetches") {
+  GIVEN("An empty direct-mapped DRAM cache") {
+    constexpr uint64_t memory_latency = 200;
+    do_nothing_MRC mock_ll{memory_latency};
+    to_rq_MRP mock_ul;
+    DRAM_CACHE uut{DRAM_CACHE::Builder{}
+      .name("440a-uut")
+      .sets(64)
+      .ways(1)
+      .banks(2)
+      .columns(4)
+      .upper_levels({&mock_ul.queues})
+      .lower_level(&mock_ll.queues)
+    };
+
+    std::array<champsim::operable*, 3> elements{{&mock_ul, &uut, &mock_ll}};
+
+    for (auto elem : elements) {
+      elem->initialize();
+      elem->warmup = false;
+      elem->begin_phase();
+    }
+
+    WHEN("A block is loaded twice") {
+      issue(mock_ul, elements, 0xdeadbe00, access_type::LOAD);
+      issue(mock_ul, elements, 0xdeadbe00, access_type::LOAD);
+
+      THEN("Only the first load goes to memory") {
+        REQUIRE(mock_ll.packet_count() == 1);
+        REQUIRE(uut.sim_stats.read_misses == 1);
+        REQUIRE(uut.sim_stats.read_hits == 1);
+      }
+
+      THEN("The hit returns sooner than the miss") {
+        auto miss_latency = mock_ul.packets.at(0).return_time - mock_ul.packets.at(0).issue_time;
+        auto hit_latency = mock_ul.packets.at(1).return_time - mock_ul.packets.at(1).issue_time;
+        REQUIRE(miss_latency > memory_latency);
+        REQUIRE(hit_latency < memory_latency);
+      }
+    }
+  }
+}
+
+SCENARIO("A DRAM cache writes back its dirty victims") {
+  GIVEN("An empty direct-mapped DRAM cache") {
+    do_nothing_MRC mock_ll;
+    to_wq_MRP mock_writer;
+    to_rq_MRP mock_reader;
+    DRAM_CACHE uut{DRAM_CACHE::Builder{}
+      .name("440b-uut")
+      .sets(64)
+      .ways(1)
+      .upper_levels({&mock_writer.queues, &mock_reader.queues})
+      .lower_level(&mock_ll.queues)
+    };
+
+    std::array<champsim::operable*, 4> elements{{&mock_writer, &mock_reader, &uut, &mock_ll}};
+
+    for (auto elem : elements) {
+      elem->initialize();
+      elem->warmup = false;
+      elem->begin_phase();
+    }
+
+    WHEN("A written block is evicted by a load to the same set") {
+      issue(mock_writer, elements, 0xdeadbe00, access_type::WRITE);
+      issue(mock_reader, elements, 0xdeadbe00 + (64 << LOG2_BLOCK_SIZE), access_type::LOAD);
+
+      THEN("The write is allocated without reading memory") {
+        REQUIRE(uut.sim_stats.write_misses == 1);
+      }
+
+      THEN("The written block is sent to memory") {
+        REQUIRE(uut.sim_stats.writebacks == 1);
+        REQUIRE(mock_ll.packet_count() == 2);
+        REQUIRE(mock_ll.addresses.back() == 0xdeadbe00);
+      }
+    }
+  }
+}
+
+SCENARIO("A DRAM cache does not overwrite a block written while it was being fetched") {
+  GIVEN("An empty direct-mapped DRAM cache in front of a slow memory") {
+    constexpr uint64_t memory_latency = 1000;
+    constexpr uint64_t written_data = 0xcafe;
+    constexpr uint64_t address = 0xdeadbe00;
+    uint64_t returned_data = 0;
+    do_nothing_MRC mock_ll{memory_latency};
+    to_wq_MRP mock_writer;
+    to_rq_MRP mock_reader{[&](auto x, auto y) {
+      if (x.address == y.address)
+        returned_data = y.data;
+      return x.address == y.address;
+    }};
+    DRAM_CACHE uut{DRAM_CACHE::Builder{}
+      .name("440c-uut")
+      .sets(64)
+      .ways(1)
+      .upper_levels({&mock_writer.queues, &mock_reader.queues})
+      .lower_level(&mock_ll.queues)
+    };
+
+    std::array<champsim::operable*, 4> elements{{&mock_writer, &mock_reader, &uut, &mock_ll}};
+
+    for (auto elem : elements) {
+      elem->initialize();
+      elem->warmup = false;
+      elem->begin_phase();
+    }
+
+    WHEN("A block is written while a load of it misses") {
+      decltype(mock_reader)::request_type load;
+      load.address = address;
+      load.is_translated = true;
+      load.cpu = 0;
+      load.type = access_type::LOAD;
+      mock_reader.issue(load);
+
+      for (auto i = 0; mock_ll.packet_count() == 0 && i < 1000; ++i)
+        for (auto elem : elements)
+          elem->_operate();
+
+      decltype(mock_writer)::request_type write;
+      write.address = address;
+      write.is_translated = true;
+      write.cpu = 0;
+      write.type = access_type::WRITE;
+      write.data = written_data;
+      write.response_requested = false;
+      mock_writer.issue(write);
+
+      for (auto i = 0; i < 2000; ++i)
+        for (auto elem : elements)
+          elem->_operate();
+
+      THEN("The write reached the DRAM cache before the fill") {
+        REQUIRE(mock_ll.packet_count() == 1);
+        REQUIRE(uut.sim_stats.write_hits + uut.sim_stats.write_misses == 1);
+      }
+
+      AND_WHEN("The block is loaded again") {
+        issue(mock_reader, elements, address, access_type::LOAD);
+
+        THEN("The written data is returned") {
+          REQUIRE(uut.sim_stats.read_hits == 1);
+          REQUIRE(returned_data == written_data);
+        }
+      }
+    }
+  }
+}
+
+SCENARIO("A DRAM cache stops installing blocks while its writebacks are full") {
+  GIVEN("A direct-mapped DRAM cache whose lower level does not accept writes") {
+    constexpr std::size_t mshr_size = 2;
+    champsim::channel lower_queues{32, 32, 1, LOG2_BLOCK_SIZE, false};
+    to_wq_MRP mock_writer;
+    DRAM_CACHE uut{DRAM_CACHE::Builder{}
+      .name("440d-uut")
+      .sets(64)
+      .ways(1)
+      .mshr_size(mshr_size)
+      .upper_levels({&mock_writer.queues})
+      .lower_level(&lower_queues)
+    };
+
+    std::array<champsim::operable*, 2> elements{{&mock_writer, &uut}};
+
+    for (auto elem : elements) {
+      elem->initialize();
+      elem->warmup = false;
+      elem->begin_phase();
+    }
+
+    WHEN("More blocks are written to one set than there is room for their victims") {
+      constexpr uint64_t num_writes = 6;
+      for (uint64_t i = 0; i < num_writes; ++i)
+        issue(mock_writer, elements, 0xdeadbe00 + (i * 64 << LOG2_BLOCK_SIZE), access_type::WRITE);
+
+      THEN("The writes stop when the writebacks are full") {
+        REQUIRE(std::size(lower_queues.WQ) == 1);
+        REQUIRE(uut.sim_stats.writebacks == 1 + mshr_size);
+        REQUIRE(uut.sim_stats.write_misses == 2 + mshr_size);
+      }
+
+      AND_WHEN("The lower level accepts the writebacks") {
+        for (auto i = 0; i < 1000; ++i) {
+          lower_queues.WQ.clear();
+          for (auto elem : elements)
+            elem->_operate();
+        }
+
+        THEN("The remaining writes are installed") {
+          REQUIRE(uut.sim_stats.write_misses == num_writes);
+          REQUIRE(uut.sim_stats.writebacks == num_writes - 1);
+        }
+      }
+    }
+  }
+}
+
+SCENARIO("A tag cache avoids reading the tags from DRAM") {
+  GIVEN("A set-associative DRAM cache with a tag cache") {
+    do_nothing_MRC mock_ll;
+    to_rq_MRP mock_ul;
+    DRAM_CACHE uut{DRAM_CACHE::Builder{}
+      .name("440c-uut")
+      .sets(64)
+      .ways(4)
+      .tag_cache(8)
+      .tag_latency(2)
+      .upper_levels({&mock_ul.queues})
+      .lower_level(&mock_ll.queues)
+    };
+
+    std::array<champsim::operable*, 3> elements{{&mock_ul, &uut, &mock_ll}};
+
+    for (auto elem : elements) {
+      elem->initialize();
+      elem->warmup = false;
+      elem->begin_phase();
+    }
+
+    WHEN("Two blocks of the same set are loaded") {
+      issue(mock_ul, elements, 0xdeadbe00, access_type::LOAD);
+      issue(mock_ul, elements, 0xdeadbe00 + (64 << LOG2_BLOCK_SIZE), access_type::LOAD);
+
+      THEN("The second lookup finds the tags of the set in the tag cache") {
+        REQUIRE(uut.sim_stats.tag_cache_misses == 1);
+        REQUIRE(uut.sim_stats.tag_cache_hits == 1);
+      }
+
+      THEN("A miss found in the tag cache does not access the DRAM before going to memory") {
+        REQUIRE(uut.sim_stats.read_misses == 2);
+        // The first lookup reads the tags and fills the block. The second only fills the block.
+        REQUIRE(uut.sim_stats.row_buffer_hits + uut.sim_stats.row_buffer_misses == 3);
+      }
+    }
+  }
+}
@@ -0,0 +1,194 @@
+#include <catch.hpp>
+#include "mocks.hpp"
+#include "defaults.hpp"
+#include "access_replay.h"
+#include "access_trace.h"
+#include "cache.h"
+#include "champsim_constants.h"
+
+#include <cstdio>
+
+namespace
+{
+  champsim::access_trace_record lookup(uint64_t addr)
+  {
+    return {addr, 0, 0, 0, champsim::to_underlying(access_type::LOAD), 0};
+  }
+
+  champsim::access_trace_record fill(uint64_t addr)
+  {
+    return {addr, 0, 0, 0, champsim::to_underlying(access_type::LOAD), champsim::access_trace_record::FILL};
+  }
+
+  uint64_t total_hits(const cache_stats& stats)
+  {
+    return stats.hits.at(champsim::to_underlying(access_type::LOAD)).at(0);
+  }
+
+  uint64_t total_misses(const cache_stats& stats)
+  {
+    return stats.misses.at(champsim::to_underlying(access_type::LOAD)).at(0);
+  }
+}
+
+SCENARIO("A cache records its accesses to an access trace") {
+  GIVEN("A cache that records an access trace") {
+    const std::string trace_name{"443a-access-trace.bin"};
+    constexpr uint64_t address = 0xdeadbeef;
+
+    {
+      release_MRC mock_ll;
+      to_rq_MRP mock_ul;
+      CACHE uut{CACHE::Builder{champsim::defaults::default_llc}
+        .name("443a-uut")
+        .sets(1)
+        .ways(1)
+        .upper_levels({&mock_ul.queues})
+        .lower_level(&mock_ll.queues)
+        .offset_bits(0)
+        .access_trace(trace_name)
+      };
+
+      std::array<champsim::operable*, 3> elements{{&mock_ll, &mock_ul, &uut}};
+
+      for (auto elem : elements) {
+        elem->initialize();
+        elem->warmup = false;
+        elem->begin_phase();
+      }
+
+      decltype(mock_ul)::request_type test;
+      test.address = address;
+      test.ip = 0xcafebabe;
+      test.is_translated = true;
+      test.cpu = 0;
+      test.type = access_type::LOAD;
+
+      // Miss, fill, then hit
+      mock_ul.issue(test);
+      for (auto i = 0; i < 100; ++i)
+        for (auto elem : elements)
+          elem->_operate();
+
+      mock_ll.release(address);
+      for (auto i = 0; i < 100; ++i)
+        for (auto elem : elements)
+          elem->_operate();
+
+      mock_ul.issue(test);
+      for (auto i = 0; i < 100; ++i)
+        for (auto elem : elements)
+          elem->_operate();
+    }
+
+    WHEN("The trace is read back") {
+      auto recorded = champsim::read_access_trace(trace_name);
+      std::remove(trace_name.c_str());
+
+      THEN("The header describes the cache geometry") {
+        CHECK(recorded.header.sets == 1);
+        CHECK(recorded.header.ways == 1);
+        CHECK(recorded.header.offset_bits == 0);
+      }
+
+      THEN("The miss, the fill, and the hit are recorded in order") {
+        REQUIRE(std::size(recorded.records) == 3);
+
+        CHECK(recorded.records.at(0).address == address);
+        CHECK(recorded.records.at(0).ip == 0xcafebabe);
+        CHECK_FALSE(recorded.records.at(0).is_hit());
+        CHECK_FALSE(recorded.records.at(0).is_fill());
+
+        CHECK(recorded.records.at(1).address == address);
+        CHECK(recorded.records.at(1).is_fill());
+
+        CHECK(recorded.records.at(2).address == address);
+        CHECK(recorded.records.at(2).is_hit());
+        CHECK_FALSE(recorded.records.at(2).is_fill());
+
+        CHECK(recorded.records.at(0).cycle <= recorded.records.at(1).cycle);
+        CHECK(recorded.records.at(1).cycle <= recorded.records.at(2).cycle);
+        CHECK(recorded.records.at(0).type == champsim::to_underlying(access_type::LOAD));
+        CHECK_FALSE(recorded.records.at(0).is_warmup());
+      }
+    }
+  }
+}
+
+SCENARIO("A recorded access stream can be replayed through a replacement policy") {
+  GIVEN("A two-way cache with LRU replacement and a stream that thrashes it") {
+    do_nothing_MRC mock_ll;
+    CACHE uut{CACHE::Builder{champsim::defaults::default_llc}
+      .name("443b-uut")
+      .sets(1)
+      .ways(2)
+      .lower_level(&mock_ll.queues)
+      .offset_bits(0)
+      .replacement<CACHE::rreplacementDlru>()
+    };
+
+    std::vector<champsim::access_trace_record> stream{lookup(0xa), lookup(0xb), lookup(0xc), lookup(0xa)};
+
+    WHEN("The stream is replayed") {
+      auto stats = champsim::replay_access_trace(uut, stream);
+
+      THEN("Every access misses") {
+        CHECK(total_hits(stats) == 0);
+        CHECK(total_misses(stats) == 4);
+      }
+    }
+
+    WHEN("The optimal policy is computed") {
+      auto stats = champsim::replay_optimal(uut.NUM_SET, uut.NUM_WAY, uut.OFFSET_BITS, stream);
+
+      THEN("The block that is reused is kept") {
+        CHECK(total_hits(stats) == 1);
+        CHECK(total_misses(stats) == 3);
+      }
+    }
+  }
+}
+
+SCENARIO("Replaying recorded fills allocates blocks only where they were filled") {
+  GIVEN("A one-way cache with LRU replacement") {
+    do_nothing_MRC mock_ll;
+    CACHE uut{CACHE::Builder{champsim::defaults::default_llc}
+      .name("443c-uut")
+      .sets(1)
+      .ways(1)
+      .lower_level(&mock_ll.queues)
+      .offset_bits(0)
+      .replacement<CACHE::rreplacementDlru>()
+    };
+
+    // The second lookup arrives before the fill of the first, as it would for a merged miss
+    std::vector<champsim::access_trace_record> stream{lookup(0xa), lookup(0xa), fill(0xa), lookup(0xa)};
+
+    WHEN("The stream is replayed, filling on each miss") {
+      auto stats = champsim::replay_access_trace(uut, stream, champsim::replay_fill_policy::fill_on_miss);
+
+      THEN("The second lookup hits") {
+        CHECK(total_hits(stats) == 2);
+        CHECK(total_misses(stats) == 1);
+      }
+    }
+
+    WHEN("The stream is replayed with the recorded fills") {
+      auto stats = champsim::replay_access_trace(uut, stream, champsim::replay_fill_policy::recorded_fills);
+
+      THEN("Only the lookup after the fill hits") {
+        CHECK(total_hits(stats) == 1);
+        CHECK(total_misses(stats) == 2);
+      }
+    }
+
+    WHEN("The optimal policy is computed with the recorded fills") {
+      auto stats = champsim::replay_optimal(uut.NUM_SET, uut.NUM_WAY, uut.OFFSET_BITS, stream, champsim::replay_fill_policy::recorded_fills);
+
+      THEN("Only the lookup after the fill hits") {
+        CHECK(total_hits(stats) == 1);
+        CHECK(total_misses(stats) == 2);
+      }
+    }
+  }
+}
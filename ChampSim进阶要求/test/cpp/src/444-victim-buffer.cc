@@ -0,0 +1,115 @@
+#include <catch.hpp>
+#include "mocks.hpp"
+#include "defaults.hpp"
+#include "cache.h"
+#include "champsim_constants.h"
+
+namespace
+{
+template <typename MRP, std::size_t N>
+void issue(MRP& mock_ul, std::array<champsim::operable*, N>& elements, uint64_t address, access_type type)
+{
+  typename MRP::request_type test;
+  test.address = address;
+  test.is_translated = true;
+  test.cpu = 0;
+  test.type = type;
+  test.response_requested = (type != access_type::WRITE);
+  mock_ul.issue(test);
+
+  for (auto i = 0; i < 100; ++i)
+    for (auto elem : elements)
+      elem->_operate();
+}
+} // namespace
+
+SCENARIO("A victim buffer returns a recently evicted block") {
+  GIVEN("A cache with one block and a victim buffer of two") {
+    do_nothing_MRC mock_ll;
+    to_rq_MRP mock_ul;
+    CACHE uut{CACHE::Builder{champsim::defaults::default_l1d}
+      .name("444a-uut")
+      .sets(1)
+      .ways(1)
+      .victim_buffer(2)
+      .upper_levels({&mock_ul.queues})
+      .lower_level(&mock_ll.queues)
+      .offset_bits(LOG2_BLOCK_SIZE)
+    };
+
+    std::array<champsim::operable*, 3> elements{{&mock_ul, &uut, &mock_ll}};
+
+    for (auto elem : elements) {
+      elem->initialize();
+      elem->warmup = false;
+      elem->begin_phase();
+    }
+
+    WHEN("A block is loaded again after another block evicts it") {
+      issue(mock_ul, elements, 0xdeadbe00, access_type::LOAD);
+      issue(mock_ul, elements, 0xcafeba00, access_type::LOAD);
+      issue(mock_ul, elements, 0xdeadbe00, access_type::LOAD);
+
+      THEN("The load is served from the victim buffer") {
+        REQUIRE(mock_ll.packet_count() == 2);
+        REQUIRE(uut.sim_stats.victim_misses == 2);
+        REQUIRE(uut.sim_stats.victim_hits == 1);
+        REQUIRE(uut.sim_stats.victim_swaps == 1);
+        REQUIRE(uut.sim_stats.hits.at(champsim::to_underlying(access_type::LOAD)).at(0) == 1);
+      }
+
+      AND_WHEN("The block it replaced is loaded again") {
+        issue(mock_ul, elements, 0xcafeba00, access_type::LOAD);
+
+        THEN("That block was swapped into the victim buffer") {
+          REQUIRE(mock_ll.packet_count() == 2);
+          REQUIRE(uut.sim_stats.victim_hits == 2);
+          REQUIRE(uut.sim_stats.victim_swaps == 2);
+        }
+      }
+    }
+  }
+}
+
+SCENARIO("A block that leaves the victim buffer is written back if it is dirty") {
+  GIVEN("A cache with one block and a victim buffer of one") {
+    do_nothing_MRC mock_ll;
+    to_wq_MRP mock_writer;
+    to_rq_MRP mock_reader;
+    CACHE uut{CACHE::Builder{champsim::defaults::default_l2c}
+      .name("444b-uut")
+      .sets(1)
+      .ways(1)
+      .victim_buffer(1)
+      .upper_levels({&mock_writer.queues, &mock_reader.queues})
+      .lower_level(&mock_ll.queues)
+      .offset_bits(LOG2_BLOCK_SIZE)
+    };
+
+    std::array<champsim::operable*, 4> elements{{&mock_writer, &mock_reader, &uut, &mock_ll}};
+
+    for (auto elem : elements) {
+      elem->initialize();
+      elem->warmup = false;
+      elem->begin_phase();
+    }
+
+    WHEN("A written block is followed by two loads") {
+      issue(mock_writer, elements, 0xdeadbe00, access_type::WRITE);
+      issue(mock_reader, elements, 0xcafeba00, access_type::LOAD);
+
+      THEN("The written block waits in the victim buffer") {
+        REQUIRE(mock_ll.packet_count() == 1);
+      }
+
+      AND_WHEN("A third block evicts the loaded one into the buffer") {
+        issue(mock_reader, elements, 0xbeefca00, access_type::LOAD);
+
+        THEN("The written block is sent to the lower level") {
+          REQUIRE(mock_ll.packet_count() == 3);
+          REQUIRE(mock_ll.addresses.back() == 0xdeadbe00);
+        }
+      }
+    }
+  }
+}
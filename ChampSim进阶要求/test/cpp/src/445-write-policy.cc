@@ -0,0 +1,113 @@
+#include <catch.hpp>
+#include "mocks.hpp"
+#include "defaults.hpp"
+#include "cache.h"
+
+namespace
+{
+template <typename MRP, std::size_t N>
+void issue(MRP& mock_ul, std::array<champsim::operable*, N>& elements, uint64_t address, access_type type)
+{
+  typename MRP::request_type test;
+  test.address = address;
+  test.is_translated = true;
+  test.cpu = 0;
+  test.type = type;
+  test.response_requested = (type != access_type::WRITE);
+  mock_ul.issue(test);
+
+  for (auto i = 0; i < 100; ++i)
+    for (auto elem : elements)
+      elem->_operate();
+}
+} // namespace
+
+SCENARIO("A write-allocate cache reads the block of a store that misses") {
+  GIVEN("An empty write-allocate L1D") {
+    do_nothing_MRC mock_ll;
+    to_wq_MRP mock_writer;
+    to_rq_MRP mock_reader;
+    CACHE uut{CACHE::Builder{champsim::defaults::default_l1d}
+      .name("445a-uut")
+      .upper_levels({&mock_writer.queues, &mock_reader.queues})
+      .lower_level(&mock_ll.queues)
+    };
+
+    std::array<champsim::operable*, 4> elements{{&mock_writer, &mock_reader, &uut, &mock_ll}};
+
+    for (auto elem : elements) {
+      elem->initialize();
+      elem->warmup = false;
+      elem->begin_phase();
+    }
+
+    WHEN("A store misses, and then the block is loaded") {
+      issue(mock_writer, elements, 0xdeadbe00, access_type::WRITE);
+      issue(mock_reader, elements, 0xdeadbe00, access_type::LOAD);
+
+      THEN("The store reads the block for ownership, and the load hits") {
+        REQUIRE(mock_ll.packet_count() == 1);
+        REQUIRE(uut.sim_stats.write_arounds == 0);
+        REQUIRE(uut.sim_stats.hits.at(champsim::to_underlying(access_type::LOAD)).at(0) == 1);
+      }
+
+      THEN("The bytes of the store are counted") {
+        REQUIRE(uut.sim_stats.bytes_written == BLOCK_SIZE);
+      }
+    }
+  }
+}
+
+SCENARIO("A no-write-allocate cache sends a store that misses to its lower level") {
+  GIVEN("An empty no-write-allocate L1D") {
+    do_nothing_MRC mock_ll;
+    to_wq_MRP mock_writer;
+    to_rq_MRP mock_reader;
+    CACHE uut{CACHE::Builder{champsim::defaults::default_l1d}
+      .name("445b-uut")
+      .write_policy(champsim::write_policy::no_write_allocate)
+      .upper_levels({&mock_writer.queues, &mock_reader.queues})
+      .lower_level(&mock_ll.queues)
+    };
+
+    std::array<champsim::operable*, 4> elements{{&mock_writer, &mock_reader, &uut, &mock_ll}};
+
+    for (auto elem : elements) {
+      elem->initialize();
+      elem->warmup = false;
+      elem->begin_phase();
+    }
+
+    WHEN("A store misses, and then the block is loaded") {
+      issue(mock_writer, elements, 0xdeadbe00, access_type::WRITE);
+      issue(mock_reader, elements, 0xdeadbe00, access_type::LOAD);
+
+      THEN("The store is written around the cache, and the load misses") {
+        REQUIRE(mock_ll.packet_count() == 2);
+        REQUIRE(uut.sim_stats.write_arounds == 1);
+        REQUIRE(uut.sim_stats.misses.at(champsim::to_underlying(access_type::LOAD)).at(0) == 1);
+      }
+    }
+
+    WHEN("A block is loaded, and then stored to") {
+      issue(mock_reader, elements, 0xdeadbe00, access_type::LOAD);
+      issue(mock_writer, elements, 0xdeadbe00, access_type::WRITE);
+
+      THEN("The store hits") {
+        REQUIRE(mock_ll.packet_count() == 1);
+        REQUIRE(uut.sim_stats.write_arounds == 0);
+        REQUIRE(uut.sim_stats.hits.at(champsim::to_underlying(access_type::WRITE)).at(0) == 1);
+      }
+    }
+  }
+}
+
+SCENARIO("An exclusive cache must allocate its writes") {
+  THEN("Building an exclusive, no-write-allocate cache throws") {
+    REQUIRE_THROWS_AS(CACHE{CACHE::Builder{champsim::defaults::default_llc}
+                                .name("445c-uut")
+                                .inclusion(champsim::inclusion_policy::exclusive)
+                                .write_policy(champsim::write_policy::no_write_allocate)},
+                      std::invalid_argument);
+  }
+}
@@ -0,0 +1,120 @@
+#include <catch.hpp>
+#include "mocks.hpp"
+#include "defaults.hpp"
+#include "cache.h"
+
+namespace
+{
+// A cache with a single MSHR, which a demand miss holds while the lower level takes its time
+struct full_mshr_fixture {
+  do_nothing_MRC mock_ll{1000};
+  to_rq_MRP mock_ul;
+  CACHE uut;
+  std::array<champsim::operable*, 3> elements{{&mock_ul, &uut, &mock_ll}};
+
+  template <typename B>
+  explicit full_mshr_fixture(B builder) : uut{builder.mshr_size(1).upper_levels({&mock_ul.queues}).lower_level(&mock_ll.queues)}
+  {
+    for (auto elem : elements) {
+      elem->initialize();
+      elem->warmup = false;
+      elem->begin_phase();
+    }
+
+    decltype(mock_ul)::request_type test;
+    test.address = 0xdeadbe00;
+    test.is_translated = true;
+    test.cpu = 0;
+    mock_ul.issue(test);
+    run();
+  }
+
+  void run()
+  {
+    for (auto i = 0; i < 20; ++i)
+      for (auto elem : elements)
+        elem->_operate();
+  }
+};
+} // namespace
+
+SCENARIO("By default, a prefetch waits for a free MSHR") {
+  GIVEN("A cache whose MSHR is full") {
+    full_mshr_fixture fixture{CACHE::Builder{champsim::defaults::default_l1d}.name("446a-uut")};
+
+    WHEN("A prefetch that would not fill the cache is issued") {
+      fixture.uut.prefetch_line(0xcafeba00, false, 0);
+      fixture.run();
+
+      THEN("It is not sent to the lower level") {
+        REQUIRE(fixture.mock_ll.packet_count() == 1);
+      }
+    }
+  }
+}
+
+SCENARIO("A prefetch that would not fill the cache may be forwarded without an MSHR") {
+  GIVEN("A cache whose MSHR is full, and which forwards such prefetches") {
+    full_mshr_fixture fixture{CACHE::Builder{champsim::defaults::default_l1d}.name("446b-uut").full_mshr_prefetch(champsim::full_mshr_policy::forward)};
+
+    WHEN("A prefetch that would not fill the cache is issued") {
+      fixture.uut.prefetch_line(0xcafeba00, false, 0);
+      fixture.run();
+
+      THEN("It is sent to the lower level") {
+        REQUIRE(fixture.mock_ll.packet_count() == 2);
+        REQUIRE(std::size(fixture.uut.MSHR) == 1);
+      }
+    }
+  }
+}
+
+SCENARIO("A cache's own prefetches may be dropped when the MSHR is full") {
+  GIVEN("A cache whose MSHR is full, and which drops its prefetches") {
+    full_mshr_fixture fixture{CACHE::Builder{champsim::defaults::default_l1d}.name("446c-uut").full_mshr_prefetch(champsim::full_mshr_policy::drop)};
+
+    WHEN("A prefetch that would fill the cache is followed by one that would not") {
+      fixture.uut.prefetch_line(0xcafeba00, true, 0);
+      fixture.uut.prefetch_line(0xbeefca00, false, 0);
+      fixture.run();
+
+      THEN("The first is dropped, and the second is sent to the lower level") {
+        REQUIRE(fixture.uut.sim_stats.pf_dropped == 1);
+        REQUIRE(fixture.mock_ll.packet_count() == 2);
+        REQUIRE(fixture.mock_ll.addresses.back() == 0xbeefca00);
+      }
+    }
+  }
+}
+
+SCENARIO("A cache may hold MSHRs apart for its prefetches") {
+  GIVEN("A cache whose MSHR is full, with one MSHR for prefetches") {
+    full_mshr_fixture fixture{CACHE::Builder{champsim::defaults::default_l1d}.name("446d-uut").prefetch_mshr_size(1)};
+
+    WHEN("Two prefetches that would fill the cache are issued") {
+      fixture.uut.prefetch_line(0xcafeba00, true, 0);
+      fixture.uut.prefetch_line(0xbeefca00, true, 0);
+      fixture.run();
+
+      THEN("The first takes the prefetch MSHR, and the second waits") {
+        REQUIRE(std::size(fixture.uut.MSHR) == 2);
+        REQUIRE(fixture.mock_ll.packet_count() == 2);
+        REQUIRE(fixture.mock_ll.addresses.back() == 0xcafeba00);
+      }
+
+      THEN("The occupancy ratio of the MSHR does not exceed one") {
+        REQUIRE(fixture.uut.get_mshr_occupancy_ratio() == 1);
+      }
+
+      AND_WHEN("The first prefetch returns") {
+        for (auto i = 0; i < 100; ++i)
+          fixture.run();
+
+        THEN("The second takes the prefetch MSHR") {
+          REQUIRE(fixture.mock_ll.packet_count() == 3);
+          REQUIRE(fixture.mock_ll.addresses.back() == 0xbeefca00);
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,108 @@
+#include <catch.hpp>
+#include "mocks.hpp"
+#include "defaults.hpp"
+#include "cache.h"
+#include "champsim_constants.h"
+
+namespace
+{
+template <std::size_t N>
+void issue_load(to_rq_MRP& mock_ul, std::array<champsim::operable*, N>& elements, uint64_t address, int cycles)
+{
+  to_rq_MRP::request_type test;
+  test.address = address;
+  test.is_translated = true;
+  test.cpu = 0;
+  test.type = access_type::LOAD;
+  mock_ul.issue(test);
+
+  for (auto i = 0; i < cycles; ++i)
+    for (auto elem : elements)
+      elem->_operate();
+}
+} // namespace
+
+SCENARIO("A demand miss that merges into an inflight prefetch is counted as late") {
+  GIVEN("An empty cache with a slow lower level") {
+    constexpr uint64_t memory_latency = 50;
+    do_nothing_MRC mock_ll{memory_latency};
+    to_rq_MRP mock_ul;
+    CACHE uut{CACHE::Builder{champsim::defaults::default_l2c}
+      .name("447a-uut")
+      .upper_levels({&mock_ul.queues})
+      .lower_level(&mock_ll.queues)
+    };
+
+    std::array<champsim::operable*, 3> elements{{&mock_ul, &uut, &mock_ll}};
+
+    for (auto elem : elements) {
+      elem->initialize();
+      elem->warmup = false;
+      elem->begin_phase();
+    }
+
+    WHEN("A block is prefetched, and loaded before the prefetch returns") {
+      uut.prefetch_line(0xdeadbe00, true, 0);
+      for (auto i = 0; i < 10; ++i)
+        for (auto elem : elements)
+          elem->_operate();
+      issue_load(mock_ul, elements, 0xdeadbe00, 100);
+
+      THEN("The prefetch is useful, but late") {
+        REQUIRE(mock_ll.packet_count() == 1);
+        REQUIRE(uut.sim_stats.pf_useful == 1);
+        REQUIRE(uut.sim_stats.pf_late == 1);
+        REQUIRE(uut.sim_stats.pf_late_cycles > 0);
+        REQUIRE(uut.sim_stats.pf_late_cycles < memory_latency);
+      }
+    }
+  }
+}
+
+SCENARIO("Demand misses to blocks that prefetches displaced are counted") {
+  GIVEN("A cache with a single block") {
+    do_nothing_MRC mock_ll;
+    to_rq_MRP mock_ul;
+    CACHE uut{CACHE::Builder{champsim::defaults::default_l2c}
+      .name("447b-uut")
+      .sets(1)
+      .ways(1)
+      .upper_levels({&mock_ul.queues})
+      .lower_level(&mock_ll.queues)
+    };
+
+    std::array<champsim::operable*, 3> elements{{&mock_ul, &uut, &mock_ll}};
+
+    for (auto elem : elements) {
+      elem->initialize();
+      elem->warmup = false;
+      elem->begin_phase();
+    }
+
+    WHEN("A loaded block is evicted by a prefetch, and loaded again") {
+      issue_load(mock_ul, elements, 0xdeadbe00, 50);
+      uut.prefetch_line(0xcafeba00, true, 0);
+      for (auto i = 0; i < 50; ++i)
+        for (auto elem : elements)
+          elem->_operate();
+      issue_load(mock_ul, elements, 0xdeadbe00, 50);
+
+      THEN("The prefetch polluted the cache") {
+        REQUIRE(uut.sim_stats.pf_pollution == 1);
+      }
+
+      THEN("The prefetched block was evicted unused") {
+        REQUIRE(uut.sim_stats.pf_useless == 1);
+      }
+
+      AND_WHEN("The prefetched block is loaded") {
+        issue_load(mock_ul, elements, 0xcafeba00, 50);
+
+        THEN("The prefetch was early") {
+          REQUIRE(uut.sim_stats.pf_early == 1);
+          REQUIRE(uut.sim_stats.pf_early_cycles > 0);
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,192 @@
+#include <catch.hpp>
+#include "mocks.hpp"
+#include "defaults.hpp"
+#include "cache.h"
+#include "prefetch_throttle.h"
+
+#include <limits>
+#include <map>
+#include <vector>
+
+namespace test
+{
+  extern std::map<CACHE*, uint64_t> fill_prefetch_count;
+  extern std::map<CACHE*, std::vector<int>> fill_prefetch_status;
+}
+
+namespace
+{
+// Advance the totals by an interval of 100 prefetches, of which the given numbers were useful and late, and 1000 demand misses
+champsim::prefetch_feedback interval(champsim::prefetch_feedback totals, uint64_t useful, uint64_t late, uint64_t pollution, uint64_t bus_busy = 0)
+{
+  totals.issued += 100;
+  totals.useful += useful;
+  totals.late += late;
+  totals.pollution += pollution;
+  totals.demand_misses += 1000;
+  totals.bus_busy += bus_busy;
+  totals.bus_cycles += 100;
+  return totals;
+}
+} // namespace
+
+SCENARIO("The throttle follows the accuracy, lateness, and pollution of each interval") {
+  GIVEN("A new throttle") {
+    champsim::prefetch_throttle uut;
+    champsim::prefetch_feedback totals;
+
+    THEN("It begins at the middle level") {
+      REQUIRE(uut.level() == champsim::prefetch_throttle::middle_level);
+      REQUIRE(uut.budget() == 4);
+    }
+
+    WHEN("Accurate prefetches are late") {
+      totals = interval(totals, 90, 20, 0);
+      uut.update(totals);
+
+      THEN("The prefetcher becomes more aggressive") {
+        REQUIRE(uut.level() == champsim::prefetch_throttle::middle_level + 1);
+      }
+    }
+
+    WHEN("Inaccurate prefetches pollute the cache") {
+      totals = interval(totals, 10, 0, 50);
+      uut.update(totals);
+
+      THEN("The prefetcher becomes less aggressive") {
+        REQUIRE(uut.level() == champsim::prefetch_throttle::middle_level - 1);
+      }
+    }
+
+    WHEN("Moderately accurate, late prefetches compete for a busy memory") {
+      totals = interval(totals, 50, 20, 0, 90);
+      uut.update(totals);
+
+      THEN("The prefetcher becomes less aggressive") {
+        REQUIRE(uut.level() == champsim::prefetch_throttle::middle_level - 1);
+      }
+    }
+
+    WHEN("An interval issues no prefetches") {
+      totals.demand_misses += 1000;
+      totals.pollution += 100;
+      uut.update(totals);
+
+      THEN("The level does not change") {
+        REQUIRE(uut.level() == champsim::prefetch_throttle::middle_level);
+      }
+    }
+
+    WHEN("Many intervals pollute the cache") {
+      for (auto i = 0; i < 10; ++i) {
+        totals = interval(totals, 10, 0, 50);
+        uut.update(totals);
+      }
+
+      THEN("The prefetcher stops at the most conservative level") {
+        REQUIRE(uut.level() == 1);
+        REQUIRE(uut.budget() == 1);
+      }
+    }
+  }
+}
+
+SCENARIO("A throttled cache drops the prefetches beyond its budget") {
+  GIVEN("A cache that throttles its prefetcher") {
+    do_nothing_MRC mock_ll;
+    to_rq_MRP mock_ul;
+    CACHE uut{CACHE::Builder{champsim::defaults::default_l2c}
+      .name("448a-uut")
+      .prefetch_throttle_interval(1000)
+      .upper_levels({&mock_ul.queues})
+      .lower_level(&mock_ll.queues)
+    };
+
+    std::array<champsim::operable*, 3> elements{{&mock_ul, &uut, &mock_ll}};
+
+    for (auto elem : elements) {
+      elem->initialize();
+      elem->warmup = false;
+      elem->begin_phase();
+      elem->_operate();
+    }
+
+    WHEN("More prefetches than the budget of the middle level are requested at once") {
+      for (uint64_t i = 0; i < 6; ++i)
+        uut.prefetch_line(0xdeadbe00 + (i << LOG2_BLOCK_SIZE), true, 0);
+
+      THEN("Only the budget is issued") {
+        REQUIRE(uut.prefetch_throttle_level() == champsim::prefetch_throttle::middle_level);
+        REQUIRE(uut.sim_stats.pf_requested == 6);
+        REQUIRE(uut.sim_stats.pf_issued == 4);
+        REQUIRE(uut.sim_stats.pf_throttled == 2);
+      }
+    }
+  }
+
+  GIVEN("A throttled cache whose prefetcher issues prefetches when a block fills") {
+    do_nothing_MRC mock_ll{10};
+    to_rq_MRP mock_ul;
+    CACHE uut{CACHE::Builder{champsim::defaults::default_l2c}
+      .name("448c-uut")
+      .prefetch_throttle_interval(1000)
+      .upper_levels({&mock_ul.queues})
+      .lower_level(&mock_ll.queues)
+      .prefetcher<CACHE::ptestDcppDmodulesDprefetcherDfill_prefetcher>()
+    };
+
+    std::array<champsim::operable*, 3> elements{{&mock_ul, &uut, &mock_ll}};
+
+    for (auto elem : elements) {
+      elem->initialize();
+      elem->warmup = false;
+      elem->begin_phase();
+    }
+
+    test::fill_prefetch_count[&uut] = 2;
+
+    WHEN("A load fills after the budget of the previous trigger has been spent") {
+      decltype(mock_ul)::request_type test;
+      test.address = 0xcafeba00;
+      test.is_translated = true;
+      test.cpu = 0;
+      test.type = access_type::LOAD;
+      mock_ul.issue(test);
+
+      // Once the miss has returned, spend the whole budget before each cycle until the block fills
+      for (auto i = 0; i < 100 && std::empty(test::fill_prefetch_status[&uut]); ++i) {
+        if (!std::empty(uut.MSHR) && uut.MSHR.front().event_cycle != std::numeric_limits<uint64_t>::max()) {
+          for (uint64_t j = 0; j < champsim::prefetch_throttle{}.budget(); ++j)
+            uut.prefetch_line(0xdead0000 + (j << LOG2_BLOCK_SIZE), true, 0);
+        }
+        for (auto elem : elements)
+          elem->_operate();
+      }
+
+      THEN("The fill is a trigger with its own budget") {
+        REQUIRE(test::fill_prefetch_status[&uut] == std::vector<int>{champsim::prefetch_issued, champsim::prefetch_issued});
+      }
+    }
+  }
+
+  GIVEN("A cache that does not throttle its prefetcher") {
+    do_nothing_MRC mock_ll;
+    to_rq_MRP mock_ul;
+    CACHE uut{CACHE::Builder{champsim::defaults::default_l2c}
+      .name("448b-uut")
+      .upper_levels({&mock_ul.queues})
+      .lower_level(&mock_ll.queues)
+    };
+
+    WHEN("Many prefetches are requested at once") {
+      for (uint64_t i = 0; i < 6; ++i)
+        uut.prefetch_line(0xdeadbe00 + (i << LOG2_BLOCK_SIZE), true, 0);
+
+      THEN("None is throttled, and the level reads as the middle") {
+        REQUIRE(uut.prefetch_throttle_level() == champsim::prefetch_throttle::middle_level);
+        REQUIRE(uut.sim_stats.pf_throttled == 0);
+        REQUIRE(uut.sim_stats.pf_issued == 6);
+      }
+    }
+  }
+}
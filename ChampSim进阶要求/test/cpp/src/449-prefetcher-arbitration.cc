@@ -0,0 +1,145 @@
+#include <catch.hpp>
+#include "mocks.hpp"
+#include "defaults.hpp"
+#include "cache.h"
+#include "champsim_constants.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+template <std::size_t N>
+void run(std::array<champsim::operable*, N>& elements, int cycles)
+{
+  for (auto i = 0; i < cycles; ++i)
+    for (auto elem : elements)
+      elem->_operate();
+}
+
+bool requested(const do_nothing_MRC& mock, uint64_t address)
+{
+  return std::find(std::begin(mock.addresses), std::end(mock.addresses), address) != std::end(mock.addresses);
+}
+} // namespace
+
+SCENARIO("A cache with several prefetchers attributes their prefetches") {
+  GIVEN("A cache with the next line prefetcher and the do-nothing prefetcher") {
+    do_nothing_MRC mock_ll;
+    to_rq_MRP mock_ul;
+    CACHE uut{CACHE::Builder{champsim::defaults::default_l1d}
+      .name("449a-uut")
+      .upper_levels({&mock_ul.queues})
+      .lower_level(&mock_ll.queues)
+      .prefetcher<CACHE::pprefetcherDnext_line | CACHE::pprefetcherDno>()
+    };
+
+    std::array<champsim::operable*, 3> elements{{&mock_ll, &mock_ul, &uut}};
+
+    for (auto elem : elements) {
+      elem->initialize();
+      elem->warmup = false;
+      elem->begin_phase();
+    }
+
+    THEN("Each prefetcher has a slot") {
+      REQUIRE(std::size(uut.sim_stats.prefetchers) == 2);
+      REQUIRE(uut.sim_stats.prefetchers.at(0).name == "next_line");
+      REQUIRE(uut.sim_stats.prefetchers.at(1).name == "no");
+    }
+
+    WHEN("A load misses") {
+      decltype(mock_ul)::request_type seed;
+      seed.address = 0xffff'003f;
+      seed.instr_id = 1;
+      seed.cpu = 0;
+      mock_ul.issue(seed);
+      run(elements, 100);
+
+      THEN("The next line prefetch is issued and counted against the next line prefetcher") {
+        REQUIRE(mock_ll.packet_count() == 2);
+        REQUIRE(uut.sim_stats.prefetchers.at(0).requested == 1);
+        REQUIRE(uut.sim_stats.prefetchers.at(0).issued == 1);
+        REQUIRE(uut.sim_stats.prefetchers.at(1).requested == 0);
+      }
+
+      AND_WHEN("The prefetched block is loaded") {
+        decltype(mock_ul)::request_type next;
+        next.address = 0xffff'0040;
+        next.instr_id = 2;
+        next.cpu = 0;
+        mock_ul.issue(next);
+        run(elements, 100);
+
+        THEN("The prefetch is useful to the next line prefetcher") {
+          REQUIRE(uut.sim_stats.prefetchers.at(0).useful == 1);
+          REQUIRE(uut.sim_stats.prefetchers.at(1).useful == 0);
+        }
+      }
+    }
+  }
+}
+
+SCENARIO("A cache with several prefetchers arbitrates between their prefetches") {
+  GIVEN("A cache with two prefetchers and a prefetch queue of two entries") {
+    do_nothing_MRC mock_ll;
+    to_rq_MRP mock_ul;
+    CACHE uut{CACHE::Builder{champsim::defaults::default_l1d}
+      .name("449b-uut")
+      .pq_size(2)
+      .upper_levels({&mock_ul.queues})
+      .lower_level(&mock_ll.queues)
+      .prefetcher<CACHE::pprefetcherDnext_line | CACHE::pprefetcherDno>()
+    };
+
+    std::array<champsim::operable*, 3> elements{{&mock_ll, &mock_ul, &uut}};
+
+    for (auto elem : elements) {
+      elem->initialize();
+      elem->warmup = false;
+      elem->begin_phase();
+    }
+
+    WHEN("The same block is requested twice") {
+      auto first_status = uut.prefetch_line(0xdead'be00, true, 0);
+      auto second_status = uut.prefetch_line(0xdead'be00, true, 0);
+      run(elements, 100);
+
+      THEN("Both requests wait for arbitration") {
+        REQUIRE(first_status == champsim::prefetch_queued);
+        REQUIRE(second_status == champsim::prefetch_queued);
+      }
+
+      THEN("It is issued once") {
+        REQUIRE(uut.sim_stats.pf_requested == 2);
+        REQUIRE(uut.sim_stats.pf_issued == 1);
+        REQUIRE(uut.sim_stats.pf_duplicates == 1);
+        REQUIRE(mock_ll.packet_count() == 1);
+      }
+
+      THEN("The duplicate is not reported as dropped") {
+        REQUIRE(std::empty(uut.take_dropped_prefetches()));
+      }
+    }
+
+    WHEN("More blocks are requested than the queue holds") {
+      uut.prefetch_line(0xdead'be00, true, 0, 0.2);
+      uut.prefetch_line(0xcafe'ba00, true, 0, 0.9);
+      uut.prefetch_line(0xbeef'ca00, true, 0, 0.5);
+      run(elements, 100);
+
+      THEN("The most confident prefetches are issued") {
+        REQUIRE(uut.sim_stats.pf_issued == 2);
+        REQUIRE(uut.sim_stats.pf_outranked == 1);
+        REQUIRE(requested(mock_ll, 0xcafe'ba00));
+        REQUIRE(requested(mock_ll, 0xbeef'ca00));
+        REQUIRE_FALSE(requested(mock_ll, 0xdead'be00));
+      }
+
+      THEN("The least confident prefetch is reported as dropped, once") {
+        REQUIRE(uut.take_dropped_prefetches() == std::vector<uint64_t>{0xdead'be00});
+        REQUIRE(std::empty(uut.take_dropped_prefetches()));
+      }
+    }
+  }
+}
@@ -0,0 +1,102 @@
+#include <catch.hpp>
+#include "mocks.hpp"
+#include "defaults.hpp"
+#include "cache.h"
+#include "cache_hints.h"
+
+SCENARIO("The side channel keeps the most recent hint of each kind") {
+  GIVEN("An empty side channel") {
+    champsim::cache_hints uut;
+
+    THEN("Nothing is known") {
+      REQUIRE(uut.ip_reuse(0xcafe) == champsim::reuse_prediction::unknown);
+      REQUIRE(uut.region_reuse(0xdeadbeef) == champsim::reuse_prediction::unknown);
+      REQUIRE_FALSE(uut.occupancy().has_value());
+      REQUIRE_FALSE(uut.prefetch_confidence(0xdeadbeef).has_value());
+      REQUIRE_FALSE(uut.low_confidence_prefetch(0xdeadbeef));
+    }
+
+    WHEN("The replacement policy predicts a block dead") {
+      uut.predict_region(0xdeadbeef, champsim::reuse_prediction::dead);
+
+      THEN("The whole region is predicted dead") {
+        REQUIRE(uut.region_reuse(0xdeadb000) == champsim::reuse_prediction::dead);
+        REQUIRE(uut.region_reuse(0xdeadbfc0) == champsim::reuse_prediction::dead);
+        REQUIRE(uut.region_reuse(0xdeadc000) == champsim::reuse_prediction::unknown);
+      }
+
+      AND_WHEN("It later predicts the region reused") {
+        uut.predict_region(0xdeadb000, champsim::reuse_prediction::near);
+
+        THEN("The later prediction replaces the earlier") {
+          REQUIRE(uut.region_reuse(0xdeadbeef) == champsim::reuse_prediction::near);
+        }
+      }
+    }
+
+    WHEN("A prefetch is published with little confidence") {
+      uut.publish_confidence(0xdeadbeef, 0.2);
+
+      THEN("Its block is a low-confidence prefetch") {
+        REQUIRE(uut.prefetch_confidence(0xdeadbec0) == Approx(0.2));
+        REQUIRE(uut.low_confidence_prefetch(0xdeadbec0));
+        REQUIRE_FALSE(uut.low_confidence_prefetch(0xdeadbf00));
+      }
+    }
+
+    WHEN("An occupancy beyond the whole cache is published") {
+      uut.publish_occupancy(1.5);
+
+      THEN("It is limited to the whole cache") {
+        REQUIRE(uut.occupancy() == Approx(1.0));
+      }
+    }
+  }
+}
+
+SCENARIO("A cache does not prefetch into a region predicted dead") {
+  GIVEN("A cache above another cache") {
+    do_nothing_MRC mock_ll;
+    to_rq_MRP mock_ul;
+    CACHE lower{CACHE::Builder{champsim::defaults::default_llc}
+      .name("450-lower")
+    };
+    CACHE uut{CACHE::Builder{champsim::defaults::default_l2c}
+      .name("450-uut")
+      .upper_levels({&mock_ul.queues})
+      .lower_level(&mock_ll.queues)
+      .lower_cache(&lower)
+    };
+
+    WHEN("The prefetcher requests a block of a region that this cache's replacement policy predicts dead") {
+      uut.hints.predict_region(0xdeadbe00, champsim::reuse_prediction::dead);
+      uut.prefetch_line(0xdeadbe00, true, 0);
+
+      THEN("The prefetch is suppressed") {
+        REQUIRE(uut.sim_stats.pf_suppressed == 1);
+        REQUIRE(uut.sim_stats.pf_issued == 0);
+      }
+    }
+
+    WHEN("A prefetch that does not fill this cache is to a region that the lower cache predicts dead") {
+      lower.hints.predict_region(0xdeadbe00, champsim::reuse_prediction::dead);
+      uut.prefetch_line(0xdeadbe00, false, 0);
+      uut.prefetch_line(0xdeadbe40, true, 0);
+
+      THEN("Only the prefetch into the lower cache is suppressed") {
+        REQUIRE(uut.sim_stats.pf_suppressed == 1);
+        REQUIRE(uut.sim_stats.pf_issued == 1);
+      }
+    }
+
+    WHEN("The prefetcher requests a block with little confidence") {
+      uut.prefetch_line(0xdeadbe00, false, 0, 0.25);
+
+      THEN("Its confidence is published to both caches") {
+        REQUIRE(uut.sim_stats.pf_issued == 1);
+        REQUIRE(uut.hints.low_confidence_prefetch(0xdeadbe00));
+        REQUIRE(lower.hints.prefetch_confidence(0xdeadbe00) == Approx(0.25));
+      }
+    }
+  }
+}
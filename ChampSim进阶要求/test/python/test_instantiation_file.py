@@ -13,3 +13,171 @@ class VectorStringgTest(unittest.TestCase):
     def test_list_with_two(self):
         self.assertEqual(config.instantiation_file.vector_string(['a','b']), '{a, b}');
 
+
+class StaticGeometryTest(unittest.TestCase):
+
+    def test_dynamic_by_default(self):
+        self.assertIsNone(config.instantiation_file.static_geometry_args({'name': 'LLC', 'sets': 2048, 'ways': 16}))
+
+    def test_static_geometry(self):
+        elem = {'name': 'LLC', 'sets': 2048, 'ways': 16, 'static_geometry': True}
+        self.assertEqual(config.instantiation_file.static_geometry_args(elem), '2048, 16, champsim::lg2(BLOCK_SIZE)')
+
+    def test_static_geometry_requires_ways(self):
+        with self.assertRaises(ValueError):
+            config.instantiation_file.static_geometry_args({'name': 'LLC', 'sets': 2048, 'static_geometry': True})
+
+    def test_static_geometry_cannot_be_sectored(self):
+        with self.assertRaises(ValueError):
+            config.instantiation_file.static_geometry_args({'name': 'LLC', 'sets': 2048, 'ways': 16, 'static_geometry': True, 'sector_size': 4})
+
+    def test_instantiations_are_shared(self):
+        caches = [
+            {'name': 'cpu0_L2C', 'sets': 1024, 'ways': 8, 'static_geometry': True},
+            {'name': 'cpu1_L2C', 'sets': 1024, 'ways': 8, 'static_geometry': True},
+            {'name': 'LLC', 'sets': 2048, 'ways': 16}
+        ]
+        self.assertEqual(list(config.instantiation_file.get_cache_operate_instantiation_lines(caches)), [
+            'template long CACHE::operate_with<champsim::dynamic_geometry, CACHE::module_model<0, 0>>();',
+            'template long CACHE::operate_with<champsim::static_geometry<1024, 8, champsim::lg2(BLOCK_SIZE)>, CACHE::module_model<0, 0>>();'
+        ])
+
+class SetIndexTest(unittest.TestCase):
+
+    def test_modulo_by_default(self):
+        self.assertEqual(config.instantiation_file.set_index_arg({'name': 'LLC'}), 'champsim::set_index_function::modulo')
+
+    def test_named_functions(self):
+        self.assertEqual(config.instantiation_file.set_index_arg({'name': 'LLC', 'set_index': 'xor'}), 'champsim::set_index_function::xor_fold')
+        self.assertEqual(config.instantiation_file.set_index_arg({'name': 'LLC', 'set_index': 'prime'}), 'champsim::set_index_function::prime_modulo')
+        self.assertEqual(config.instantiation_file.set_index_arg({'name': 'LLC', 'set_index': 'skewed'}), 'champsim::set_index_function::skewed')
+
+    def test_unknown_function(self):
+        with self.assertRaises(ValueError):
+            config.instantiation_file.set_index_arg({'name': 'LLC', 'set_index': 'random'})
+
+    def test_hash_requires_dynamic_geometry(self):
+        with self.assertRaises(ValueError):
+            config.instantiation_file.set_index_arg({'name': 'LLC', 'sets': 2048, 'ways': 16, 'static_geometry': True, 'set_index': 'xor'})
+
+    def test_skewed_with_lru(self):
+        repl = [{'name': 'replacementDlru', 'fname': 'replacement/lru'}]
+        self.assertEqual(config.instantiation_file.set_index_arg({'name': 'LLC', 'set_index': 'skewed', '_replacement_data': repl}), 'champsim::set_index_function::skewed')
+
+    def test_skewed_rejects_other_replacement(self):
+        repl = [{'name': 'replacementDsrrip', 'fname': 'replacement/srrip'}]
+        with self.assertRaises(ValueError):
+            config.instantiation_file.set_index_arg({'name': 'LLC', 'set_index': 'skewed', '_replacement_data': repl})
+
+    def test_other_functions_accept_any_replacement(self):
+        repl = [{'name': 'replacementDsrrip', 'fname': 'replacement/srrip'}]
+        self.assertEqual(config.instantiation_file.set_index_arg({'name': 'LLC', 'set_index': 'xor', '_replacement_data': repl}), 'champsim::set_index_function::xor_fold')
+
+class InclusionTest(unittest.TestCase):
+
+    def test_default_is_non_inclusive(self):
+        self.assertEqual(config.instantiation_file.inclusion_arg({'name': 'LLC'}), 'champsim::inclusion_policy::non_inclusive')
+
+    def test_named_policies(self):
+        self.assertEqual(config.instantiation_file.inclusion_arg({'name': 'LLC', 'inclusion': 'inclusive'}), 'champsim::inclusion_policy::inclusive')
+        self.assertEqual(config.instantiation_file.inclusion_arg({'name': 'LLC', 'inclusion': 'exclusive'}), 'champsim::inclusion_policy::exclusive')
+
+    def test_unknown_policy_raises(self):
+        with self.assertRaises(ValueError):
+            config.instantiation_file.inclusion_arg({'name': 'LLC', 'inclusion': 'mostly'})
+
+class WritePolicyTest(unittest.TestCase):
+
+    def test_default_is_write_allocate(self):
+        self.assertEqual(config.instantiation_file.write_policy_arg({'name': 'L1D'}), 'champsim::write_policy::write_allocate')
+
+    def test_named_policies(self):
+        self.assertEqual(config.instantiation_file.write_policy_arg({'name': 'L1D', 'write_policy': 'no-write-allocate'}), 'champsim::write_policy::no_write_allocate')
+
+    def test_unknown_policy_raises(self):
+        with self.assertRaises(ValueError):
+            config.instantiation_file.write_policy_arg({'name': 'L1D', 'write_policy': 'write-through'})
+
+class FullMshrPrefetchTest(unittest.TestCase):
+
+    def test_default_is_stall(self):
+        self.assertEqual(config.instantiation_file.full_mshr_prefetch_arg({'name': 'L2C'}), 'champsim::full_mshr_policy::stall')
+
+    def test_named_policies(self):
+        self.assertEqual(config.instantiation_file.full_mshr_prefetch_arg({'name': 'L2C', 'full_mshr_prefetch': 'forward'}), 'champsim::full_mshr_policy::forward')
+        self.assertEqual(config.instantiation_file.full_mshr_prefetch_arg({'name': 'L2C', 'full_mshr_prefetch': 'drop'}), 'champsim::full_mshr_policy::drop')
+
+    def test_unknown_policy_raises(self):
+        with self.assertRaises(ValueError):
+            config.instantiation_file.full_mshr_prefetch_arg({'name': 'L2C', 'full_mshr_prefetch': 'retry'})
+
+class SliceTest(unittest.TestCase):
+
+    def test_unsliced_caches_are_unchanged(self):
+        caches, networks = config.instantiation_file.split_slices([{'name': 'LLC', 'sets': 2048}])
+        self.assertEqual(caches, [{'name': 'LLC', 'sets': 2048}])
+        self.assertEqual(networks, [])
+
+    def test_slices_share_the_sets_and_mshrs(self):
+        caches, networks = config.instantiation_file.split_slices([{'name': 'LLC', 'sets': 2048, 'mshr_size': 64, 'slices': 4, 'lower_level': 'DRAM'}])
+        self.assertEqual([c['name'] for c in caches], ['LLC_slice0', 'LLC_slice1', 'LLC_slice2', 'LLC_slice3'])
+        self.assertTrue(all(c['sets'] == 512 for c in caches))
+        self.assertTrue(all(c['mshr_size'] == 16 for c in caches))
+        self.assertTrue(all(c['lower_level'] == 'DRAM' for c in caches))
+        self.assertEqual(len(networks), 1)
+        self.assertEqual(networks[0]['name'], 'LLC')
+        self.assertEqual(networks[0]['_slices'], [c['name'] for c in caches])
+
+    def test_slices_must_be_a_power_of_two(self):
+        with self.assertRaises(ValueError):
+            config.instantiation_file.split_slices([{'name': 'LLC', 'sets': 2048, 'slices': 3}])
+
+    def test_sets_must_divide_among_slices(self):
+        with self.assertRaises(ValueError):
+            config.instantiation_file.split_slices([{'name': 'LLC', 'sets': 2, 'slices': 4}])
+
+    def test_unknown_topology_raises(self):
+        with self.assertRaises(ValueError):
+            config.instantiation_file.split_slices([{'name': 'LLC', 'sets': 2048, 'slices': 4, 'topology': 'torus'}])
+
+class DramCacheTest(unittest.TestCase):
+
+    def test_no_dram_cache(self):
+        caches, dram_caches = config.instantiation_file.insert_dram_cache([{'name': 'LLC', 'lower_level': 'DRAM'}], {'name': 'DRAM'})
+        self.assertEqual(caches, [{'name': 'LLC', 'lower_level': 'DRAM'}])
+        self.assertEqual(dram_caches, ())
+
+    def test_dram_cache_is_placed_above_the_memory(self):
+        caches, dram_caches = config.instantiation_file.insert_dram_cache(
+                [{'name': 'L2C', 'lower_level': 'LLC'}, {'name': 'LLC', 'lower_level': 'DRAM'}],
+                {'name': 'DRAM', 'dram_cache': {'name': 'DRC', 'sets': 1024}})
+        self.assertEqual([c['lower_level'] for c in caches], ['LLC', 'DRC'])
+        self.assertEqual(dram_caches, ({'name': 'DRC', 'sets': 1024, 'lower_level': 'DRAM'},))
+
+    def test_dram_cache_name_must_be_unique(self):
+        with self.assertRaises(ValueError):
+            config.instantiation_file.insert_dram_cache([{'name': 'LLC', 'lower_level': 'DRAM'}], {'name': 'DRAM', 'dram_cache': {'name': 'LLC'}})
+
+class ModuleBindingTest(unittest.TestCase):
+
+    def test_module_flags_are_ordered(self):
+        data = [{'name': 'prefetcherDnext_line'}, {'name': 'prefetcherDip_stride'}]
+        self.assertEqual(config.instantiation_file.module_flags('CACHE::p', data), 'CACHE::pprefetcherDip_stride | CACHE::pprefetcherDnext_line')
+
+    def test_no_modules(self):
+        self.assertEqual(config.instantiation_file.module_flags('CACHE::p', []), '0')
+
+    def test_caches_with_the_same_modules_share_an_instantiation(self):
+        caches = [
+            {'name': 'cpu0_L1D', '_prefetcher_data': [{'name': 'prefetcherDa'}, {'name': 'prefetcherDb'}], '_replacement_data': [{'name': 'replacementDlru'}]},
+            {'name': 'cpu1_L1D', '_prefetcher_data': [{'name': 'prefetcherDb'}, {'name': 'prefetcherDa'}], '_replacement_data': [{'name': 'replacementDlru'}]}
+        ]
+        self.assertEqual(list(config.instantiation_file.get_cache_operate_instantiation_lines(caches)), [
+            'template long CACHE::operate_with<champsim::dynamic_geometry, CACHE::module_model<CACHE::pprefetcherDa | CACHE::pprefetcherDb, CACHE::rreplacementDlru>>();'
+        ])
+
+    def test_core_instantiation(self):
+        cores = [{'name': 'cpu0', '_branch_predictor_data': [{'name': 'branchDbimodal'}], '_btb_data': [{'name': 'btbDbasic_btb'}]}]
+        self.assertEqual(list(config.instantiation_file.get_core_operate_instantiation_lines(cores)), [
+            'template long O3_CPU::operate_with<O3_CPU::module_model<O3_CPU::bbranchDbimodal, O3_CPU::tbtbDbasic_btb>>();'
+        ])
@@ -16,25 +16,31 @@
 
 #include <algorithm>
 #include <assert.h>
+#include <condition_variable>
 #include <cstdint>
+#include <deque>
+#include <limits>
+#include <lzma.h>
 #include <map>
+#include <mutex>
+#include <optional>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <zlib.h>
 
 #include "../../inc/trace_instruction.h"
 
-// defines for the paths for the various decompression programs and Apple/Linux differences
+// Apple/Linux differences
 
 #ifdef __APPLE__
-#define XZ_PATH "/opt/local/bin/xz"
-#define GZIP_PATH "/usr/bin/gzip"
-#define CAT_PATH "/bin/cat"
 #define UINT64 uint64_t
 #else
-#define XZ_PATH "/usr/bin/xz"
-#define GZIP_PATH "/bin/gzip"
-#define CAT_PATH "/bin/cat"
 #define UINT64 unsigned long long int
 #endif
 
@@ -95,6 +101,20 @@ const char* branch_names[] = {
 
 long long int counts[OPTYPE_MAX];
 
+namespace
+{
+constexpr char REG_AX = 56;
+
+// size of the blocks moved between the reader, parser, and writer threads
+constexpr std::size_t BLOCK_SIZE = 1 << 22;
+
+// number of records in one unit of work for the converter threads
+constexpr std::size_t BATCH_SIZE = 1 << 12;
+
+// the longest record: PC, type, address or target, and up to 255 input and 255 output registers, each output with a 16-byte value
+constexpr std::size_t MAX_RECORD_SIZE = 8 + 1 + 9 + (1 + 255) + (1 + 255) + 255 * 16;
+} // namespace
+
 // one record from the CVP-1 trace file format
 
 struct trace {
@@ -106,15 +126,21 @@ struct trace {
       taken, // branch was taken
       num_input_regs, num_output_regs, input_reg_names[256], output_reg_names[256];
 
-  // output register values could be up to 128 bits each
-  UINT64 output_reg_values[256][2];
-
   InstClass type; // instruction type
 
-  // read a single record from the trace file, return true on success, false on EOF
+  // decode a single record from the bytes in [p, end). return true and advance p on success,
+  // false (leaving p alone) if the buffer ends partway through the record
 
-  bool read(FILE* f)
+  bool parse(const uint8_t*& p, const uint8_t* end)
   {
+    const uint8_t* q = p;
+    auto take = [&](void* dst, std::size_t n) {
+      if (static_cast<std::size_t>(end - q) < n)
+        return false;
+      memcpy(dst, q, n);
+      q += n;
+      return true;
+    };
 
     // initialize
 
@@ -123,21 +149,13 @@ struct trace {
     target = 0;
     access_size = 0;
     taken = 0;
-    type = undefInstClass;
 
-    // get the PC
+    // get the PC and the instruction type
 
-    int n;
-    n = fread(&PC, 8, 1, f);
-    if (!n)
+    uint8_t raw_type = undefInstClass;
+    if (!take(&PC, 8) || !take(&raw_type, 1))
       return false;
-    if (feof(f))
-      return false;
-    assert(n == 1);
-
-    // get the instruction type
-
-    assert(fread(&type, 1, 1, f) == 1);
+    type = static_cast<InstClass>(raw_type);
 
     // base on the type, read in different stuff
 
@@ -146,8 +164,8 @@ struct trace {
     case storeInstClass:
       // load or store? get the effective address and access size
 
-      assert(fread(&EA, 8, 1, f) == 1);
-      assert(fread(&access_size, 1, 1, f) == 1);
+      if (!take(&EA, 8) || !take(&access_size, 1))
+        return false;
       break;
     case condBranchInstClass:
     case uncondDirectBranchInstClass:
@@ -155,9 +173,11 @@ struct trace {
 
       // branch? get "taken" and the target
 
-      assert(fread(&taken, 1, 1, f) == 1);
+      if (!take(&taken, 1))
+        return false;
       if (taken) {
-        assert(fread(&target, 8, 1, f) == 1);
+        if (!take(&target, 8))
+          return false;
       } else {
         // if not taken, default target is fallthru, i.e. PC+4
         target = PC + 4;
@@ -173,34 +193,37 @@ struct trace {
 
     // get the number of input registers and their names
 
-    assert(fread(&num_input_regs, 1, 1, f) == 1);
-    for (int i = 0; i < num_input_regs; i++) {
-      assert(fread(&input_reg_names[i], 1, 1, f) == 1);
-    }
+    if (!take(&num_input_regs, 1) || !take(input_reg_names, num_input_regs))
+      return false;
 
     // get the number of output registers and their names
 
-    assert(fread(&num_output_regs, 1, 1, f) == 1);
-    for (int i = 0; i < num_output_regs; i++) {
-      assert(fread(&output_reg_names[i], 1, 1, f) == 1);
-    }
+    if (!take(&num_output_regs, 1) || !take(output_reg_names, num_output_regs))
+      return false;
 
-    // read the output registers
+    // skip over the output register values, which the ChampSim format does not carry
 
-    memset(output_reg_values, 0, sizeof(output_reg_values));
     for (int i = 0; i < num_output_regs; i++) {
+      std::size_t value_size = 0;
       if (output_reg_names[i] <= 31 || output_reg_names[i] == 64) {
         // scalars or flags?
-        assert(fread(&output_reg_values[i][0], 8, 1, f) == 1);
+        value_size = 8;
       } else if (output_reg_names[i] >= 32 && output_reg_names[i] < 64) {
         // SIMD values?
-        assert(fread(&output_reg_values[i][0], 16, 1, f) == 1);
-      } else
-        assert(0);
+        value_size = 16;
+      } else {
+        fprintf(stderr, "malformed record at PC %llx: output register %d\n", (unsigned long long)PC, output_reg_names[i]);
+        exit(1);
+      }
+
+      if (static_cast<std::size_t>(end - q) < value_size)
+        return false;
+      q += value_size;
     }
 
     // success!
 
+    p = q;
     return true;
   }
 };
@@ -209,208 +232,568 @@ struct trace {
 
 bool is_branch(InstClass t) { return (t == uncondIndirectBranchInstClass || t == uncondDirectBranchInstClass || t == condBranchInstClass); }
 
-std::map<UINT64, bool> code_pages, data_pages;
-std::map<UINT64, UINT64> remapped_pages;
+// pages are only inserted by the preprocessing pass, and the remapping is fixed before conversion starts,
+// so the converter threads may read these without locking
+std::unordered_set<UINT64> code_pages, data_pages;
+std::unordered_map<UINT64, UINT64> remapped_pages;
 UINT64 bump_page = 0x1000;
 
 // this string will contain the trace file name, or "-" if we want to read from standard input
 
 char tracefilename[1000];
 
-namespace
+// a blocking queue with a fixed capacity, used to connect the stages of the pipeline
+
+template <typename T>
+class bounded_queue
 {
-constexpr char REG_AX = 56;
-}
+  std::deque<T> items;
+  std::size_t capacity;
+  bool closed = false;
+  std::mutex mtx;
+  std::condition_variable not_full, not_empty;
+
+public:
+  explicit bounded_queue(std::size_t cap) : capacity(cap) {}
+
+  void push(T item)
+  {
+    std::unique_lock lock{mtx};
+    not_full.wait(lock, [&] { return std::size(items) < capacity; });
+    items.push_back(std::move(item));
+    not_empty.notify_one();
+  }
+
+  // returns an empty optional once the queue is closed and drained
+  std::optional<T> pop()
+  {
+    std::unique_lock lock{mtx};
+    not_empty.wait(lock, [&] { return !std::empty(items) || closed; });
+    if (std::empty(items))
+      return std::nullopt;
+
+    std::optional<T> retval{std::move(items.front())};
+    items.pop_front();
+    not_full.notify_one();
+    return retval;
+  }
+
+  void close()
+  {
+    std::lock_guard lock{mtx};
+    closed = true;
+    not_empty.notify_all();
+  }
+};
+
+// reads the trace file in large blocks, decompressing xz or gzip in-process
 
-auto open_trace_file(void)
+class trace_source
 {
-  // read from standard input?
-  if (!strcmp(tracefilename, "-")) {
-    fprintf(stderr, "reading from standard input\n");
-    fflush(stderr);
-    return stdin;
+  enum class format { RAW, XZ, GZ };
+
+  FILE* file = nullptr;
+  format fmt = format::RAW;
+  std::vector<uint8_t> in_buf = std::vector<uint8_t>(BLOCK_SIZE);
+  const uint8_t* in_next = nullptr;
+  std::size_t in_avail = 0;
+  bool in_eof = false;
+  bool out_eof = false;
+  lzma_stream xz = LZMA_STREAM_INIT;
+  z_stream gz{};
+
+  void refill()
+  {
+    if (in_avail > 0 || in_eof)
+      return;
+    in_avail = fread(in_buf.data(), 1, in_buf.size(), file);
+    in_next = in_buf.data();
+    in_eof = (in_avail < in_buf.size());
+    if (ferror(file)) {
+      perror(tracefilename);
+      exit(1);
+    }
   }
 
-  // see what kind of file this is by reading the magic number
-  auto magic_tester = fopen(tracefilename, "r");
-  if (!magic_tester) {
-    perror(tracefilename);
-    exit(1);
+  std::size_t read_raw(uint8_t* out, std::size_t len)
+  {
+    std::size_t total = 0;
+    while (total < len && !(in_avail == 0 && in_eof)) {
+      refill();
+      auto n = std::min(len - total, in_avail);
+      memcpy(out + total, in_next, n);
+      in_next += n;
+      in_avail -= n;
+      total += n;
+    }
+    return total;
   }
 
-  // read six bytes from the beginning of the file
-  unsigned char s[6];
-  int n = fread(s, 1, 6, magic_tester);
-  fclose(magic_tester);
-  assert(n == 6);
+  std::size_t read_xz(uint8_t* out, std::size_t len)
+  {
+    xz.next_out = out;
+    xz.avail_out = len;
+    while (xz.avail_out > 0 && !out_eof) {
+      refill();
+      xz.next_in = in_next;
+      xz.avail_in = in_avail;
+      auto ret = lzma_code(&xz, (in_avail == 0 && in_eof) ? LZMA_FINISH : LZMA_RUN);
+      in_next = xz.next_in;
+      in_avail = xz.avail_in;
+      if (ret == LZMA_STREAM_END) {
+        out_eof = true;
+      } else if (ret != LZMA_OK) {
+        fprintf(stderr, "xz decompression error %d in \"%s\"\n", ret, tracefilename);
+        exit(1);
+      }
+    }
+    return len - xz.avail_out;
+  }
 
-  constexpr auto cmd_size = 5 + std::max({sizeof(XZ_PATH), sizeof(GZIP_PATH), sizeof(CAT_PATH)}) + sizeof(tracefilename);
-  char cmd[cmd_size];
+  std::size_t read_gz(uint8_t* out, std::size_t len)
+  {
+    gz.next_out = out;
+    gz.avail_out = static_cast<uInt>(len);
+    while (gz.avail_out > 0 && !out_eof) {
+      refill();
+      if (in_avail == 0 && in_eof) {
+        fprintf(stderr, "warning: gz file \"%s\" ends in the middle of a stream\n", tracefilename);
+        out_eof = true;
+        break;
+      }
 
-  // is this the magic number for XZ compression?
-  if (s[0] == 0xfd && s[1] == '7' && s[2] == 'z' && s[3] == 'X' && s[4] == 'Z' && s[5] == 0) {
+      gz.next_in = const_cast<Bytef*>(in_next);
+      gz.avail_in = static_cast<uInt>(in_avail);
+      auto ret = inflate(&gz, Z_NO_FLUSH);
+      in_next = gz.next_in;
+      in_avail = gz.avail_in;
+      if (ret == Z_STREAM_END) {
+        // gzip files may hold several concatenated members
+        refill();
+        if (in_avail == 0 && in_eof)
+          out_eof = true;
+        else
+          inflateReset(&gz);
+      } else if (ret != Z_OK) {
+        fprintf(stderr, "gz decompression error %d in \"%s\"\n", ret, tracefilename);
+        exit(1);
+      }
+    }
+    return len - gz.avail_out;
+  }
 
-    // it is an XZ file or doing a good impression of one
+public:
+  explicit trace_source(unsigned threads)
+  {
+    // read from standard input?
+    if (!strcmp(tracefilename, "-")) {
+      fprintf(stderr, "reading from standard input\n");
+      file = stdin;
+    } else {
+      file = fopen(tracefilename, "rb");
+      if (!file) {
+        perror(tracefilename);
+        exit(1);
+      }
+    }
 
-    fprintf(stderr, "opening xz file \"%s\"\n", tracefilename);
+    // see what kind of file this is by looking for a magic number in the first block
+    refill();
+    const uint8_t* s = in_next;
+
+    // is this the magic number for XZ compression?
+    if (in_avail >= 6 && s[0] == 0xfd && s[1] == '7' && s[2] == 'z' && s[3] == 'X' && s[4] == 'Z' && s[5] == 0) {
+      // it is an XZ file or doing a good impression of one
+      fprintf(stderr, "opening xz file \"%s\"\n", tracefilename);
+      fmt = format::XZ;
+
+#if LZMA_VERSION >= 50040002
+      // multi-block streams (such as those written by xz -T) decode in parallel
+      lzma_mt mt{};
+      mt.flags = LZMA_CONCATENATED;
+      mt.threads = threads;
+      mt.memlimit_threading = std::numeric_limits<uint64_t>::max();
+      mt.memlimit_stop = std::numeric_limits<uint64_t>::max();
+      auto ret = lzma_stream_decoder_mt(&xz, &mt);
+#else
+      (void)threads;
+      auto ret = lzma_stream_decoder(&xz, std::numeric_limits<uint64_t>::max(), LZMA_CONCATENATED);
+#endif
+      if (ret != LZMA_OK) {
+        fprintf(stderr, "could not initialize xz decoder (error %d)\n", ret);
+        exit(1);
+      }
+    }
+
+    // check for the magic number for GZIP compression
+    else if (in_avail >= 2 && s[0] == 0x1f && s[1] == 0x8b) {
+      // it is a GZ file
+      fprintf(stderr, "opening gz file \"%s\"\n", tracefilename);
+      fmt = format::GZ;
+      if (inflateInit2(&gz, 15 + 16) != Z_OK) {
+        fprintf(stderr, "could not initialize gz decoder\n");
+        exit(1);
+      }
+    } else {
+      // no magic number? maybe it's uncompressed?
+      fprintf(stderr, "opening file \"%s\"\n", tracefilename);
+    }
     fflush(stderr);
+  }
+
+  ~trace_source()
+  {
+    if (fmt == format::XZ)
+      lzma_end(&xz);
+    if (fmt == format::GZ)
+      inflateEnd(&gz);
+    if (file != stdin)
+      fclose(file);
+  }
 
-    // start up an xz decompression and open a pipe to our standard input
+  trace_source(const trace_source&) = delete;
+  trace_source& operator=(const trace_source&) = delete;
 
-    sprintf(cmd, "%s -dc %s", XZ_PATH, tracefilename);
+  // fill as much of out as possible, returning the number of bytes written. zero indicates the end of the trace
+  std::size_t read(uint8_t* out, std::size_t len)
+  {
+    switch (fmt) {
+    case format::XZ:
+      return read_xz(out, len);
+    case format::GZ:
+      return read_gz(out, len);
+    default:
+      return read_raw(out, len);
+    }
   }
+};
 
-  // check for the magic number for GZIP compression
-  else if (s[0] == 0x1f && s[1] == 0x8b) {
-    // it is a GZ file
-    fprintf(stderr, "opening gz file \"%s\"\n", tracefilename);
-    fflush(stderr);
+// writes the converted trace, compressing it if the output file name ends in .xz or .gz
 
-    // open a pipe to a gzip decompression process
+class trace_sink
+{
+  enum class format { RAW, XZ, GZ };
 
-    sprintf(cmd, "%s -dc %s", GZIP_PATH, tracefilename);
-  } else {
-    // no magic number? maybe it's uncompressed?
-    fprintf(stderr, "opening file \"%s\"\n", tracefilename);
-    fflush(stderr);
+  FILE* file = stdout;
+  format fmt = format::RAW;
+  std::vector<uint8_t> out_buf = std::vector<uint8_t>(BLOCK_SIZE);
+  lzma_stream xz = LZMA_STREAM_INIT;
+  z_stream gz{};
 
-    // use Unix cat to open and read this file. we could just fopen the file
-    // but then we're pclosing it later so that could get weird
+  void flush_out(std::size_t len)
+  {
+    if (fwrite(out_buf.data(), 1, len, file) != len) {
+      perror("write");
+      exit(1);
+    }
+  }
 
-    sprintf(cmd, "%s %s", CAT_PATH, tracefilename);
+  void code_xz(lzma_action action)
+  {
+    for (;;) {
+      xz.next_out = out_buf.data();
+      xz.avail_out = out_buf.size();
+      auto ret = lzma_code(&xz, action);
+      if (ret != LZMA_OK && ret != LZMA_STREAM_END) {
+        fprintf(stderr, "xz compression error %d\n", ret);
+        exit(1);
+      }
+      flush_out(out_buf.size() - xz.avail_out);
+      if (action == LZMA_RUN ? xz.avail_in == 0 : ret == LZMA_STREAM_END)
+        return;
+    }
   }
 
-  auto f = popen(cmd, "r");
-  if (f)
-    return f;
+  void code_gz(int flush)
+  {
+    for (;;) {
+      gz.next_out = out_buf.data();
+      gz.avail_out = static_cast<uInt>(out_buf.size());
+      auto ret = deflate(&gz, flush);
+      if (ret != Z_OK && ret != Z_STREAM_END && ret != Z_BUF_ERROR) {
+        fprintf(stderr, "gz compression error %d\n", ret);
+        exit(1);
+      }
+      flush_out(out_buf.size() - gz.avail_out);
+      if (flush == Z_NO_FLUSH ? (gz.avail_in == 0 && gz.avail_out > 0) : ret == Z_STREAM_END)
+        return;
+    }
+  }
 
-  perror(cmd);
-  return f;
-}
+  static bool ends_with(const char* name, const char* suffix)
+  {
+    auto n = strlen(name), m = strlen(suffix);
+    return n >= m && !strcmp(name + n - m, suffix);
+  }
 
-void preprocess_file(void)
-{
-  trace t;
-  fprintf(stderr, "preprocessing to find code and data pages...\n");
-  fflush(stderr);
-  FILE* f = open_trace_file();
-  if (!f)
-    return;
-  int count = 0;
-  for (;;) {
-    bool good = t.read(f);
-    if (!good)
-      break;
-    code_pages[t.PC >> 12] = true;
-    if (t.type == loadInstClass || t.type == storeInstClass)
-      data_pages[t.EA >> 12] = true;
-    count++;
-    if (count % 10000000 == 0) {
-      fprintf(stderr, ".");
-      fflush(stderr);
-      if (count % 600000000 == 0) {
-        fprintf(stderr, "\n");
-        fflush(stderr);
+public:
+  trace_sink(const char* name, unsigned threads)
+  {
+    if (name == nullptr)
+      return;
+
+    file = fopen(name, "wb");
+    if (!file) {
+      perror(name);
+      exit(1);
+    }
+
+    if (ends_with(name, ".xz")) {
+      fmt = format::XZ;
+      lzma_mt mt{};
+      mt.threads = threads;
+      mt.preset = LZMA_PRESET_DEFAULT;
+      mt.check = LZMA_CHECK_CRC64;
+      if (lzma_stream_encoder_mt(&xz, &mt) != LZMA_OK) {
+        fprintf(stderr, "could not initialize xz encoder\n");
+        exit(1);
+      }
+    } else if (ends_with(name, ".gz")) {
+      fmt = format::GZ;
+      if (deflateInit2(&gz, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        fprintf(stderr, "could not initialize gz encoder\n");
+        exit(1);
       }
     }
   }
-  pclose(f);
-  fprintf(stderr, "%ld code pages, %ld data pages\n", code_pages.size(), data_pages.size());
-  fflush(stderr);
-}
 
-// take an address representing data and make sure it doesn't overlap with code
+  ~trace_sink()
+  {
+    if (fmt == format::XZ)
+      lzma_end(&xz);
+    if (fmt == format::GZ)
+      deflateEnd(&gz);
+    if (file != stdout)
+      fclose(file);
+  }
 
-UINT64 transform(UINT64 a)
-{
-  static int num_allocs = 0;
-  UINT64 page = a >> 12;
-  UINT64 new_page = page;
-  if (code_pages.find(page) != code_pages.end()) {
-    new_page = remapped_pages[page];
-    if (new_page == 0) {
-      num_allocs++;
-      fprintf(stderr, "[%d]", num_allocs);
-      fflush(stderr);
-      // allocate a new page
-      new_page = bump_page;
-      for (;;) {
-        if (code_pages.find(new_page) != code_pages.end() || data_pages.find(new_page) != data_pages.end())
-          new_page++;
-        else
-          break;
+  trace_sink(const trace_sink&) = delete;
+  trace_sink& operator=(const trace_sink&) = delete;
+
+  void write(const void* data, std::size_t len)
+  {
+    switch (fmt) {
+    case format::XZ:
+      xz.next_in = static_cast<const uint8_t*>(data);
+      xz.avail_in = len;
+      code_xz(LZMA_RUN);
+      break;
+    case format::GZ:
+      gz.next_in = static_cast<Bytef*>(const_cast<void*>(data));
+      gz.avail_in = static_cast<uInt>(len);
+      code_gz(Z_NO_FLUSH);
+      break;
+    default:
+      if (fwrite(data, 1, len, file) != len) {
+        perror("write");
+        exit(1);
       }
-      bump_page = new_page + 1;
-      remapped_pages[page] = new_page;
     }
   }
-  a = new_page << 12 | (a & 0xfff);
-  return a;
-}
 
-int main(int argc, char** argv)
-{
-  trace t;
+  void finish()
+  {
+    if (fmt == format::XZ)
+      code_xz(LZMA_FINISH);
+    if (fmt == format::GZ)
+      code_gz(Z_FINISH);
+    fflush(file);
+  }
+};
 
-  // for fun we will keep a register file up to date
+// a group of consecutive records, tagged with its position in the trace so the output can be put back in order
 
-  UINT64 registers[256][2];
-  memset(registers, 0, sizeof(registers));
+struct record_batch {
+  std::size_t seq;
+  long long int first_record;
+  std::vector<trace> records;
+};
 
-  // defaults to reading from standard input
+struct converted_batch {
+  std::vector<trace_instr_format> instrs;
+  long long int counts[OPTYPE_MAX] = {};
+  std::string disassembly;
+};
 
-  strcpy(tracefilename, "-");
+// stage 1: decompress the trace into large blocks
 
-  for (int i = 1; i < argc; i++) {
-    if (!strcmp(argv[i], "-v"))
-      verbose = true;
-    else
-      strcpy(tracefilename, argv[i]);
+void read_stage(trace_source& source, bounded_queue<std::vector<uint8_t>>& out)
+{
+  for (;;) {
+    std::vector<uint8_t> block(BLOCK_SIZE);
+    block.resize(source.read(block.data(), block.size()));
+    if (std::empty(block))
+      break;
+    out.push(std::move(block));
   }
+  out.close();
+}
 
-  preprocess_file();
+// stage 2: split the decompressed bytes into records. records may straddle blocks, so the unparsed tail is carried over
 
-  // open the trace file
+void parse_stage(bounded_queue<std::vector<uint8_t>>& in, bounded_queue<record_batch>& out)
+{
+  std::vector<uint8_t> carry;
+  record_batch batch{0, 0, {}};
+  batch.records.reserve(BATCH_SIZE);
+  long long int n = 0;
+  UINT64 old_pc = 0;
+
+  // parse the records that begin before stop, returning false if one of them is cut off by the end of the buffer
+  auto parse_records = [&](const uint8_t*& p, const uint8_t* end, const uint8_t* stop) {
+    while (p < stop) {
+      trace& t = batch.records.emplace_back();
+      if (!t.parse(p, end)) {
+        batch.records.pop_back();
+        return false;
+      }
 
-  FILE* f = open_trace_file();
+      if (t.PC == old_pc) {
+        fprintf(stderr, "hmm, that's weird\n");
+      }
+      old_pc = t.PC;
+      n++;
+
+      if (std::size(batch.records) == BATCH_SIZE) {
+        auto next_first = batch.first_record + static_cast<long long int>(BATCH_SIZE);
+        auto next_seq = batch.seq + 1;
+        out.push(std::move(batch));
+        batch = record_batch{next_seq, next_first, {}};
+        batch.records.reserve(BATCH_SIZE);
+      }
+    }
+    return true;
+  };
+
+  while (auto block = in.pop()) {
+    const uint8_t* p = block->data();
+    const uint8_t* end = p + block->size();
+
+    if (!std::empty(carry)) {
+      // a record straddles the blocks, so join it with only as much of this block as it can need
+      const auto carried = std::size(carry);
+      const auto joined = std::min(block->size(), MAX_RECORD_SIZE);
+      carry.insert(std::end(carry), p, p + joined);
+
+      const uint8_t* q = carry.data();
+      if (!parse_records(q, carry.data() + std::size(carry), carry.data() + carried)) {
+        // this block is too short to finish the record
+        assert(joined == block->size());
+        carry.erase(std::begin(carry), std::next(std::begin(carry), q - carry.data()));
+        continue;
+      }
 
-  if (!f)
-    return 1;
+      p += (q - carry.data()) - static_cast<std::ptrdiff_t>(carried);
+      carry.clear();
+    }
 
-  // number of records read so far
-  long long int n = 0;
-  trace oldt;
-  oldt.PC = 0;
+    parse_records(p, end, end);
+    carry.assign(p, end);
+  }
 
-  // loop getting records until we're done
+  if (!std::empty(carry))
+    fprintf(stderr, "warning: trace ends with a partial record of %zu bytes\n", std::size(carry));
 
-  for (;;) {
+  if (!std::empty(batch.records))
+    out.push(std::move(batch));
+  out.close();
+}
 
-    // one more record
+// decompress and parse the trace on their own threads, handing each batch of records to the consumer
 
-    n++;
+template <typename F>
+void for_each_batch(unsigned threads, F&& consume)
+{
+  trace_source source{threads};
+  bounded_queue<std::vector<uint8_t>> blocks{4};
+  bounded_queue<record_batch> batches{2 * threads + 2};
 
-    // print something to entertain the user while they wait
+  std::thread reader{read_stage, std::ref(source), std::ref(blocks)};
+  std::thread parser{parse_stage, std::ref(blocks), std::ref(batches)};
 
-    if (n % 1000000 == 0) {
-      fprintf(stderr, "%lld instructions\n", n);
-      fflush(stderr);
+  while (auto batch = batches.pop())
+    consume(*batch);
+
+  reader.join();
+  parser.join();
+}
+
+void preprocess_file(unsigned threads)
+{
+  fprintf(stderr, "preprocessing to find code and data pages...\n");
+  fflush(stderr);
+
+  // data pages, in the order they are first touched. the remapping below follows this order so that the
+  // pages handed out are the same as if they were allocated on the fly during conversion
+  std::vector<UINT64> data_page_order;
+
+  long long int count = 0;
+  for_each_batch(threads, [&](const record_batch& batch) {
+    for (const trace& t : batch.records) {
+      code_pages.insert(t.PC >> 12);
+      if (t.type == loadInstClass || t.type == storeInstClass) {
+        if (data_pages.insert(t.EA >> 12).second)
+          data_page_order.push_back(t.EA >> 12);
+      }
+      count++;
+      if (count % 10000000 == 0) {
+        fprintf(stderr, ".");
+        fflush(stderr);
+        if (count % 600000000 == 0) {
+          fprintf(stderr, "\n");
+          fflush(stderr);
+        }
+      }
     }
+  });
+  fprintf(stderr, "%zu code pages, %zu data pages\n", code_pages.size(), data_pages.size());
+  fflush(stderr);
+
+  // find a new home for every data page that overlaps with code
 
-    // read a record from the trace file
+  int num_allocs = 0;
+  for (UINT64 page : data_page_order) {
+    if (code_pages.find(page) == code_pages.end())
+      continue;
 
-    bool good = t.read(f);
-    if (t.PC == oldt.PC) {
-      fprintf(stderr, "hmm, that's weird\n");
+    num_allocs++;
+    fprintf(stderr, "[%d]", num_allocs);
+    fflush(stderr);
+    // allocate a new page
+    UINT64 new_page = bump_page;
+    for (;;) {
+      if (code_pages.find(new_page) != code_pages.end() || data_pages.find(new_page) != data_pages.end())
+        new_page++;
+      else
+        break;
     }
+    bump_page = new_page + 1;
+    remapped_pages[page] = new_page;
+  }
+}
 
-    oldt = t;
+// take an address representing data and make sure it doesn't overlap with code
+
+UINT64 transform(UINT64 a)
+{
+  UINT64 page = a >> 12;
+  UINT64 new_page = page;
+  if (auto found = remapped_pages.find(page); found != remapped_pages.end())
+    new_page = found->second;
+  a = new_page << 12 | (a & 0xfff);
+  return a;
+}
 
-    // are we done? then stop.
+// stage 3: convert a batch of records into the ChampSim format. batches are independent, so this runs on several threads
 
-    if (!good)
-      break;
-    trace_instr_format ct;
+converted_batch convert(const record_batch& batch)
+{
+  converted_batch result;
+  result.instrs.reserve(std::size(batch.records));
+
+  long long int n = batch.first_record;
+  for (trace t : batch.records) {
+    trace_instr_format ct{};
     ct.ip = t.PC;
     ct.is_branch = false;
     // we are going to figure out the op type
@@ -463,14 +846,10 @@ int main(int argc, char** argv)
             c = OPTYPE_RET_UNCOND;
           }
       }
-      counts[c]++;
+      result.counts[c]++;
 
       // OK now make a branch instruction out of this bad boy
 
-      memset(ct.destination_registers, 0, sizeof(ct.destination_registers));
-      memset(ct.source_registers, 0, sizeof(ct.source_registers));
-      memset(ct.destination_memory, 0, sizeof(ct.destination_memory));
-      memset(ct.source_memory, 0, sizeof(ct.source_memory));
       switch (c) {
       case OPTYPE_JMP_DIRECT_UNCOND:
         // writes IP only
@@ -518,13 +897,9 @@ int main(int argc, char** argv)
       default:
         assert(0);
       }
-      fwrite(&ct, sizeof(ct), 1, stdout); // write a branch trace
+      result.instrs.push_back(ct); // write a branch trace
     } else {
-      memset(ct.destination_registers, 0, sizeof(ct.destination_registers));
-      memset(ct.source_registers, 0, sizeof(ct.source_registers));
-      memset(ct.destination_memory, 0, sizeof(ct.destination_memory));
-      memset(ct.source_memory, 0, sizeof(ct.source_memory));
-      counts[OPTYPE_OP]++;
+      result.counts[OPTYPE_OP]++;
       if (t.num_input_regs > NUM_INSTR_SOURCES)
         t.num_input_regs = NUM_INSTR_SOURCES;
       if (t.num_output_regs == 0) {
@@ -572,48 +947,174 @@ int main(int argc, char** argv)
         case undefInstClass:
           assert(0);
         }
-        fwrite(&ct, sizeof(ct), 1, stdout); // write a non-branch trace
+        result.instrs.push_back(ct); // write a non-branch trace
       }
     }
 
-    // for fun, update the register values
-
-    for (int i = 0; i < t.num_output_regs; i++) {
-      int x = t.output_reg_names[i];
-      registers[x][0] = t.output_reg_values[x][0];
-      registers[x][1] = t.output_reg_values[x][1];
-    }
     if (verbose) {
-      static long long int n = 0;
-      fprintf(stderr, "%lld %llx ", ++n, t.PC);
+      char line[64];
+      snprintf(line, sizeof(line), "%lld %llx ", ++n, t.PC);
+      result.disassembly += line;
       if (c == OPTYPE_OP) {
         switch (t.type) {
         case loadInstClass:
-          fprintf(stderr, "LOAD (0x%llx)", t.EA);
+          snprintf(line, sizeof(line), "LOAD (0x%llx)", t.EA);
           break;
         case storeInstClass:
-          fprintf(stderr, "STORE (0x%llx)", t.EA);
+          snprintf(line, sizeof(line), "STORE (0x%llx)", t.EA);
           break;
         case aluInstClass:
-          fprintf(stderr, "ALU");
+          snprintf(line, sizeof(line), "ALU");
           break;
         case fpInstClass:
-          fprintf(stderr, "FP");
+          snprintf(line, sizeof(line), "FP");
           break;
         case slowAluInstClass:
-          fprintf(stderr, "SLOWALU");
+          snprintf(line, sizeof(line), "SLOWALU");
           break;
+        default:
+          line[0] = '\0';
+        }
+        result.disassembly += line;
+        for (int i = 0; i < t.num_input_regs; i++) {
+          snprintf(line, sizeof(line), " I%d", t.input_reg_names[i]);
+          result.disassembly += line;
+        }
+        for (int i = 0; i < t.num_output_regs; i++) {
+          snprintf(line, sizeof(line), " O%d", t.output_reg_names[i]);
+          result.disassembly += line;
         }
-        for (int i = 0; i < t.num_input_regs; i++)
-          fprintf(stderr, " I%d", t.input_reg_names[i]);
-        for (int i = 0; i < t.num_output_regs; i++)
-          fprintf(stderr, " O%d", t.output_reg_names[i]);
       } else {
-        fprintf(stderr, "%s %llx", branch_names[c], t.target);
+        snprintf(line, sizeof(line), "%s %llx", branch_names[c], t.target);
+        result.disassembly += line;
       }
-      fprintf(stderr, "\n");
+      result.disassembly += "\n";
     }
   }
+
+  return result;
+}
+
+// converted batches finish out of order; this holds them until the writer is ready for them.
+// batches too far ahead of the writer block, which bounds the memory in flight
+
+class reorder_buffer
+{
+  std::map<std::size_t, converted_batch> pending;
+  std::size_t next = 0;
+  std::size_t window;
+  bool closed = false;
+  std::mutex mtx;
+  std::condition_variable ready, space;
+
+public:
+  explicit reorder_buffer(std::size_t win) : window(win) {}
+
+  void push(std::size_t seq, converted_batch batch)
+  {
+    std::unique_lock lock{mtx};
+    space.wait(lock, [&] { return seq < next + window; });
+    pending.emplace(seq, std::move(batch));
+    ready.notify_all();
+  }
+
+  // returns an empty optional once the buffer is closed and every batch has been taken
+  std::optional<converted_batch> pop()
+  {
+    std::unique_lock lock{mtx};
+    ready.wait(lock, [&] { return pending.count(next) > 0 || closed; });
+    auto found = pending.find(next);
+    if (found == pending.end())
+      return std::nullopt;
+
+    std::optional<converted_batch> retval{std::move(found->second)};
+    pending.erase(found);
+    next++;
+    space.notify_all();
+    return retval;
+  }
+
+  void close()
+  {
+    std::lock_guard lock{mtx};
+    closed = true;
+    ready.notify_all();
+  }
+};
+
+// stage 4: write (and compress) the converted batches in trace order
+
+long long int write_stage(reorder_buffer& in, trace_sink& sink)
+{
+  long long int n = 0;
+  while (auto batch = in.pop()) {
+    sink.write(batch->instrs.data(), std::size(batch->instrs) * sizeof(trace_instr_format));
+    if (verbose) {
+      fputs(batch->disassembly.c_str(), stderr);
+    }
+
+    for (int i = 0; i < OPTYPE_MAX; i++)
+      counts[i] += batch->counts[i];
+
+    // print something to entertain the user while they wait
+
+    auto before = n;
+    n += static_cast<long long int>(std::size(batch->instrs));
+    if (n / 1000000 != before / 1000000) {
+      fprintf(stderr, "%lld instructions\n", n / 1000000 * 1000000);
+      fflush(stderr);
+    }
+  }
+  sink.finish();
+  return n;
+}
+
+int main(int argc, char** argv)
+{
+  // defaults to reading from standard input and writing to standard output
+
+  strcpy(tracefilename, "-");
+  const char* outfilename = nullptr;
+  unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "-v"))
+      verbose = true;
+    else if (!strcmp(argv[i], "-o") && i + 1 < argc)
+      outfilename = argv[++i];
+    else if (!strcmp(argv[i], "-j") && i + 1 < argc)
+      threads = std::max(1, atoi(argv[++i]));
+    else
+      strcpy(tracefilename, argv[i]);
+  }
+
+  preprocess_file(threads);
+
+  // convert on as many threads as requested, while the reader, parser, and writer run alongside
+
+  trace_sink sink{outfilename, threads};
+  bounded_queue<record_batch> work{2 * threads + 2};
+  reorder_buffer converted{4 * threads + 4};
+
+  long long int n = 0;
+  std::thread writer{[&] { n = write_stage(converted, sink); }};
+
+  std::vector<std::thread> converters;
+  for (unsigned i = 0; i < threads; i++) {
+    converters.emplace_back([&] {
+      while (auto batch = work.pop())
+        converted.push(batch->seq, convert(*batch));
+    });
+  }
+
+  for_each_batch(threads, [&](record_batch& batch) { work.push(std::move(batch)); });
+  work.close();
+
+  for (auto& t : converters)
+    t.join();
+  converted.close();
+  writer.join();
+
   fprintf(stderr, "converted %lld instructions\n", n);
   OpType lim = OPTYPE_MAX;
   for (int i = 2; i < (int)lim; i++) {
@@ -621,9 +1122,5 @@ int main(int argc, char** argv)
       fprintf(stderr, "%s %lld %f%%\n", branch_names[i], counts[i], 100 * counts[i] / (double)n);
   }
 
-  // close the pipe, if any
-
-  if (f != stdin)
-    pclose(f);
   return 0;
 }